@@ -0,0 +1,135 @@
+#include <inttypes.h>
+#include <math.h>
+
+#include "esp_log.h"
+
+#include "app_autotune.h"
+#include "app_settings.h"
+
+static const char* TAG = "app_autotune";
+
+#define AUTOTUNE_RELAY_AMPLITUDE 500.0f // 继电器输出幅值 d: 输出在 0‰ 与 1000‰ 之间切换
+#define AUTOTUNE_TIMEOUT_MS      ((uint64_t)CONFIG_APP_AUTOTUNE_TIMEOUT_MIN * 60 * 1000)
+
+static volatile app_autotune_state_t autotune_state = APP_AUTOTUNE_IDLE;
+static volatile bool autotune_restart = false; // 由加热控制任务在下一周期重置实验
+static volatile int autotune_setpoint = 0;     // 目标温度 (°C)
+
+/* 继电实验状态, 只在加热控制任务中访问 */
+static struct {
+    bool output;           // 继电器输出
+    uint64_t elapsed_ms;   // 实验已进行的时间
+    uint64_t last_on_ms;   // 上一次打开加热器的时间
+    bool switched_on;      // 是否已打开过加热器
+    int cycles;            // 已完成的振荡周期数
+    int32_t cycle_max;     // 当前周期最高温度 (m°C)
+    int32_t cycle_min;     // 当前周期最低温度 (m°C)
+    int64_t amplitude_sum; // 有效周期峰峰值之和 (m°C)
+    uint64_t period_sum;   // 有效周期长度之和 (ms)
+} tune;
+
+void app_autotune_start(const int setpoint) {
+    autotune_setpoint = setpoint;
+    autotune_restart = true;
+    autotune_state = APP_AUTOTUNE_RUNNING;
+    ESP_LOGI(TAG, "Relay auto-tune requested around %d C", setpoint);
+}
+
+void app_autotune_cancel(void) {
+    if (autotune_state != APP_AUTOTUNE_RUNNING) { return; }
+    autotune_state = APP_AUTOTUNE_IDLE;
+    ESP_LOGW(TAG, "Auto-tune cancelled");
+}
+
+app_autotune_state_t app_autotune_get_state(void) { return autotune_state; }
+
+/**
+ * @brief 由振荡的平均振幅与周期计算PID增益并保存
+ *
+ * 临界增益 Ku = 4d / (π·√(a²-ε²)) 对继电器回差 ε 做了修正, 增益按 Tyreus–Luyben 规则计算,
+ * 其超调比 Ziegler–Nichols 小得多, 更适合热惯性大的加热对象.
+ */
+static app_autotune_state_t autotune_finish(void) {
+    const int periods = tune.cycles - 1; // 第一个周期含冷启动升温过程, 不参与计算
+    const float amplitude = (float)tune.amplitude_sum / periods / 2 / 1000;   // a (°C)
+    const float hysteresis = (float)CONFIG_APP_AUTOTUNE_HYSTERESIS / 1000;    // ε (°C)
+    const float tu = (float)tune.period_sum / periods / 1000;                 // Tu (s)
+
+    if (amplitude <= hysteresis || tu <= 0) {
+        ESP_LOGE(TAG, "Oscillation unusable (a=%.2f C, Tu=%.0f s)", amplitude, tu);
+        return APP_AUTOTUNE_FAILED;
+    }
+
+    const float ku = 4 * AUTOTUNE_RELAY_AMPLITUDE / ((float)M_PI * sqrtf(amplitude * amplitude - hysteresis * hysteresis));
+    const float kp = ku / 2.2f;
+    const float ti = 2.2f * tu;
+    const float td = tu / 6.3f;
+
+    ESP_LOGI(TAG, "Ku=%.1f permille/C Tu=%.0f s -> Kp=%.2f Ti=%.0f s Td=%.0f s", ku, tu, kp, ti, td);
+
+    settings_set_pid_gains(kp, kp / ti, kp * td);
+    if (settings_write_parameter_to_nvs() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save PID gains");
+        return APP_AUTOTUNE_FAILED;
+    }
+    return APP_AUTOTUNE_DONE;
+}
+
+bool app_autotune_step(const int32_t temp, const uint32_t dt_ms) {
+    if (autotune_restart) {
+        autotune_restart = false;
+        tune.output = false;
+        tune.elapsed_ms = 0;
+        tune.last_on_ms = 0;
+        tune.switched_on = false;
+        tune.cycles = 0;
+        tune.cycle_max = temp;
+        tune.cycle_min = temp;
+        tune.amplitude_sum = 0;
+        tune.period_sum = 0;
+    }
+
+    if (autotune_state != APP_AUTOTUNE_RUNNING) { return false; }
+
+    tune.elapsed_ms += dt_ms;
+    const uint64_t now_ms = tune.elapsed_ms;
+
+    if (now_ms > AUTOTUNE_TIMEOUT_MS) {
+        ESP_LOGE(TAG, "Auto-tune timed out after %d cycles", tune.cycles);
+        autotune_state = APP_AUTOTUNE_FAILED;
+        return false;
+    }
+
+    if (temp > tune.cycle_max) { tune.cycle_max = temp; }
+    if (temp < tune.cycle_min) { tune.cycle_min = temp; }
+
+    const int32_t setpoint = autotune_setpoint * 1000;
+
+    if (tune.output && temp > setpoint + CONFIG_APP_AUTOTUNE_HYSTERESIS) {
+        tune.output = false;
+    } else if (!tune.output && temp < setpoint - CONFIG_APP_AUTOTUNE_HYSTERESIS) {
+        tune.output = true;
+
+        /* 以每次打开加热器为周期边界 */
+        if (tune.switched_on) {
+            tune.cycles++;
+            if (tune.cycles > 1) {
+                tune.amplitude_sum += tune.cycle_max - tune.cycle_min;
+                tune.period_sum += now_ms - tune.last_on_ms;
+            }
+            ESP_LOGI(TAG, "Cycle %d: %" PRId32 "..%" PRId32 " mC, %" PRIu32 " s", tune.cycles, tune.cycle_min,
+                     tune.cycle_max, (uint32_t)((now_ms - tune.last_on_ms) / 1000));
+        }
+        tune.last_on_ms = now_ms;
+        tune.switched_on = true;
+        tune.cycle_max = temp;
+        tune.cycle_min = temp;
+
+        if (tune.cycles > CONFIG_APP_AUTOTUNE_CYCLES) {
+            autotune_state = autotune_finish();
+            return false;
+        }
+    }
+
+    return tune.output;
+}
@@ -0,0 +1,254 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include <malloc.h>
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#endif
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "app_bench.h"
+#include "app_estimator.h"
+#include "app_pid.h"
+#include "app_settings.h"
+#include "bsp/input_gesture.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_bench";
+
+#define BENCH_TASK_PRIORITY 10 // 高于全部应用任务, 测量只受中断与系统任务干扰
+
+#if CONFIG_IDF_TARGET_LINUX
+#define BENCH_TARGET "linux"
+#define BENCH_UNIT   "ns"
+#define BENCH_CPU_MHZ 0
+#else
+#define BENCH_TARGET CONFIG_IDF_TARGET
+#define BENCH_UNIT   "cycles"
+#define BENCH_CPU_MHZ CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#endif
+
+typedef struct {
+    const char* name;
+    uint32_t iterations;        // 0 为 CONFIG_APP_BENCH_ITERATIONS
+    void (*setup)(void);        // 可为 NULL
+    void (*run)(uint32_t i);    // 第 i 次调用
+    void (*teardown)(void);     // 可为 NULL
+} app_bench_t;
+
+typedef struct {
+    const app_bench_t* bench;
+    TaskHandle_t runner;
+    uint32_t count;       // 有效样本数
+    int32_t stack_bytes;  // 栈用量, 无法测量时为 -1
+    int32_t heap_bytes;   // 堆增量
+} bench_result_t;
+
+static uint32_t bench_samples[CONFIG_APP_BENCH_ITERATIONS];
+
+static volatile int32_t bench_sink; // 保存被测函数的返回值, 避免调用被优化掉
+
+/**************************************************************************************************
+ * Timing & Memory
+ **************************************************************************************************/
+
+/**
+ * @brief 计时器读数, 两次读数之差为经过的周期数 (芯片) 或 ns (linux), 允许回绕
+ */
+static inline uint32_t bench_now(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+/**
+ * @brief 已分配的堆内存 (B)
+ */
+static int32_t bench_heap_used(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return (int32_t)mallinfo2().uordblks;
+#else
+    return (int32_t)(heap_caps_get_total_size(MALLOC_CAP_DEFAULT) - heap_caps_get_free_size(MALLOC_CAP_DEFAULT));
+#endif
+}
+
+/**************************************************************************************************
+ * Benchmarks
+ **************************************************************************************************/
+
+static void bench_nop(const uint32_t i) { (void)i; }
+
+static void bench_led_strip_write(const uint32_t i) {
+    bsp_led_strip_write((bsp_led_strip_mode_t)(i % (BSP_STRIP_RED + 1)));
+}
+
+static void bench_display_write_int(const uint32_t i) { bsp_display_write_int((int)(i % 100)); }
+
+/* 测试期间暂停刷新定时器, 避免与刷新中断同时驱动数码管 */
+static void bench_display_refresh_setup(void) { bsp_display_hold_refresh(true); }
+
+static void bench_display_refresh(const uint32_t i) { bsp_display_refresh(); }
+
+static void bench_display_refresh_teardown(void) { bsp_display_hold_refresh(false); }
+
+static void bench_heating_get_temp(const uint32_t i) { bench_sink = bsp_heating_get_temp(); }
+
+/* 每次写入前累计电量加一, 与电能计量定期保存相同, 确保每次都实际写入闪存 */
+static uint64_t bench_energy_saved;
+
+static void bench_settings_setup(void) { bench_energy_saved = settings_get_energy_lifetime_mj(); }
+
+static void bench_settings_write(const uint32_t i) {
+    settings_set_energy_lifetime_mj(bench_energy_saved + i + 1);
+    bench_sink = settings_write_parameter_to_nvs();
+}
+
+static void bench_settings_teardown(void) {
+    settings_set_energy_lifetime_mj(bench_energy_saved);
+    settings_write_parameter_to_nvs();
+}
+
+static app_pid_t bench_pid;
+
+static void bench_pid_setup(void) { app_pid_init(&bench_pid, 40.0f, 0.2f, 200.0f); }
+
+static void bench_pid_update(const uint32_t i) {
+    bench_sink = (int32_t)app_pid_update(&bench_pid, 50.0f, 40.0f + (float)(i % 20) * 0.5f, 1.0f);
+}
+
+static app_estimator_t bench_estimator;
+
+static void bench_estimator_setup(void) { app_estimator_init(&bench_estimator, 25000); }
+
+static void bench_estimator_update(const uint32_t i) {
+    bench_sink = app_estimator_update(&bench_estimator, 25000 + (int32_t)(i % 100) * 100, 500, 1000);
+}
+
+static bsp_gesture_engine_t bench_gesture;
+
+static void bench_gesture_setup(void) { bsp_gesture_init(&bench_gesture, bsp_gesture_table, bsp_gesture_table_len); }
+
+/* 旋钮按键每 100ms 交替按下/松开, 覆盖点击计数与连击匹配 */
+static void bench_gesture_feed(const uint32_t i) {
+    const bsp_gesture_raw_t raw = {
+        .type = i % 2 ? BSP_GESTURE_RAW_RELEASE : BSP_GESTURE_RAW_PRESS,
+        .key = BSP_GESTURE_KEY_KNOB,
+        .time_ms = i * 100,
+    };
+    bsp_input_event_t out[BSP_GESTURE_OUT_MAX];
+    bench_sink = bsp_gesture_feed(&bench_gesture, &raw, out, BSP_GESTURE_OUT_MAX);
+}
+
+static const app_bench_t bench_table[] = {
+    {.name = "overhead", .run = bench_nop},
+    {.name = "bsp_led_strip_write", .run = bench_led_strip_write},
+    {.name = "display_write_int", .run = bench_display_write_int},
+    {
+        .name = "display_refresh_timer_cb",
+        .setup = bench_display_refresh_setup,
+        .run = bench_display_refresh,
+        .teardown = bench_display_refresh_teardown,
+    },
+    {.name = "bsp_heating_get_temp", .run = bench_heating_get_temp},
+    {
+        .name = "settings_write_parameter_to_nvs",
+        .iterations = CONFIG_APP_BENCH_NVS_ITERATIONS,
+        .setup = bench_settings_setup,
+        .run = bench_settings_write,
+        .teardown = bench_settings_teardown,
+    },
+    {.name = "app_pid_update", .setup = bench_pid_setup, .run = bench_pid_update},
+    {.name = "app_estimator_update", .setup = bench_estimator_setup, .run = bench_estimator_update},
+    {.name = "bsp_gesture_feed", .setup = bench_gesture_setup, .run = bench_gesture_feed},
+};
+
+/**************************************************************************************************
+ * Runner
+ **************************************************************************************************/
+
+static int bench_compare(const void* a, const void* b) {
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 测试任务: 预热一次后逐次计时, 结束时记录栈高水位
+ */
+static void bench_worker(void* arg) {
+    bench_result_t* result = arg;
+    const app_bench_t* bench = result->bench;
+    uint32_t iterations = bench->iterations ? bench->iterations : CONFIG_APP_BENCH_ITERATIONS;
+    if (iterations > CONFIG_APP_BENCH_ITERATIONS) { iterations = CONFIG_APP_BENCH_ITERATIONS; }
+
+    const int32_t heap_before = bench_heap_used();
+    if (bench->setup) { bench->setup(); }
+
+    bench->run(0); // 预热: 首次调用的惰性初始化与缓存缺失不计入样本
+    for (uint32_t i = 0; i < iterations; i++) {
+        const uint32_t start = bench_now();
+        bench->run(i + 1);
+        bench_samples[i] = bench_now() - start;
+    }
+
+    if (bench->teardown) { bench->teardown(); }
+    result->heap_bytes = bench_heap_used() - heap_before;
+    result->count = iterations;
+
+#if CONFIG_IDF_TARGET_LINUX
+    result->stack_bytes = -1;
+#else
+    result->stack_bytes = CONFIG_APP_BENCH_STACK_SIZE - (int32_t)uxTaskGetStackHighWaterMark(NULL);
+#endif
+
+    xTaskNotifyGive(result->runner);
+    vTaskDelete(NULL);
+}
+
+static void bench_run_one(const app_bench_t* bench) {
+    bench_result_t result = {.bench = bench, .runner = xTaskGetCurrentTaskHandle()};
+
+    if (xTaskCreate(bench_worker, "Bench", CONFIG_APP_BENCH_STACK_SIZE, &result, BENCH_TASK_PRIORITY, NULL) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task for %s", bench->name);
+        return;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    qsort(bench_samples, result.count, sizeof(uint32_t), bench_compare);
+    printf("BENCH,%s,%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRId32 ",%" PRId32 "\n",
+           bench->name, BENCH_UNIT, result.count, bench_samples[0], bench_samples[(result.count - 1) * 50 / 100],
+           bench_samples[(result.count - 1) * 99 / 100], bench_samples[result.count - 1], result.stack_bytes,
+           result.heap_bytes);
+    fflush(stdout);
+
+    vTaskDelay(1); // 让空闲任务回收测试任务的栈
+}
+
+void app_bench_run(void) {
+    ESP_LOGI(TAG, "Running %d benchmarks, %d iterations each", (int)(sizeof(bench_table) / sizeof(bench_table[0])),
+             CONFIG_APP_BENCH_ITERATIONS);
+    printf("BENCH_INFO,%s,%s,%d\n", BENCH_TARGET, BENCH_UNIT, BENCH_CPU_MHZ);
+
+    /* 被测函数中的日志输出远慢于函数本身, 测量期间关闭 */
+    esp_log_level_set("*", ESP_LOG_NONE);
+    for (int i = 0; i < sizeof(bench_table) / sizeof(bench_table[0]); i++) { bench_run_one(&bench_table[i]); }
+    esp_log_level_set("*", CONFIG_LOG_DEFAULT_LEVEL);
+
+    printf("BENCH_END\n");
+    fflush(stdout);
+
+#if CONFIG_IDF_TARGET_LINUX
+    exit(0);
+#endif
+}
@@ -0,0 +1,573 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_console.h"
+#include "esp_log.h"
+
+#include "app_autotune.h"
+#include "app_console.h"
+#include "app_coord.h"
+#include "app_energy.h"
+#include "app_history.h"
+#include "app_memory.h"
+#include "app_ntc_cal.h"
+#include "app_ota.h"
+#if CONFIG_APP_PROF_ENABLE
+#include "app_prof.h"
+#endif
+#if CONFIG_APP_PUSH_ENABLE
+#include "app_push.h"
+#endif
+#include "app_settings.h"
+#if CONFIG_APP_TARIFF_ENABLE
+#include "app_tariff.h"
+#endif
+#include "app_tasks.h"
+#if CONFIG_APP_TIME_ENABLE
+#include "app_time.h"
+#endif
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_console";
+
+/**************************************************************************************************
+ * Commands
+ **************************************************************************************************/
+
+/**
+ * @brief autotune [start|cancel|status]
+ */
+static int cmd_autotune(const int argc, char** argv) {
+    static const char* state_names[] = {"idle", "running", "done", "failed"};
+
+    if (argc > 1 && strcmp(argv[1], "start") == 0) {
+        return app_tasks_start_autotune() == ESP_OK ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "cancel") == 0) {
+        app_autotune_cancel();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "status") != 0) {
+        printf("usage: autotune [start|cancel|status]\n");
+        return 1;
+    }
+
+    float kp, ki, kd;
+    const bool tuned = settings_get_pid_gains(&kp, &ki, &kd);
+    printf("state: %s\n", state_names[app_autotune_get_state()]);
+    tuned ? printf("gains: Kp=%.3f Ki=%.5f Kd=%.1f\n", kp, ki, kd) : printf("gains: not tuned\n");
+    return 0;
+}
+
+/**
+ * @brief energy
+ */
+static int cmd_energy(__attribute__((unused)) const int argc, __attribute__((unused)) char** argv) {
+    app_energy_snapshot_t energy;
+    app_energy_get_snapshot(&energy);
+    printf("session: %" PRIu32 " Wh, heater on %" PRIu32 " s\n", energy.session_wh, energy.session_on_s);
+    printf("lifetime: %" PRIu64 " Wh\n", energy.lifetime_wh);
+    return 0;
+}
+
+/**
+ * @brief mem
+ */
+static int cmd_mem(__attribute__((unused)) const int argc, __attribute__((unused)) char** argv) {
+    app_memory_report();
+    return 0;
+}
+
+/**
+ * @brief ntccal [status | capture <1|2> <ref_C> | save | reset]
+ *
+ * 参考温度以参考温度计读数为准, 可带小数
+ */
+static int cmd_ntccal(const int argc, char** argv) {
+    if (argc > 3 && strcmp(argv[1], "capture") == 0) {
+        const int point = atoi(argv[2]);
+        if (point != 1 && point != 2) {
+            printf("point must be 1 or 2\n");
+            return 1;
+        }
+        if (point == 1) { app_ntc_cal_begin(); }
+        const int32_t reference_mC = (int32_t)lroundf(strtof(argv[3], NULL) * 1000);
+        return app_ntc_cal_capture(point - 1, reference_mC) == ESP_OK ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "save") == 0) { return app_ntc_cal_commit() == ESP_OK ? 0 : 1; }
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) { return app_ntc_cal_reset() == ESP_OK ? 0 : 1; }
+    if (argc > 1 && strcmp(argv[1], "status") != 0) {
+        printf("usage: ntccal [status | capture <1|2> <ref_C> | save | reset]\n");
+        return 1;
+    }
+
+    app_ntc_cal_status_t status;
+    app_ntc_cal_get_status(&status);
+    int32_t raw_mC, cal_mC;
+    if (bsp_heating_read_temp_uncalibrated(&raw_mC) == ESP_OK && bsp_heating_read_temp(&cal_mC) == ESP_OK) {
+        printf("reading: %.2f C uncalibrated, %.2f C calibrated\n", raw_mC / 1000.0f, cal_mC / 1000.0f);
+    }
+    status.calibrated ? printf("coefficients: gain %.4f, offset %.2f C\n",
+                               (float)status.gain_q16 / BSP_NTC_CAL_GAIN_ONE, status.offset_mC / 1000.0f)
+                      : printf("coefficients: not calibrated\n");
+    for (int i = 0; i < 2; i++) {
+        if (!status.captured[i]) { continue; }
+        printf("point %d: measured %.2f C, reference %.2f C\n", i + 1, status.measured_mC[i] / 1000.0f,
+               status.reference_mC[i] / 1000.0f);
+    }
+    return 0;
+}
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+/**
+ * @brief ntcnoise [<samples> [<channel>]]
+ *
+ * 分别在静默窗口与随机时刻连续转换, 比较原始值的方差. 需在数码管显示时运行
+ */
+static int cmd_ntcnoise(const int argc, char** argv) {
+    const int samples = argc > 1 ? atoi(argv[1]) : 256;
+    const int channel = argc > 2 ? atoi(argv[2]) : 0;
+
+    bsp_ntc_noise_t noise[2];
+    for (int synced = 0; synced < 2; synced++) {
+        const esp_err_t ret = bsp_heating_measure_ntc_noise(channel, samples, synced, &noise[synced]);
+        if (ret == ESP_ERR_TIMEOUT) {
+            printf("display is not multiplexing, turn it on and retry\n");
+            return 1;
+        }
+        if (ret != ESP_OK) {
+            printf("error: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("%-6s: mean %.2f, std dev %.2f LSB, peak-to-peak %d LSB\n", synced ? "synced" : "free",
+               noise[synced].mean, sqrtf(noise[synced].variance), noise[synced].max - noise[synced].min);
+    }
+    if (noise[1].variance > 0.0f) {
+        printf("variance ratio free/synced: %.2f\n", noise[0].variance / noise[1].variance);
+    }
+
+    bsp_ntc_sync_stats_t stats;
+    bsp_heating_get_ntc_sync_stats(&stats);
+    printf("readings: %" PRIu32 " synced, %" PRIu32 " direct, %" PRIu32 " timeouts\n", stats.synced, stats.direct,
+           stats.timeouts);
+    return 0;
+}
+#endif
+
+/**
+ * @brief zone [<channel> <temp_C>]
+ *
+ * 无参数时显示所有加热通道状态; 带参数时单独设置一个通道的目标温度
+ */
+static int cmd_zone(const int argc, char** argv) {
+    if (argc == 3) {
+        const esp_err_t ret = app_tasks_set_zone_target(atoi(argv[1]), atoi(argv[2]));
+        if (ret != ESP_OK) { printf("error: %s\n", esp_err_to_name(ret)); }
+        return ret == ESP_OK ? 0 : 1;
+    }
+    if (argc != 1) {
+        printf("usage: zone [<channel> <temp_C>]\n");
+        return 1;
+    }
+
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        app_zone_status_t status;
+        app_tasks_get_zone_status(ch, &status);
+        printf("zone %d: %.1f C, target %d C, heater %s\n", ch, status.temperature / 1000.0f,
+               status.target_temperature, status.heater_on ? "on" : "off");
+    }
+    return 0;
+}
+
+/**
+ * @brief loop
+ */
+static int cmd_loop(__attribute__((unused)) const int argc, __attribute__((unused)) char** argv) {
+    app_heating_loop_status_t status;
+    app_tasks_get_heating_loop_status(&status);
+    status.period_ms ? printf("period: %" PRIu32 " ms\n", status.period_ms) : printf("period: waiting for events\n");
+    printf("wakeups: %" PRIu32 " this hour, %" PRIu32 " last hour, %" PRIu32 " total\n", status.wakeups_this_hour,
+           status.wakeups_last_hour, status.wakeups);
+    return 0;
+}
+
+#if CONFIG_APP_HISTORY_ENABLE
+/**
+ * @brief history [info | export [<boot> [<from_s> [<to_s>]]]]
+ *
+ * 按时间顺序流式输出CSV, 可按启动序号与启动后时间范围过滤
+ */
+static int cmd_history(const int argc, char** argv) {
+    if (argc < 2 || strcmp(argv[1], "info") == 0) {
+        app_history_info_t info;
+        app_history_get_info(&info);
+        printf("boot: %u, head page seq: %" PRIu32 ", %" PRIu32 " pages x %" PRIu32 " B\n", info.boot,
+               info.head_seq, info.page_count, info.page_size);
+        return 0;
+    }
+    if (strcmp(argv[1], "export") != 0) {
+        printf("usage: history [info | export [<boot> [<from_s> [<to_s>]]]]\n");
+        return 1;
+    }
+
+    const long boot = argc > 2 ? strtol(argv[2], NULL, 10) : -1;
+    const uint32_t from_s = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+    const uint32_t to_s = argc > 4 ? strtoul(argv[4], NULL, 10) : UINT32_MAX;
+
+    app_history_reader_t reader;
+    if (app_history_reader_open(&reader) != ESP_OK) { return 1; }
+
+    app_history_sample_t sample;
+    printf("boot,time_s,temp_c,duty_permille,state\n");
+    while (app_history_reader_next(&reader, &sample)) {
+        if (boot >= 0 && sample.boot != boot) { continue; }
+        if (sample.time_s < from_s || sample.time_s > to_s) { continue; }
+        printf("%u,%" PRIu32 ",%" PRId32 ".%" PRId32 ",%u,0x%02x\n", sample.boot, sample.time_s, sample.temp_dc / 10,
+               (sample.temp_dc < 0 ? -sample.temp_dc : sample.temp_dc) % 10, sample.duty, sample.state);
+    }
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_COORD_ENABLE
+/**
+ * @brief coord
+ */
+static int cmd_coord(__attribute__((unused)) const int argc, __attribute__((unused)) char** argv) {
+    app_coord_status_t status;
+    app_coord_get_status(&status);
+    printf("node: %08" PRIx32 " (%s), peers: %d, demand: %" PRIu32 " / %" PRIu32 " W\n", status.node_id,
+           status.online ? "online" : "standalone", status.peers, status.total_demand_w, status.cap_w);
+    if (status.limited) {
+        printf("limited: %" PRIu32 " permille of each %" PRIu32 " ms window, starting at %" PRIu32 " ms\n",
+               status.share_permille, status.window_ms, status.offset_ms);
+    } else {
+        printf("unrestricted\n");
+    }
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_PUSH_ENABLE
+/**
+ * @brief push
+ */
+static int cmd_push(__attribute__((unused)) const int argc, __attribute__((unused)) char** argv) {
+    app_push_status_t status;
+    app_push_get_status(&status);
+    printf("port %d: %s, clients: %d / %d\n", CONFIG_APP_PUSH_PORT, status.listening ? "listening" : "not listening",
+           status.clients, CONFIG_APP_PUSH_MAX_CLIENTS);
+    printf("updates: %" PRIu32 ", frames: %" PRIu32 ", merged: %" PRIu32 ", dropped clients: %" PRIu32 "\n",
+           status.updates, status.frames, status.merged, status.dropped);
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_TIME_ENABLE
+/**
+ * @brief time [status | sync]
+ */
+static int cmd_time(const int argc, char** argv) {
+    static const char* source_names[] = {"unknown", "saved before power loss", "retained by RTC", "synced"};
+
+    if (argc > 1 && strcmp(argv[1], "sync") == 0) {
+        app_time_sync_now();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "status") != 0) {
+        printf("usage: time [status | sync]\n");
+        return 1;
+    }
+
+    app_time_status_t status;
+    app_time_get_status(&status);
+    if (status.source == APP_TIME_SOURCE_NONE) {
+        printf("time: unknown");
+    } else {
+        struct tm local;
+        const int32_t offset_s = app_time_to_local(status.utc_us / 1000000, &local);
+        char text[32];
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+        printf("time: %s (UTC%+03d:%02d), %s", text, (int)(offset_s / 3600), (int)(abs(offset_s) % 3600 / 60),
+               source_names[status.source]);
+    }
+    printf(", drift: ");
+    if (status.drift_valid) {
+        printf("%.3f ppm\n", status.drift_ppb / 1000.0);
+    } else {
+        printf("not estimated\n");
+    }
+    printf("syncs: %" PRIu32 ", failures: %" PRIu32, status.sync_count, status.sync_failures);
+    if (status.last_sync_age_us >= 0) {
+        printf(", last %" PRId64 " s ago, offset %" PRId64 " ms, delay %" PRIu32 " ms",
+               status.last_sync_age_us / 1000000, status.last_offset_us / 1000, status.last_delay_us / 1000);
+    }
+    printf("\n");
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_TARIFF_ENABLE
+/**
+ * @brief tariff [status | refresh | comfort <HH:MM> <HH:MM>]
+ */
+static int cmd_tariff(const int argc, char** argv) {
+    if (argc > 3 && strcmp(argv[1], "comfort") == 0) {
+        int start_h, start_m, end_h, end_m;
+        if (sscanf(argv[2], "%d:%d", &start_h, &start_m) != 2 || sscanf(argv[3], "%d:%d", &end_h, &end_m) != 2) {
+            printf("usage: tariff comfort <HH:MM> <HH:MM>\n");
+            return 1;
+        }
+        return app_tariff_set_comfort(start_h * 60 + start_m, end_h * 60 + end_m) == ESP_OK ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "refresh") == 0) {
+        app_tariff_refresh();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "status") != 0) {
+        printf("usage: tariff [status | refresh | comfort <HH:MM> <HH:MM>]\n");
+        return 1;
+    }
+
+    app_tariff_status_t status;
+    app_tariff_get_status(&status);
+    printf("comfort: %02d:%02d-%02d:%02d", status.comfort_start_min / 60, status.comfort_start_min % 60,
+           status.comfort_end_min / 60, status.comfort_end_min % 60);
+    if (!status.schedule_loaded) {
+        printf(", no tariff loaded\n");
+        return 0;
+    }
+    printf(", time: %02d:%02d, price: %" PRIu32 "\n", (int)(status.now_s % 86400 / 3600),
+           (int)(status.now_s % 3600 / 60), status.price);
+    if (!status.active) {
+        printf("planner inactive\n");
+        return 0;
+    }
+    if (status.offset == APP_TARIFF_OFF) {
+        printf("heating held until preheat\n");
+    } else {
+        printf("target offset: %+d C%s\n", status.offset, status.feasible ? "" : " (comfort not reachable)");
+    }
+    printf("cost this window: expected %" PRIu64 ", without planning %" PRIu64 ", so far %" PRIu64 "\n",
+           status.expected_ucost / 1000, status.baseline_ucost / 1000, status.actual_ucost / 1000);
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_OTA_ENABLE
+/**
+ * @brief ota [start <url> | cancel | status]
+ */
+static int cmd_ota(const int argc, char** argv) {
+    static const char* state_names[] = {"idle", "downloading", "ready", "failed", "cancelled"};
+
+    if (argc > 2 && strcmp(argv[1], "start") == 0) {
+        return app_ota_start(argv[2]) == ESP_OK ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "cancel") == 0) {
+        app_ota_cancel();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "status") != 0) {
+        printf("usage: ota [start <url> | cancel | status]\n");
+        return 1;
+    }
+
+    app_ota_status_t status;
+    app_ota_get_status(&status);
+    printf("state: %s, received: %" PRIu32 " B, written: %" PRIu32 " / %" PRIu32 " B", state_names[status.state],
+           status.received, status.written, status.image_size);
+    if (status.state == APP_OTA_FAILED) { printf(", error: %s", esp_err_to_name(status.last_error)); }
+    printf("\n");
+    return 0;
+}
+#endif
+
+#if CONFIG_APP_PROF_ENABLE
+/**
+ * @brief prof [start [<rate_hz>] | stop | dump | status]
+ *
+ * dump 输出的 PROF 行由 tools/profile_fold.py 处理
+ */
+static int cmd_prof(const int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "start") == 0) {
+        const esp_err_t ret = app_prof_start(argc > 2 ? (uint32_t)atoi(argv[2]) : 0);
+        if (ret != ESP_OK) { printf("error: %s\n", esp_err_to_name(ret)); }
+        return ret == ESP_OK ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "stop") == 0) {
+        app_prof_stop();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "dump") == 0) {
+        app_prof_dump();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "status") != 0) {
+        printf("usage: prof [start [<rate_hz>] | stop | dump | status]\n");
+        return 1;
+    }
+
+    app_prof_status_t status;
+    app_prof_get_status(&status);
+    printf("state: %s, rate: %" PRIu32 " Hz, duration: %" PRIu32 " ms\n", status.running ? "sampling" : "stopped",
+           status.rate_hz, status.duration_ms);
+    printf("samples: %" PRIu32 ", dropped: %" PRIu32 ", slots used: %" PRIu32 " / %d\n", status.samples,
+           status.dropped, status.slots_used, CONFIG_APP_PROF_SLOTS);
+    return 0;
+}
+#endif
+
+static void app_console_register_commands(void) {
+    const esp_console_cmd_t autotune_cmd = {
+        .command = "autotune",
+        .help = "Run relay-feedback PID auto-tuning at the current target temperature",
+        .hint = "[start|cancel|status]",
+        .func = cmd_autotune,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&autotune_cmd));
+
+    const esp_console_cmd_t energy_cmd = {
+        .command = "energy",
+        .help = "Show session and lifetime heater energy",
+        .func = cmd_energy,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&energy_cmd));
+
+    const esp_console_cmd_t mem_cmd = {
+        .command = "mem",
+        .help = "Show static storage, heap usage and task stack high-water marks",
+        .func = cmd_mem,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&mem_cmd));
+
+    const esp_console_cmd_t ntccal_cmd = {
+        .command = "ntccal",
+        .help = "Two-point NTC calibration: capture readings at two reference temperatures, then save",
+        .hint = "[status | capture <1|2> <ref_C> | save | reset]",
+        .func = cmd_ntccal,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&ntccal_cmd));
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+    const esp_console_cmd_t ntcnoise_cmd = {
+        .command = "ntcnoise",
+        .help = "Compare NTC ADC noise sampled in the display dead-time against random sampling times",
+        .hint = "[<samples> [<channel>]]",
+        .func = cmd_ntcnoise,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&ntcnoise_cmd));
+#endif
+
+    const esp_console_cmd_t zone_cmd = {
+        .command = "zone",
+        .help = "Show heating zones, or set the target temperature of one zone",
+        .hint = "[<channel> <temp_C>]",
+        .func = cmd_zone,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&zone_cmd));
+
+    const esp_console_cmd_t loop_cmd = {
+        .command = "loop",
+        .help = "Show the heating control loop period and wakeups per hour",
+        .func = cmd_loop,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&loop_cmd));
+
+#if CONFIG_APP_HISTORY_ENABLE
+    const esp_console_cmd_t history_cmd = {
+        .command = "history",
+        .help = "Show or export the temperature history log as CSV",
+        .hint = "[info | export [<boot> [<from_s> [<to_s>]]]]",
+        .func = cmd_history,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&history_cmd));
+#endif
+
+#if CONFIG_APP_COORD_ENABLE
+    const esp_console_cmd_t coord_cmd = {
+        .command = "coord",
+        .help = "Show peak-power coordination peers and this controller's heating time slot",
+        .func = cmd_coord,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&coord_cmd));
+#endif
+
+#if CONFIG_APP_PUSH_ENABLE
+    const esp_console_cmd_t push_cmd = {
+        .command = "push",
+        .help = "Show WebSocket state push clients, frames sent and updates merged for slow clients",
+        .func = cmd_push,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&push_cmd));
+#endif
+
+#if CONFIG_APP_TIME_ENABLE
+    const esp_console_cmd_t time_cmd = {
+        .command = "time",
+        .help = "Show wall-clock time, sync source and estimated clock drift, or sync with the NTP server now",
+        .hint = "[status | sync]",
+        .func = cmd_time,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&time_cmd));
+#endif
+
+#if CONFIG_APP_TARIFF_ENABLE
+    const esp_console_cmd_t tariff_cmd = {
+        .command = "tariff",
+        .help = "Show the time-of-use heating plan, refetch the tariff, or set the comfort window",
+        .hint = "[status | refresh | comfort <HH:MM> <HH:MM>]",
+        .func = cmd_tariff,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&tariff_cmd));
+#endif
+
+#if CONFIG_APP_PROF_ENABLE
+    const esp_console_cmd_t prof_cmd = {
+        .command = "prof",
+        .help = "Sample the interrupted PC and task into a histogram, then dump it for tools/profile_fold.py",
+        .hint = "[start [<rate_hz>] | stop | dump | status]",
+        .func = cmd_prof,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&prof_cmd));
+#endif
+
+#if CONFIG_APP_OTA_ENABLE
+    const esp_console_cmd_t ota_cmd = {
+        .command = "ota",
+        .help = "Download a compressed firmware package (tools/ota_pack.py) and install it",
+        .hint = "[start <url> | cancel | status]",
+        .func = cmd_ota,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&ota_cmd));
+#endif
+}
+
+/**************************************************************************************************
+ * Console REPL
+ **************************************************************************************************/
+
+void app_console_init(void) {
+    esp_console_repl_t* repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "towelrack>";
+
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&hw_config, &repl_config, &repl));
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl));
+#else
+    ESP_LOGW(TAG, "No console device configured, console disabled");
+    return;
+#endif
+
+    esp_console_register_help_command();
+    app_console_register_commands();
+
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+}
@@ -0,0 +1,406 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_mac.h"
+#endif
+
+#include "app_coord.h"
+#include "app_memory.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_coord";
+
+#define COORD_MAGIC           "TRPC"
+#define COORD_VERSION         1
+#define COORD_POLL_MS         50                               // 接收轮询间隔
+#define COORD_RETRY_MS        5000                             // 套接字创建失败后的重试间隔
+#define COORD_PEER_TIMEOUT_MS (5 * CONFIG_APP_COORD_PERIOD_MS) // 超时未公告的节点视为离线
+#define COORD_JOIN_HOLD_MS    (2 * CONFIG_APP_COORD_PERIOD_MS) // 需求出现后等待其他节点公告的时间
+#define COORD_GUARD_MS        (2 * COORD_POLL_MS)              // 时段末尾的保护间隔, 吸收相位估计误差
+
+/* 公告报文, 多字节字段为网络字节序 */
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t node_id;
+    uint32_t demand_w;  // 加热需求
+    uint32_t cap_w;     // 发送者配置的功率上限
+    uint32_t window_ms; // 发送者使用的窗口长度
+    uint32_t phase_ms;  // 发送时刻在窗口中的位置
+} coord_msg_t;
+
+_Static_assert(sizeof(coord_msg_t) == 28, "coord message layout");
+
+typedef struct {
+    uint32_t node_id;
+    uint32_t demand_w;
+    uint32_t cap_w;
+    uint32_t window_ms;
+    uint32_t phase_ms;
+    int64_t rx_ms; // 收到公告的本地时刻
+} coord_node_t;
+
+/* 分时计划 */
+typedef struct {
+    bool limited;            // 是否需要分时
+    uint32_t share_permille; // 每个窗口中可加热的比例
+    uint32_t window_ms;      // 窗口长度
+    uint32_t offset_ms;      // 本节点时段在窗口中的起点
+    int64_t origin_ms;       // 窗口起点对应的本地时刻
+    uint32_t total_demand_w;
+    uint32_t cap_w;
+    int peers;
+} coord_plan_t;
+
+/* 节点表, 只在协调任务中访问 */
+static struct {
+    coord_node_t peers[CONFIG_APP_COORD_MAX_PEERS];
+    int peer_count;
+    int64_t origin_ms; // 本节点跟随的窗口起点, 领导者离线后保持相位连续
+} coord_table = {0};
+
+/* 与加热控制任务共享的状态, 由 coord_lock 保护 */
+static SemaphoreHandle_t coord_lock = NULL;
+static struct {
+    uint32_t node_id;
+    uint32_t demand_w;
+    int64_t demand_since_ms; // 需求从无到有的时刻
+    bool announce_now;       // 需求变化, 需要立即公告
+    bool online;
+    coord_plan_t plan;
+} coord = {0};
+
+static int64_t coord_now_ms(void) { return (int64_t)BSP_TICKS_TO_MS(xTaskGetTickCount()); }
+
+static uint32_t coord_mod(const int64_t value, const uint32_t modulus) {
+    const int64_t r = value % modulus;
+    return (uint32_t)(r < 0 ? r + modulus : r);
+}
+
+/**
+ * @brief 生成本节点号: 芯片上取MAC地址低4字节, 仿真板取进程号
+ */
+static uint32_t coord_node_id(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return (uint32_t)getpid();
+#else
+    uint8_t mac[6];
+    ESP_ERROR_CHECK(esp_read_mac(mac, ESP_MAC_WIFI_STA));
+    return (uint32_t)mac[2] << 24 | (uint32_t)mac[3] << 16 | (uint32_t)mac[4] << 8 | mac[5];
+#endif
+}
+
+/**
+ * @brief 根据节点集合计算本节点的分时计划
+ *
+ * 所有节点对相同的集合得到一致的时段划分:
+ *   k = max(1, 上限 / 最大单节点需求)     上限内可同时加热的节点数
+ *   比例 = min(1, k × 最大单节点需求 / 总需求)
+ *   起点 = 排在本节点之前的有需求节点的需求之和 / 总需求 × 窗口
+ *
+ * @param nodes 包括本节点在内的在线节点, 按节点号升序
+ * @param self 本节点在 nodes 中的下标
+ */
+static void coord_compute_plan(const coord_node_t* nodes, const int count, const int self, coord_plan_t* plan) {
+    uint32_t total_w = 0, max_w = 0, before_w = 0, cap_w = UINT32_MAX;
+
+    for (int i = 0; i < count; i++) {
+        if (nodes[i].cap_w < cap_w) { cap_w = nodes[i].cap_w; }
+        total_w += nodes[i].demand_w;
+        if (nodes[i].demand_w > max_w) { max_w = nodes[i].demand_w; }
+        if (i < self) { before_w += nodes[i].demand_w; }
+    }
+
+    plan->window_ms = nodes[0].window_ms; // 跟随领导者的窗口
+    plan->total_demand_w = total_w;
+    plan->cap_w = cap_w;
+    plan->peers = count - 1;
+    plan->limited = nodes[self].demand_w > 0 && total_w > cap_w;
+    if (!plan->limited) {
+        plan->share_permille = 1000;
+        plan->offset_ms = 0;
+        return;
+    }
+
+    const uint64_t slots = cap_w / max_w > 0 ? cap_w / max_w : 1;
+    const uint64_t share = slots * max_w * 1000 / total_w;
+    plan->share_permille = share < 1000 ? (uint32_t)share : 1000;
+    plan->offset_ms = (uint32_t)((uint64_t)before_w * plan->window_ms / total_w);
+}
+
+/**
+ * @brief 淘汰离线节点, 以本节点与在线节点重新计算计划
+ */
+static void coord_update_plan(const int64_t now_ms) {
+    coord_node_t nodes[CONFIG_APP_COORD_MAX_PEERS + 1];
+    int count = 0;
+
+    for (int i = 0; i < coord_table.peer_count;) {
+        if (now_ms - coord_table.peers[i].rx_ms > COORD_PEER_TIMEOUT_MS) {
+            ESP_LOGI(TAG, "Node %08" PRIx32 " left", coord_table.peers[i].node_id);
+            coord_table.peers[i] = coord_table.peers[--coord_table.peer_count];
+            continue;
+        }
+        nodes[count++] = coord_table.peers[i++];
+    }
+
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    nodes[count++] = (coord_node_t){
+        .node_id = coord.node_id,
+        .demand_w = coord.demand_w,
+        .cap_w = CONFIG_APP_COORD_CAP_W,
+        .window_ms = CONFIG_APP_COORD_WINDOW_S * 1000,
+    };
+    xSemaphoreGive(coord_lock);
+
+    /* 按节点号排序, 节点数很少, 插入排序即可 */
+    for (int i = 1; i < count; i++) {
+        const coord_node_t node = nodes[i];
+        int j = i;
+        for (; j > 0 && nodes[j - 1].node_id > node.node_id; j--) { nodes[j] = nodes[j - 1]; }
+        nodes[j] = node;
+    }
+    int self = 0;
+    while (nodes[self].node_id != coord.node_id) { self++; }
+
+    /* 跟随领导者的窗口相位; 本节点为领导者时保持当前相位 */
+    if (self != 0) { coord_table.origin_ms = nodes[0].rx_ms - nodes[0].phase_ms; }
+
+    coord_plan_t plan;
+    coord_compute_plan(nodes, count, self, &plan);
+    plan.origin_ms = coord_table.origin_ms;
+
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    const bool changed = plan.limited != coord.plan.limited || plan.share_permille != coord.plan.share_permille ||
+                         plan.offset_ms != coord.plan.offset_ms || plan.peers != coord.plan.peers;
+    coord.plan = plan;
+    xSemaphoreGive(coord_lock);
+
+    if (!changed) { return; }
+    if (plan.limited) {
+        ESP_LOGI(TAG, "%d nodes demand %" PRIu32 " W over cap %" PRIu32 " W: heating %" PRIu32
+                      " permille of each %" PRIu32 " s window from %" PRIu32 " ms",
+                 count, plan.total_demand_w, plan.cap_w, plan.share_permille, plan.window_ms / 1000, plan.offset_ms);
+    } else {
+        ESP_LOGI(TAG, "%d nodes demand %" PRIu32 " W, cap %" PRIu32 " W: unrestricted", count, plan.total_demand_w,
+                 plan.cap_w);
+    }
+}
+
+/**
+ * @brief 记录收到的公告
+ */
+static void coord_on_message(const coord_msg_t* msg, const int64_t now_ms) {
+    const uint32_t node_id = ntohl(msg->node_id);
+    if (memcmp(msg->magic, COORD_MAGIC, sizeof(msg->magic)) != 0 || msg->version != COORD_VERSION) { return; }
+    if (node_id == coord.node_id) { return; } // 组播回环收到的自己的公告
+
+    const uint32_t window_ms = ntohl(msg->window_ms);
+    if (window_ms == 0) { return; }
+
+    int i = 0;
+    while (i < coord_table.peer_count && coord_table.peers[i].node_id != node_id) { i++; }
+    if (i == coord_table.peer_count) {
+        if (coord_table.peer_count == CONFIG_APP_COORD_MAX_PEERS) { return; }
+        coord_table.peer_count++;
+        ESP_LOGI(TAG, "Node %08" PRIx32 " joined", node_id);
+    }
+
+    coord_table.peers[i] = (coord_node_t){
+        .node_id = node_id,
+        .demand_w = ntohl(msg->demand_w),
+        .cap_w = ntohl(msg->cap_w),
+        .window_ms = window_ms,
+        .phase_ms = ntohl(msg->phase_ms) % window_ms,
+        .rx_ms = now_ms,
+    };
+}
+
+/**
+ * @brief 公告本节点需求与当前跟随的窗口相位
+ */
+static void coord_announce(const int sock, const struct sockaddr_in* group, const int64_t now_ms) {
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    const uint32_t demand_w = coord.demand_w;
+    const uint32_t window_ms = coord.plan.window_ms;
+    coord.announce_now = false;
+    xSemaphoreGive(coord_lock);
+
+    coord_msg_t msg = {
+        .magic = COORD_MAGIC,
+        .version = COORD_VERSION,
+        .node_id = htonl(coord.node_id),
+        .demand_w = htonl(demand_w),
+        .cap_w = htonl(CONFIG_APP_COORD_CAP_W),
+        .window_ms = htonl(window_ms),
+        .phase_ms = htonl(coord_mod(now_ms - coord_table.origin_ms, window_ms)),
+    };
+    if (sendto(sock, &msg, sizeof(msg), 0, (const struct sockaddr*)group, sizeof(*group)) < 0) {
+        ESP_LOGD(TAG, "Announce failed: errno %d", errno);
+    }
+}
+
+/**
+ * @brief 创建加入协调组播组的非阻塞UDP套接字
+ *
+ * 非阻塞接收使任务可以用 vTaskDelay 轮询, 仿真板上阻塞的系统调用会挂起整个调度器
+ */
+static int coord_open_socket(const struct sockaddr_in* group) {
+    const int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) { return -1; }
+
+    const int reuse = 1;
+    const uint8_t ttl = 1;  // 只在本网段内传播
+    const uint8_t loop = 1; // 同一主机上的多个仿真实例需要收到彼此的公告
+    const struct in_addr iface = {.s_addr = inet_addr(CONFIG_APP_COORD_IFACE)};
+    const struct sockaddr_in bind_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_APP_COORD_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    const struct ip_mreq mreq = {.imr_multiaddr = group->sin_addr, .imr_interface = iface};
+
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+        bind(sock, (const struct sockaddr*)&bind_addr, sizeof(bind_addr)) < 0 ||
+        setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0 ||
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0 ||
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0 ||
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) < 0) {
+        ESP_LOGW(TAG, "Multicast setup failed: errno %d, running standalone", errno);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static void coord_set_online(const bool online) {
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    coord.online = online;
+    xSemaphoreGive(coord_lock);
+}
+
+/**
+ * @brief [任务]峰值功率协调
+ */
+_Noreturn static void coord_task(__attribute__((unused)) void* pvParameters) {
+    const struct sockaddr_in group = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_APP_COORD_PORT),
+        .sin_addr.s_addr = inet_addr(CONFIG_APP_COORD_GROUP),
+    };
+    int sock = -1;
+    int64_t next_announce_ms = 0;
+
+    while (1) {
+        if (sock < 0) {
+            sock = coord_open_socket(&group);
+            coord_set_online(sock >= 0);
+            if (sock < 0) {
+                vTaskDelay(BSP_MS_TO_TICKS(COORD_RETRY_MS));
+                continue;
+            }
+            ESP_LOGI(TAG, "Node %08" PRIx32 " joined %s:%d", coord.node_id, CONFIG_APP_COORD_GROUP,
+                     CONFIG_APP_COORD_PORT);
+        }
+
+        /* 接收所有待处理的公告 */
+        const int64_t now_ms = coord_now_ms();
+        coord_msg_t msg;
+        ssize_t len;
+        while ((len = recvfrom(sock, &msg, sizeof(msg), MSG_DONTWAIT, NULL, NULL)) >= 0) {
+            if (len == sizeof(msg)) { coord_on_message(&msg, now_ms); }
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            ESP_LOGW(TAG, "Receive failed: errno %d, reopening", errno);
+            close(sock);
+            sock = -1;
+            coord_set_online(false);
+            continue;
+        }
+
+        coord_update_plan(now_ms);
+
+        if (now_ms >= next_announce_ms || coord.announce_now) {
+            coord_announce(sock, &group, now_ms);
+            next_announce_ms = now_ms + CONFIG_APP_COORD_PERIOD_MS;
+        }
+
+        vTaskDelay(BSP_MS_TO_TICKS(COORD_POLL_MS));
+    }
+}
+
+APP_TASK_STORAGE(coord_task, 4096);
+APP_MUTEX_STORAGE(coord_lock);
+
+void app_coord_init(void) {
+    coord_lock = APP_MUTEX_CREATE(coord_lock);
+    coord.node_id = coord_node_id();
+    coord.plan = (coord_plan_t){
+        .share_permille = 1000,
+        .window_ms = CONFIG_APP_COORD_WINDOW_S * 1000,
+        .cap_w = CONFIG_APP_COORD_CAP_W,
+    };
+
+    APP_TASK_CREATE(
+        // 创建峰值功率协调任务, 优先级低于加热控制任务
+        coord_task, coord_task, "PowerCoord", NULL, 5, NULL
+    );
+}
+
+void app_coord_set_demand(const uint32_t demand_w) {
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    if (demand_w != coord.demand_w) {
+        if (coord.demand_w == 0) { coord.demand_since_ms = coord_now_ms(); }
+        coord.demand_w = demand_w;
+        coord.announce_now = true;
+    }
+    xSemaphoreGive(coord_lock);
+}
+
+bool app_coord_may_heat(void) {
+    const int64_t now_ms = coord_now_ms();
+    bool allowed = true;
+
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    if (coord.online && now_ms - coord.demand_since_ms < COORD_JOIN_HOLD_MS) {
+        allowed = false;
+    } else if (coord.online && coord.plan.limited) {
+        const coord_plan_t* plan = &coord.plan;
+        const uint32_t position = coord_mod(now_ms - plan->origin_ms - plan->offset_ms, plan->window_ms);
+        const uint32_t slot_ms = (uint64_t)plan->share_permille * plan->window_ms / 1000;
+        const uint32_t guard_ms = COORD_GUARD_MS < slot_ms / 2 ? COORD_GUARD_MS : slot_ms / 2;
+        allowed = position < slot_ms - guard_ms;
+    }
+    xSemaphoreGive(coord_lock);
+
+    return allowed;
+}
+
+void app_coord_get_status(app_coord_status_t* status) {
+    xSemaphoreTake(coord_lock, portMAX_DELAY);
+    *status = (app_coord_status_t){
+        .node_id = coord.node_id,
+        .peers = coord.plan.peers,
+        .total_demand_w = coord.plan.total_demand_w,
+        .cap_w = coord.plan.cap_w,
+        .limited = coord.plan.limited,
+        .share_permille = coord.plan.share_permille,
+        .window_ms = coord.plan.window_ms,
+        .offset_ms = coord.plan.offset_ms,
+        .online = coord.online,
+    };
+    xSemaphoreGive(coord_lock);
+}
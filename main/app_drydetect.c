@@ -0,0 +1,128 @@
+#include "esp_log.h"
+
+#include "app_drydetect.h"
+#include "app_settings.h"
+
+static const char* TAG = "app_drydetect";
+
+#define DRYDETECT_SETTLE_BAND    1000  // 进入目标温度带的判定范围 (m°C)
+#define DRYDETECT_BASELINE_SAVE  0.95f // 基线下降超过5%时才写入NVS
+#define DRYDETECT_WINDOW_MS      (CONFIG_APP_DRYDETECT_WINDOW_S * 1000ULL)
+#define DRYDETECT_MIN_SETTLED_MS (CONFIG_APP_DRYDETECT_MIN_SETTLED_MIN * 60 * 1000ULL)
+
+/* 检测状态, 只在加热控制任务中访问 */
+static struct {
+    int target;          // 检测对应的目标温度 (°C)
+    bool settled;        // 是否已到达目标温度
+    bool detected;       // 本次加热过程是否已判定干燥
+    bool last_on;        // 上一周期加热器状态
+    float duty;          // 上一个窗口的占空比 (‰)
+    float peak_duty;     // 本次加热过程窗口占空比的峰值 (‰)
+    uint64_t settled_ms; // 到达目标温度后经过的时间
+    uint64_t window_ms;  // 当前窗口已经过的时间
+    uint64_t on_ms;      // 当前窗口内加热器打开的时间
+    int windows;         // 已结束的窗口数
+} dry;
+
+void app_drydetect_reset(void) {
+    dry.target = 0;
+    dry.settled = false;
+    dry.detected = false;
+}
+
+/**
+ * @brief 用本次平稳占空比更新干燥基线
+ *
+ * 基线取观察到的最低值, 判定干燥时向当前值缓慢靠拢. 占空比按配置的环境温度 APP_ESTIMATOR_AMBIENT_TEMP 归一化,
+ * 只抵消目标温度的变化; 实际环境温度的季节变化只能由基线靠拢跟随, 且只在 BASELINE_MARGIN_PCT 以内.
+ */
+static void drydetect_learn(const float normalized, const bool dry_now) {
+    float baseline = settings_get_dry_baseline();
+
+    /* 高于基线的占空比可能来自湿毛巾, 不参与学习 */
+    if (!dry_now && (baseline <= 0 || normalized >= baseline)) { return; }
+
+    if (baseline <= 0 || normalized < baseline) {
+        const bool significant = baseline <= 0 || normalized < baseline * DRYDETECT_BASELINE_SAVE;
+        settings_set_dry_baseline(normalized);
+        if (significant) { settings_write_parameter_to_nvs(); }
+        ESP_LOGI(TAG, "Dry baseline lowered to %.2f permille/C", normalized);
+        return;
+    }
+
+    baseline += (normalized - baseline) / 4;
+    settings_set_dry_baseline(baseline);
+    settings_write_parameter_to_nvs();
+}
+
+/**
+ * @brief 在窗口结束时判断是否干燥
+ */
+static bool drydetect_window_end(const float duty) {
+    const float delta = duty - dry.duty;
+    const bool flat = delta < CONFIG_APP_DRYDETECT_FLAT_PERMILLE && delta > -CONFIG_APP_DRYDETECT_FLAT_PERMILLE;
+    const bool falling = delta <= -CONFIG_APP_DRYDETECT_FLAT_PERMILLE;
+
+    dry.duty = duty;
+    if (duty > dry.peak_duty) { dry.peak_duty = duty; }
+
+    ESP_LOGI(TAG, "Holding duty %.0f permille (peak %.0f, %s)", duty, dry.peak_duty,
+             flat ? "flat" : falling ? "falling" : "rising");
+
+    /* 仍在回落的窗口已到达干燥水平时即可判定, 不必再等一个平稳窗口 (约20分钟的额外加热) */
+    if (dry.windows++ == 0 || !(flat || falling) || dry.settled_ms < DRYDETECT_MIN_SETTLED_MS) { return false; }
+
+    const int span = dry.target - CONFIG_APP_ESTIMATOR_AMBIENT_TEMP;
+    const float normalized = duty / (float)(span > 1 ? span : 1);
+    const float baseline = settings_get_dry_baseline();
+
+    const bool dry_now =
+        baseline > 0 ? normalized <= baseline * (100 + CONFIG_APP_DRYDETECT_BASELINE_MARGIN_PCT) / 100
+                     : duty <= dry.peak_duty * (100 - CONFIG_APP_DRYDETECT_FIRST_DROP_PCT) / 100;
+
+    drydetect_learn(normalized, dry_now);
+    return dry_now;
+}
+
+bool app_drydetect_update(const bool heater_on, const int32_t temp, const int target, const uint32_t dt_ms) {
+    if (dry.detected) { return false; }
+
+    /* 目标温度变化后重新等待到达 */
+    if (target != dry.target) {
+        dry.target = target;
+        dry.settled = false;
+    }
+
+    if (!dry.settled) {
+        if (temp < target * 1000 - DRYDETECT_SETTLE_BAND) { return false; }
+        dry.settled = true;
+        dry.last_on = heater_on;
+        dry.settled_ms = 0;
+        dry.window_ms = 0;
+        dry.on_ms = 0;
+        dry.peak_duty = 0;
+        dry.windows = 0;
+    }
+
+    /* 窗口在加热器打开的边沿结束, 使每个窗口包含完整的开关周期, 避免回差控制的周期波动;
+     * 加热器长时间不切换时按两倍窗口长度强制结束 */
+    const bool rising_edge = heater_on && !dry.last_on;
+    dry.last_on = heater_on;
+    if ((rising_edge && dry.window_ms >= DRYDETECT_WINDOW_MS) || dry.window_ms >= 2 * DRYDETECT_WINDOW_MS) {
+        const float duty = (float)dry.on_ms * 1000 / (float)dry.window_ms;
+        dry.window_ms = 0;
+        dry.on_ms = 0;
+
+        dry.detected = drydetect_window_end(duty);
+        if (dry.detected) {
+            ESP_LOGI(TAG, "Towels dry after %u min at target", (unsigned)(dry.settled_ms / 60000));
+            return true;
+        }
+    }
+
+    dry.settled_ms += dt_ms;
+    dry.window_ms += dt_ms;
+    if (heater_on) { dry.on_ms += dt_ms; }
+
+    return false;
+}
@@ -0,0 +1,140 @@
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "app_energy.h"
+#include "app_memory.h"
+#include "app_settings.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_energy";
+
+/* 额定功率: 未在配置中覆盖时使用板级描述表中的加热器功率 */
+#if CONFIG_APP_ENERGY_RATED_POWER_W > 0
+#define ENERGY_RATED_POWER_W CONFIG_APP_ENERGY_RATED_POWER_W
+#else
+#define ENERGY_RATED_POWER_W BSP_BOARD_HEATER_RATED_W
+#endif
+
+#define ENERGY_MJ_PER_WH        3600000
+#define ENERGY_SAVE_INTERVAL_MS (CONFIG_APP_ENERGY_SAVE_INTERVAL_MIN * 60 * 1000ULL)
+
+static SemaphoreHandle_t energy_lock = NULL;
+static TaskHandle_t energy_task_handle = NULL;
+
+/* 计量状态, 由 energy_lock 保护 */
+static struct {
+    uint64_t last_on_time_us;   // 上一次采样时的加热器累计开启时间
+    uint64_t residual_uj;       // 不足1mJ的剩余电能 (uJ)
+    uint64_t session_mj;        // 本次开机耗电量 (mJ)
+    uint64_t session_on_us;     // 本次开机加热器开启时间
+    uint64_t lifetime_mj;       // 累计耗电量 (mJ)
+    uint64_t saved_lifetime_mj; // 上一次写入NVS的累计耗电量
+} energy;
+
+/**
+ * @brief 将上次采样以来的加热器开启时间计入电能, 调用者需持有 energy_lock
+ */
+static void energy_accumulate_locked(void) {
+    const uint64_t on_time_us = bsp_heating_get_on_time_us();
+    const uint64_t delta_us = on_time_us - energy.last_on_time_us;
+    energy.last_on_time_us = on_time_us;
+
+    /* us × W = uJ */
+    const uint64_t delta_uj = delta_us * ENERGY_RATED_POWER_W + energy.residual_uj;
+    energy.residual_uj = delta_uj % 1000;
+
+    energy.session_mj += delta_uj / 1000;
+    energy.session_on_us += delta_us;
+    energy.lifetime_mj += delta_uj / 1000;
+}
+
+/**
+ * @brief 累计值有变化时写入NVS
+ */
+static void energy_save(void) {
+    xSemaphoreTake(energy_lock, portMAX_DELAY);
+    energy_accumulate_locked();
+    const uint64_t lifetime_mj = energy.lifetime_mj;
+    const bool dirty = lifetime_mj != energy.saved_lifetime_mj;
+    energy.saved_lifetime_mj = lifetime_mj;
+    xSemaphoreGive(energy_lock);
+
+    if (!dirty) { return; }
+
+    settings_set_energy_lifetime_mj(lifetime_mj);
+    if (settings_write_parameter_to_nvs() != ESP_OK) { ESP_LOGE(TAG, "Failed to save lifetime energy"); }
+}
+
+/**
+ * @brief [后台任务]电能计量
+ *
+ * 周期积分电能, 每 CONFIG_APP_ENERGY_SAVE_INTERVAL_MIN 分钟或开机结束时保存累计值, 限制NVS写入频率.
+ */
+_Noreturn static void energy_task(__attribute__((unused)) void* pvParameters) {
+    uint64_t since_save_ms = 0;
+
+    while (1) {
+        const uint32_t session_ended = ulTaskNotifyTake(pdTRUE, BSP_MS_TO_TICKS(CONFIG_APP_ENERGY_UPDATE_S * 1000));
+        since_save_ms += CONFIG_APP_ENERGY_UPDATE_S * 1000;
+
+        if (session_ended || since_save_ms >= ENERGY_SAVE_INTERVAL_MS) {
+            energy_save();
+            since_save_ms = 0;
+            continue;
+        }
+
+        xSemaphoreTake(energy_lock, portMAX_DELAY);
+        energy_accumulate_locked();
+        xSemaphoreGive(energy_lock);
+    }
+}
+
+APP_TASK_STORAGE(energy_task, 2048);
+APP_MUTEX_STORAGE(energy_lock);
+
+void app_energy_init(void) {
+    energy_lock = APP_MUTEX_CREATE(energy_lock);
+
+    energy.lifetime_mj = settings_get_energy_lifetime_mj();
+    energy.saved_lifetime_mj = energy.lifetime_mj;
+    energy.last_on_time_us = bsp_heating_get_on_time_us();
+
+    ESP_LOGI(TAG, "Lifetime energy: %" PRIu64 " Wh", energy.lifetime_mj / ENERGY_MJ_PER_WH);
+
+    APP_TASK_CREATE(
+        // 创建电能计量任务
+        energy_task, energy_task, "EnergyMeter", NULL, 5, &energy_task_handle
+    );
+}
+
+void app_energy_session_start(void) {
+    xSemaphoreTake(energy_lock, portMAX_DELAY);
+    energy_accumulate_locked();
+    energy.session_mj = 0;
+    energy.session_on_us = 0;
+    xSemaphoreGive(energy_lock);
+}
+
+void app_energy_session_end(void) {
+    app_energy_snapshot_t snapshot;
+    app_energy_get_snapshot(&snapshot);
+
+    /* 结构化日志, 便于汇总单次使用的耗电量 */
+    ESP_LOGI(TAG, "ENERGY,%" PRIu32 ",%" PRIu32 ",%" PRIu64, snapshot.session_wh, snapshot.session_on_s,
+             snapshot.lifetime_wh);
+
+    xTaskNotifyGive(energy_task_handle);
+}
+
+void app_energy_get_snapshot(app_energy_snapshot_t* snapshot) {
+    xSemaphoreTake(energy_lock, portMAX_DELAY);
+    energy_accumulate_locked();
+    snapshot->session_wh = (uint32_t)(energy.session_mj / ENERGY_MJ_PER_WH);
+    snapshot->lifetime_wh = energy.lifetime_mj / ENERGY_MJ_PER_WH;
+    snapshot->session_on_s = (uint32_t)(energy.session_on_us / 1000000);
+    xSemaphoreGive(energy_lock);
+}
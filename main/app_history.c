@@ -0,0 +1,489 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "app_history.h"
+#include "app_memory.h"
+#include "app_safety.h"
+#include "app_tasks.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_history";
+
+#define HISTORY_PARTITION_SUBTYPE 0x40   // partitions.csv 中 history 分区的子类型
+#define HISTORY_PAGE_SIZE         4096   // 页大小, 与flash擦除扇区一致
+#define HISTORY_PAGE_MAGIC        0x5448 // "TH"
+#define HISTORY_SEQ_ERASED        0xFFFFFFFF
+#define HISTORY_END_MARKER        0xFF   // 擦除后的flash, 状态字节不会取该值
+#define HISTORY_BOOT_MARKER       0x80   // 启动记录, 状态字节只用到低6位
+#define HISTORY_VARINT_MAX        5
+#define HISTORY_RECORD_MAX        (1 + 3 * HISTORY_VARINT_MAX)
+#define HISTORY_BOOT_RECORD_MAX   (2 + 4 * HISTORY_VARINT_MAX)
+
+/* 页头, 保存该页首个采样的完整值 */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;  // HISTORY_PAGE_MAGIC
+    uint16_t boot;   // 启动序号
+    uint32_t seq;    // 页序号, 按写入顺序单调递增
+    uint32_t time_s; // 首个采样时间 (s)
+    int32_t temp_dc; // 首个采样温度 (0.1°C)
+    uint16_t duty;   // 首个采样占空比 (‰)
+    uint8_t state;   // 首个采样状态
+    uint8_t reserved;
+} history_page_header_t;
+
+_Static_assert(sizeof(history_page_header_t) == 20, "history page header layout");
+
+/* 写入状态, 由 history.lock 保护 */
+static struct {
+    const esp_partition_t* partition;
+    SemaphoreHandle_t lock;
+    uint32_t page_count;
+    uint32_t head_page;        // 当前写入页
+    uint32_t head_offset;      // 当前页已写入flash的字节数
+    uint32_t next_seq;         // 下一页的序号
+    uint16_t boot;             // 本次启动序号
+    bool page_open;            // 本次启动是否已打开写入页
+    bool boot_pending;         // 写入页沿用自上次启动, 下一个采样前需写入启动记录
+    app_history_sample_t last; // 上一个采样 (差分基准)
+    uint8_t batch[CONFIG_APP_HISTORY_BATCH_BYTES];
+    uint32_t batch_len;
+} history;
+
+/**************************************************************************************************
+ * Encoding
+ **************************************************************************************************/
+
+static uint32_t history_zigzag(const int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+
+static int32_t history_unzigzag(const uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+static uint32_t history_put_varint(uint8_t* out, uint32_t value) {
+    uint32_t len = 0;
+    while (value >= 0x80) {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+}
+
+/**
+ * @brief 以上一个采样为基准编码一个采样
+ *
+ * @return 编码长度, 不超过 HISTORY_RECORD_MAX
+ */
+static uint32_t history_encode(uint8_t* out, const app_history_sample_t* prev, const app_history_sample_t* sample) {
+    uint32_t len = 0;
+    out[len++] = sample->state;
+    len += history_put_varint(out + len, sample->time_s - prev->time_s);
+    len += history_put_varint(out + len, history_zigzag(sample->temp_dc - prev->temp_dc));
+    len += history_put_varint(out + len, history_zigzag((int32_t)sample->duty - (int32_t)prev->duty));
+    return len;
+}
+
+/**
+ * @brief 编码启动记录: 标记, 启动序号与完整的首个采样 (启动后时间从0开始, 不能与上一个采样差分)
+ *
+ * @return 编码长度, 不超过 HISTORY_BOOT_RECORD_MAX
+ */
+static uint32_t history_encode_boot(uint8_t* out, const app_history_sample_t* sample) {
+    uint32_t len = 0;
+    out[len++] = HISTORY_BOOT_MARKER;
+    len += history_put_varint(out + len, sample->boot);
+    out[len++] = sample->state;
+    len += history_put_varint(out + len, sample->time_s);
+    len += history_put_varint(out + len, history_zigzag(sample->temp_dc));
+    len += history_put_varint(out + len, sample->duty);
+    return len;
+}
+
+/**************************************************************************************************
+ * Writer
+ **************************************************************************************************/
+
+static esp_err_t history_read_header(const uint32_t page, history_page_header_t* header) {
+    return esp_partition_read(history.partition, page * HISTORY_PAGE_SIZE, header, sizeof(*header));
+}
+
+static bool history_header_valid(const history_page_header_t* header) {
+    return header->magic == HISTORY_PAGE_MAGIC && header->seq != HISTORY_SEQ_ERASED;
+}
+
+/**
+ * @brief 将攒批缓存写入当前页, 调用者需持有 history.lock
+ */
+static esp_err_t history_flush_locked(void) {
+    if (history.batch_len == 0) { return ESP_OK; }
+
+    const esp_err_t ret = esp_partition_write(
+        history.partition, history.head_page * HISTORY_PAGE_SIZE + history.head_offset, history.batch,
+        history.batch_len
+    );
+    history.head_offset += history.batch_len;
+    history.batch_len = 0;
+    return ret;
+}
+
+/**
+ * @brief 擦除下一页并以该采样作为页头, 调用者需持有 history.lock
+ */
+static esp_err_t history_open_page_locked(const app_history_sample_t* first) {
+    esp_err_t ret = ESP_OK;
+
+    history.head_page = (history.head_page + 1) % history.page_count;
+    history.page_open = false;
+    history.boot_pending = false;
+
+    ESP_GOTO_ON_ERROR(
+        esp_partition_erase_range(history.partition, history.head_page * HISTORY_PAGE_SIZE, HISTORY_PAGE_SIZE), err,
+        TAG, "Erase page %" PRIu32 " failed", history.head_page
+    );
+
+    const history_page_header_t header = {
+        .magic = HISTORY_PAGE_MAGIC,
+        .boot = history.boot,
+        .seq = history.next_seq++,
+        .time_s = first->time_s,
+        .temp_dc = first->temp_dc,
+        .duty = first->duty,
+        .state = first->state,
+        .reserved = 0xFF,
+    };
+    ESP_GOTO_ON_ERROR(
+        esp_partition_write(history.partition, history.head_page * HISTORY_PAGE_SIZE, &header, sizeof(header)), err,
+        TAG, "Write page header failed"
+    );
+
+    history.head_offset = sizeof(header);
+    history.last = *first;
+    history.page_open = true;
+err:
+    return ret;
+}
+
+/**
+ * @brief 追加一个采样, 调用者需持有 history.lock
+ */
+static esp_err_t history_append_locked(const app_history_sample_t* sample) {
+    if (!history.page_open) { return history_open_page_locked(sample); }
+
+    uint8_t record[HISTORY_BOOT_RECORD_MAX];
+    const uint32_t len = history.boot_pending ? history_encode_boot(record, sample)
+                                              : history_encode(record, &history.last, sample);
+
+    /* 当前页放不下时换页, 新页的页头保存该采样 */
+    if (history.head_offset + history.batch_len + len > HISTORY_PAGE_SIZE) {
+        const esp_err_t ret = history_flush_locked();
+        if (ret != ESP_OK) { return ret; }
+        return history_open_page_locked(sample);
+    }
+
+    if (history.batch_len + len > sizeof(history.batch)) {
+        const esp_err_t ret = history_flush_locked();
+        if (ret != ESP_OK) { return ret; }
+    }
+
+    memcpy(history.batch + history.batch_len, record, len);
+    history.batch_len += len;
+    history.last = *sample;
+    history.boot_pending = false;
+    return ESP_OK;
+}
+
+/**
+ * @brief [后台任务]周期采样
+ *
+ * 占空比由两次采样间的加热器累计开启时间计算; 发生安全故障时立即写入缓存, 保留故障前的记录.
+ */
+_Noreturn static void history_task(__attribute__((unused)) void* pvParameters) {
+    uint64_t last_on_time_us = bsp_heating_get_on_time_us();
+    int64_t last_time_us = esp_timer_get_time();
+    int32_t last_temp_dc = 0;
+    app_safety_fault_t last_fault = APP_SAFETY_FAULT_NONE;
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_APP_HISTORY_PERIOD_S * 1000));
+
+        const int64_t now_us = esp_timer_get_time();
+        const uint64_t on_time_us = bsp_heating_get_on_time_us();
+        const app_safety_fault_t fault = app_safety_get_fault();
+
+        app_history_sample_t sample = {
+            .boot = history.boot,
+            .time_s = (uint32_t)(now_us / 1000000),
+            .duty = (uint16_t)((on_time_us - last_on_time_us) * 1000 / (uint64_t)(now_us - last_time_us)),
+            .state = (uint8_t)((app_tasks_is_on() ? APP_HISTORY_STATE_ON : 0) |
+                               (bsp_heating_is_enabled() ? APP_HISTORY_STATE_HEATER : 0) |
+                               ((fault << APP_HISTORY_STATE_FAULT_SHIFT) & APP_HISTORY_STATE_FAULT_MASK)),
+        };
+        last_on_time_us = on_time_us;
+        last_time_us = now_us;
+
+        int32_t temp;
+        if (bsp_heating_read_temp(&temp) == ESP_OK) {
+            last_temp_dc = temp / 100;
+        } else {
+            sample.state |= APP_HISTORY_STATE_READ_ERROR;
+        }
+        sample.temp_dc = last_temp_dc;
+
+        xSemaphoreTake(history.lock, portMAX_DELAY);
+        esp_err_t ret = history_append_locked(&sample);
+        if (ret == ESP_OK && fault != last_fault) { ret = history_flush_locked(); }
+        xSemaphoreGive(history.lock);
+
+        if (ret != ESP_OK) { ESP_LOGE(TAG, "Append failed (%s)", esp_err_to_name(ret)); }
+        last_fault = fault;
+    }
+}
+
+static bool history_reader_enter(app_history_reader_t* reader, uint32_t page, bool check_seq);
+static bool history_page_end(uint32_t page, uint32_t* end, uint16_t* boot);
+
+APP_TASK_STORAGE(history_task, 3072);
+APP_MUTEX_STORAGE(history_lock);
+
+esp_err_t app_history_init(void) {
+    history.partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, HISTORY_PARTITION_SUBTYPE, "history");
+    ESP_RETURN_ON_FALSE(history.partition != NULL, ESP_ERR_NOT_FOUND, TAG, "History partition not found");
+
+    history.lock = APP_MUTEX_CREATE(history_lock);
+    history.page_count = history.partition->size / HISTORY_PAGE_SIZE;
+
+    /* 找到序号最大的页, 本次启动在它的末尾续写, 放不下启动记录或末尾残缺时从下一页开始 */
+    bool found = false;
+    uint32_t head_seq = 0;
+    uint16_t head_boot = 0;
+    history.head_page = history.page_count - 1;
+    for (uint32_t page = 0; page < history.page_count; page++) {
+        history_page_header_t header;
+        ESP_RETURN_ON_ERROR(history_read_header(page, &header), TAG, "Read page header failed");
+        if (!history_header_valid(&header)) { continue; }
+        if (!found || header.seq > head_seq) {
+            found = true;
+            head_seq = header.seq;
+            head_boot = header.boot;
+            history.head_page = page;
+        }
+    }
+    uint32_t end = HISTORY_PAGE_SIZE;
+    const bool resume = found && history_page_end(history.head_page, &end, &head_boot) &&
+                        end + HISTORY_BOOT_RECORD_MAX <= HISTORY_PAGE_SIZE;
+
+    history.next_seq = found ? head_seq + 1 : 0;
+    history.boot = found ? head_boot + 1 : 0;
+    history.page_open = resume;
+    history.boot_pending = resume;
+    history.head_offset = resume ? end : 0;
+
+    if (resume) {
+        ESP_LOGI(TAG, "Boot %u, %" PRIu32 " pages, resuming page %" PRIu32 " at %" PRIu32 " B", history.boot,
+                 history.page_count, history.head_page, end);
+    } else {
+        ESP_LOGI(TAG, "Boot %u, %" PRIu32 " pages, next page %" PRIu32, history.boot, history.page_count,
+                 (history.head_page + 1) % history.page_count);
+    }
+
+    APP_TASK_CREATE(
+        // 创建历史采样任务
+        history_task, history_task, "History", NULL, 5, NULL
+    );
+    return ESP_OK;
+}
+
+esp_err_t app_history_flush(void) {
+    if (history.lock == NULL) { return ESP_ERR_INVALID_STATE; }
+
+    xSemaphoreTake(history.lock, portMAX_DELAY);
+    const esp_err_t ret = history_flush_locked();
+    xSemaphoreGive(history.lock);
+    return ret;
+}
+
+void app_history_get_info(app_history_info_t* info) {
+    info->page_count = history.page_count;
+    info->page_size = HISTORY_PAGE_SIZE;
+    info->boot = history.boot;
+    info->head_seq = history.next_seq - 1;
+}
+
+/**************************************************************************************************
+ * Reader
+ *
+ * 读取不持有写入锁: 读取过程中最早的页可能被擦除复用, 此时页序号不再连续, 读取提前结束.
+ **************************************************************************************************/
+
+/**
+ * @brief 读取当前页的下一个字节
+ *
+ * @return 到达页尾或读取失败时返回 false
+ */
+static bool history_reader_byte(app_history_reader_t* reader, uint8_t* byte) {
+    if (reader->offset >= HISTORY_PAGE_SIZE) { return false; }
+
+    if (reader->offset >= reader->chunk_offset + reader->chunk_len || reader->offset < reader->chunk_offset) {
+        uint32_t len = HISTORY_PAGE_SIZE - reader->offset;
+        if (len > sizeof(reader->chunk)) { len = sizeof(reader->chunk); }
+        if (esp_partition_read(history.partition, reader->page * HISTORY_PAGE_SIZE + reader->offset, reader->chunk,
+                               len) != ESP_OK) {
+            return false;
+        }
+        reader->chunk_offset = reader->offset;
+        reader->chunk_len = len;
+    }
+
+    *byte = reader->chunk[reader->offset - reader->chunk_offset];
+    reader->offset++;
+    return true;
+}
+
+static bool history_reader_varint(app_history_reader_t* reader, uint32_t* value) {
+    *value = 0;
+    for (int i = 0; i < HISTORY_VARINT_MAX; i++) {
+        uint8_t byte;
+        if (!history_reader_byte(reader, &byte)) { return false; }
+        *value |= (uint32_t)(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) { return true; }
+    }
+    return false; // 写入中断留下的残缺记录
+}
+
+/* 读取一条记录的结果 */
+typedef enum {
+    HISTORY_RECORD_OK,    // 读到一个采样
+    HISTORY_RECORD_END,   // 到达页尾或未写入的区域
+    HISTORY_RECORD_TORN,  // 写入中断留下的残缺记录, 或读取失败
+} history_record_t;
+
+/**
+ * @brief 解码当前页的下一条记录, 启动记录解码为其中的完整采样
+ */
+static history_record_t history_reader_record(app_history_reader_t* reader) {
+    uint8_t state;
+    uint32_t boot = reader->last.boot;
+    uint32_t dt, temp, duty;
+
+    if (reader->offset >= HISTORY_PAGE_SIZE) { return HISTORY_RECORD_END; }
+    if (!history_reader_byte(reader, &state)) { return HISTORY_RECORD_TORN; }
+    if (state == HISTORY_END_MARKER) { return HISTORY_RECORD_END; }
+
+    const bool boot_record = state == HISTORY_BOOT_MARKER;
+    if (boot_record && !(history_reader_varint(reader, &boot) && history_reader_byte(reader, &state))) {
+        return HISTORY_RECORD_TORN;
+    }
+    if (!history_reader_varint(reader, &dt) || !history_reader_varint(reader, &temp) ||
+        !history_reader_varint(reader, &duty)) {
+        return HISTORY_RECORD_TORN;
+    }
+
+    if (boot_record) {
+        reader->last = (app_history_sample_t){
+            .boot = (uint16_t)boot,
+            .time_s = dt,
+            .temp_dc = history_unzigzag(temp),
+            .duty = (uint16_t)duty,
+            .state = state,
+        };
+        return HISTORY_RECORD_OK;
+    }
+
+    reader->last.state = state;
+    reader->last.time_s += dt;
+    reader->last.temp_dc += history_unzigzag(temp);
+    reader->last.duty = (uint16_t)((int32_t)reader->last.duty + history_unzigzag(duty));
+    return HISTORY_RECORD_OK;
+}
+
+/**
+ * @brief 进入指定页, 页无效或序号不符时返回 false
+ */
+static bool history_reader_enter(app_history_reader_t* reader, const uint32_t page, const bool check_seq) {
+    history_page_header_t header;
+    if (history_read_header(page, &header) != ESP_OK || !history_header_valid(&header)) { return false; }
+    if (check_seq && header.seq != reader->seq + 1) { return false; }
+
+    reader->page = page;
+    reader->seq = header.seq;
+    reader->offset = sizeof(header);
+    reader->chunk_len = 0;
+    reader->header_pending = true;
+    reader->last = (app_history_sample_t){
+        .boot = header.boot,
+        .time_s = header.time_s,
+        .temp_dc = header.temp_dc,
+        .duty = header.duty,
+        .state = header.state,
+    };
+    return true;
+}
+
+esp_err_t app_history_reader_open(app_history_reader_t* reader) {
+    ESP_RETURN_ON_ERROR(app_history_flush(), TAG, "Flush failed");
+
+    /* 找到序号最小的页 */
+    bool found = false;
+    uint32_t oldest_page = 0;
+    uint32_t oldest_seq = 0;
+    for (uint32_t page = 0; page < history.page_count; page++) {
+        history_page_header_t header;
+        ESP_RETURN_ON_ERROR(history_read_header(page, &header), TAG, "Read page header failed");
+        if (!history_header_valid(&header)) { continue; }
+        if (!found || header.seq < oldest_seq) {
+            found = true;
+            oldest_seq = header.seq;
+            oldest_page = page;
+        }
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    reader->done = !found || !history_reader_enter(reader, oldest_page, false);
+    return ESP_OK;
+}
+
+bool app_history_reader_next(app_history_reader_t* reader, app_history_sample_t* sample) {
+    while (!reader->done) {
+        if (reader->header_pending) {
+            reader->header_pending = false;
+            *sample = reader->last;
+            return true;
+        }
+
+        if (history_reader_record(reader) == HISTORY_RECORD_OK) {
+            *sample = reader->last;
+            return true;
+        }
+
+        /* 本页读完, 进入序号连续的下一页 */
+        reader->done = !history_reader_enter(reader, (reader->page + 1) % history.page_count, true);
+    }
+    return false;
+}
+
+/**
+ * @brief 找到页中已写入数据的末尾与最后一条记录的启动序号
+ *
+ * @return 末尾有残缺记录或读取失败时返回 false, 此时不能在该页续写, 启动序号仍为残缺记录之前的值
+ */
+static bool history_page_end(const uint32_t page, uint32_t* end, uint16_t* boot) {
+    app_history_reader_t reader = {0};
+    if (!history_reader_enter(&reader, page, false)) { return false; }
+
+    while (1) {
+        const uint32_t offset = reader.offset;
+        const history_record_t record = history_reader_record(&reader);
+        if (record == HISTORY_RECORD_OK) { continue; }
+
+        *end = offset;
+        *boot = reader.last.boot;
+        return record == HISTORY_RECORD_END;
+    }
+}
@@ -0,0 +1,62 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "app_lzss.h"
+
+#define LZSS_LITERAL_BITS (1 + 8)
+#define LZSS_BACKREF_BITS (1 + APP_LZSS_WINDOW_BITS + APP_LZSS_LOOKAHEAD_BITS)
+#define LZSS_WINDOW_MASK  (APP_LZSS_WINDOW_SIZE - 1)
+
+_Static_assert(LZSS_BACKREF_BITS <= 24, "Token must fit in the bit accumulator");
+
+void app_lzss_init(app_lzss_decoder_t* dec) { memset(dec, 0, sizeof(*dec)); }
+
+/**
+ * @brief 取出 bits 中最高的 n 位
+ */
+static inline uint32_t lzss_take_bits(app_lzss_decoder_t* dec, const uint8_t n) {
+    dec->bit_count -= n;
+    return (dec->bits >> dec->bit_count) & ((1u << n) - 1);
+}
+
+static inline void lzss_emit(app_lzss_decoder_t* dec, const uint8_t byte, uint8_t* out, size_t* out_len) {
+    dec->window[dec->head] = byte;
+    dec->head = (dec->head + 1) & LZSS_WINDOW_MASK;
+    out[(*out_len)++] = byte;
+}
+
+size_t app_lzss_decode(app_lzss_decoder_t* dec, const uint8_t** in, size_t* in_len, uint8_t* out,
+                       const size_t out_cap) {
+    size_t out_len = 0;
+
+    while (out_len < out_cap) {
+        /* 先完成进行中的回溯复制 */
+        if (dec->copy_remaining > 0) {
+            const uint8_t byte = dec->window[(dec->head - dec->copy_distance) & LZSS_WINDOW_MASK];
+            lzss_emit(dec, byte, out, &out_len);
+            dec->copy_remaining--;
+            continue;
+        }
+
+        /* 补充输入位, 保证能解析一个完整记号 */
+        while (dec->bit_count <= 24 - 8 && *in_len > 0) {
+            dec->bits = (dec->bits << 8) | *(*in)++;
+            dec->bit_count += 8;
+            (*in_len)--;
+        }
+        if (dec->bit_count == 0) { break; }
+
+        const bool literal = (dec->bits >> (dec->bit_count - 1)) & 1;
+        if (dec->bit_count < (literal ? LZSS_LITERAL_BITS : LZSS_BACKREF_BITS)) { break; }
+
+        lzss_take_bits(dec, 1);
+        if (literal) {
+            lzss_emit(dec, (uint8_t)lzss_take_bits(dec, 8), out, &out_len);
+        } else {
+            dec->copy_distance = (uint16_t)(lzss_take_bits(dec, APP_LZSS_WINDOW_BITS) + 1);
+            dec->copy_remaining = (uint16_t)(lzss_take_bits(dec, APP_LZSS_LOOKAHEAD_BITS) + 1);
+        }
+    }
+
+    return out_len;
+}
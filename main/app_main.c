@@ -2,11 +2,32 @@
 #include "esp_log.h"
 #include "nvs_flash.h"
 
+#if CONFIG_APP_BENCH_ENABLE
+#include "app_bench.h"
+#endif
+#include "app_console.h"
+#include "app_coord.h"
+#include "app_energy.h"
+#include "app_history.h"
+#include "app_memory.h"
+#include "app_ntc_cal.h"
+#include "app_ota.h"
+#if CONFIG_APP_PUSH_ENABLE
+#include "app_push.h"
+#endif
+#include "app_safety.h"
 #include "app_settings.h"
+#if CONFIG_APP_TARIFF_ENABLE
+#include "app_tariff.h"
+#endif
 #include "app_tasks.h"
+#if CONFIG_APP_TIME_ENABLE
+#include "app_time.h"
+#endif
+#include "app_wifi.h"
 #include "bsp/towelrack_controller_a1.h"
 
-__unused static const char* TAG = "app_main";
+static const char* TAG = "app_main";
 
 static void system_init(void) {
     /* 初始化NVS (Non-Volatile Storage) 闪存 */
@@ -16,7 +37,8 @@ static void system_init(void) {
         err = nvs_flash_init();
     }
     ESP_ERROR_CHECK(err);
-    ESP_ERROR_CHECK(settings_read_parameter_from_nvs());
+    /* 参数读取失败时以默认参数继续启动, 不因参数问题反复重启 */
+    if (settings_read_parameter_from_nvs() != ESP_OK) { ESP_LOGE(TAG, "Settings not loaded, using defaults"); }
 
     /* 创建系统事件任务循环 */
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -25,6 +47,52 @@ static void system_init(void) {
 void app_main(void) {
     system_init(); // 初始化系统
 
-    bsp_init_all();   // 初始化硬件外设
-    app_tasks_init(); // 初始化应用任务
+    bsp_init_all();     // 初始化硬件外设
+
+#if CONFIG_APP_BENCH_ENABLE
+    app_bench_run(); // 基准测试构建只运行基准测试, 不启动应用
+    return;
+#endif
+
+    app_ntc_cal_init(); // 应用NTC校准系数
+    app_safety_init();  // 启动安全监控
+    app_energy_init();  // 启动电能计量
+    app_tasks_init();   // 初始化应用任务
+
+#if CONFIG_APP_HISTORY_ENABLE
+    ESP_ERROR_CHECK(app_history_init()); // 启动温度历史记录
+#endif
+
+#if CONFIG_APP_WIFI_ENABLE
+    system_wifi_init(); // 连接Wi-Fi
+#endif
+
+#if CONFIG_APP_TIME_ENABLE
+    app_time_init(); // 恢复保存的时间, 联网后通过SNTP同步
+#endif
+
+#if CONFIG_APP_COORD_ENABLE
+    app_coord_init(); // 加入峰值功率协调组, 网络未就绪时独立运行
+#endif
+
+#if CONFIG_APP_PUSH_ENABLE
+    app_push_init();           // 启动WebSocket状态推送, 网络未就绪时定期重试监听
+    app_tasks_publish_state(); // 启动前的状态变化未被记录, 发布一次当前状态
+#endif
+
+#if CONFIG_APP_TARIFF_ENABLE
+    app_tariff_init(); // 载入分时电价并规划加热
+#endif
+
+#if CONFIG_APP_OTA_ENABLE
+    app_ota_init(); // 启动OTA任务, 新镜像在此完成启动健康检查
+#endif
+
+#if !CONFIG_IDF_TARGET_LINUX
+    app_console_init(); // 启动串口命令行, 模拟板由输入脚本驱动
+#endif
+
+#if CONFIG_APP_MEMORY_REPORT_AT_BOOT
+    app_memory_report(); // 输出内存占用报告
+#endif
 }
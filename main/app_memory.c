@@ -0,0 +1,62 @@
+#include <inttypes.h>
+
+#include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#endif
+
+#include "app_memory.h"
+
+static const char* TAG = "app_memory";
+
+#define MEMORY_TRACKED_TASKS_MAX 16
+
+/* 已登记的任务, 只在启动阶段写入 */
+static struct {
+    TaskHandle_t task;
+    uint32_t stack_size;
+    bool is_static;
+} tracked_tasks[MEMORY_TRACKED_TASKS_MAX];
+static int tracked_task_count = 0;
+
+#if !CONFIG_IDF_TARGET_LINUX
+/* 链接脚本提供的段边界 */
+extern int _data_start, _data_end, _bss_start, _bss_end;
+#endif
+
+void app_memory_track_task(const TaskHandle_t task, const uint32_t stack_size, const bool is_static,
+                           TaskHandle_t* handle) {
+    configASSERT(task != NULL);
+    if (handle != NULL) { *handle = task; }
+
+    if (tracked_task_count >= MEMORY_TRACKED_TASKS_MAX) { return; }
+    tracked_tasks[tracked_task_count].task = task;
+    tracked_tasks[tracked_task_count].stack_size = stack_size;
+    tracked_tasks[tracked_task_count].is_static = is_static;
+    tracked_task_count++;
+}
+
+void app_memory_report(void) {
+    uint32_t static_stacks = 0;
+    for (int i = 0; i < tracked_task_count; i++) {
+        if (tracked_tasks[i].is_static) { static_stacks += tracked_tasks[i].stack_size; }
+    }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    ESP_LOGI(TAG, "Static: .data %d B, .bss %d B (task stacks %" PRIu32 " B)",
+             (int)((char*)&_data_end - (char*)&_data_start), (int)((char*)&_bss_end - (char*)&_bss_start),
+             static_stacks);
+    ESP_LOGI(TAG, "Heap: free %" PRIu32 " B, min free %" PRIu32 " B, largest block %u B", esp_get_free_heap_size(),
+             esp_get_minimum_free_heap_size(), (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT));
+#else
+    ESP_LOGI(TAG, "Static task stacks %" PRIu32 " B", static_stacks);
+#endif
+
+    for (int i = 0; i < tracked_task_count; i++) {
+        ESP_LOGI(TAG, "Task %-18s stack %5" PRIu32 " B (%s), high-water mark %5u B free",
+                 pcTaskGetName(tracked_tasks[i].task), tracked_tasks[i].stack_size,
+                 tracked_tasks[i].is_static ? "static" : "heap",
+                 (unsigned)uxTaskGetStackHighWaterMark(tracked_tasks[i].task));
+    }
+}
@@ -0,0 +1,109 @@
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "app_ntc_cal.h"
+#include "app_settings.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_ntc_cal";
+
+#define NTC_CAL_SAMPLE_INTERVAL_MS 20
+#define NTC_CAL_GAIN_MIN (BSP_NTC_CAL_GAIN_ONE * (100 - CONFIG_APP_NTC_CAL_MAX_GAIN_ERROR_PCT) / 100)
+#define NTC_CAL_GAIN_MAX (BSP_NTC_CAL_GAIN_ONE * (100 + CONFIG_APP_NTC_CAL_MAX_GAIN_ERROR_PCT) / 100)
+
+/* 已采集的校准点, 由命令行或UI任务访问 */
+static struct {
+    bool captured[2];
+    int32_t measured_mC[2];
+    int32_t reference_mC[2];
+} cal_points;
+
+void app_ntc_cal_init(void) {
+    int32_t gain_q16, offset_mC;
+
+    if (!settings_get_ntc_calibration(&gain_q16, &offset_mC)) { return; }
+
+    bsp_heating_set_ntc_calibration(gain_q16, offset_mC);
+    ESP_LOGI(TAG, "NTC calibration loaded: gain %.4f, offset %" PRId32 " mC", (float)gain_q16 / BSP_NTC_CAL_GAIN_ONE,
+             offset_mC);
+}
+
+void app_ntc_cal_begin(void) {
+    cal_points.captured[0] = false;
+    cal_points.captured[1] = false;
+}
+
+esp_err_t app_ntc_cal_capture(const int point, const int32_t reference_mC) {
+    ESP_RETURN_ON_FALSE(point == 0 || point == 1, ESP_ERR_INVALID_ARG, TAG, "Invalid point %d", point);
+
+    int64_t sum = 0;
+    for (int i = 0; i < CONFIG_APP_NTC_CAL_SAMPLES; i++) {
+        int32_t temp;
+        ESP_RETURN_ON_ERROR(bsp_heating_read_temp_uncalibrated(&temp), TAG, "NTC read failed");
+        sum += temp;
+        vTaskDelay(BSP_MS_TO_TICKS(NTC_CAL_SAMPLE_INTERVAL_MS));
+    }
+
+    cal_points.measured_mC[point] = (int32_t)(sum / CONFIG_APP_NTC_CAL_SAMPLES);
+    cal_points.reference_mC[point] = reference_mC;
+    cal_points.captured[point] = true;
+
+    ESP_LOGI(TAG, "Point %d: measured %" PRId32 " mC, reference %" PRId32 " mC", point + 1,
+             cal_points.measured_mC[point], reference_mC);
+    return ESP_OK;
+}
+
+esp_err_t app_ntc_cal_commit(void) {
+    ESP_RETURN_ON_FALSE(cal_points.captured[0] && cal_points.captured[1], ESP_ERR_INVALID_STATE, TAG,
+                        "Both points must be captured first");
+
+    const int32_t measured_span = cal_points.measured_mC[1] - cal_points.measured_mC[0];
+    const int32_t reference_span = cal_points.reference_mC[1] - cal_points.reference_mC[0];
+    ESP_RETURN_ON_FALSE(abs(reference_span) >= CONFIG_APP_NTC_CAL_MIN_SPAN_C * 1000 && measured_span != 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Points must be at least %d C apart", CONFIG_APP_NTC_CAL_MIN_SPAN_C);
+
+    /* 校准后温度 = gain × 测量值 + offset, 两点确定一条直线 */
+    const int32_t gain_q16 = (int32_t)(((int64_t)reference_span << 16) / measured_span);
+    const int32_t offset_mC =
+        cal_points.reference_mC[0] - (int32_t)(((int64_t)cal_points.measured_mC[0] * gain_q16) >> 16);
+    ESP_RETURN_ON_FALSE(gain_q16 >= NTC_CAL_GAIN_MIN && gain_q16 <= NTC_CAL_GAIN_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "Gain %.4f out of range", (float)gain_q16 / BSP_NTC_CAL_GAIN_ONE);
+    ESP_RETURN_ON_FALSE(abs(offset_mC) <= CONFIG_APP_NTC_CAL_MAX_OFFSET_C * 1000, ESP_ERR_INVALID_ARG, TAG,
+                        "Offset %" PRId32 " mC out of range", offset_mC);
+
+    settings_set_ntc_calibration(gain_q16, offset_mC);
+    ESP_RETURN_ON_ERROR(settings_write_parameter_to_nvs(), TAG, "Failed to save NTC calibration");
+    bsp_heating_set_ntc_calibration(gain_q16, offset_mC);
+    app_ntc_cal_begin();
+
+    ESP_LOGI(TAG, "NTC calibrated: gain %.4f, offset %" PRId32 " mC", (float)gain_q16 / BSP_NTC_CAL_GAIN_ONE,
+             offset_mC);
+    return ESP_OK;
+}
+
+esp_err_t app_ntc_cal_reset(void) {
+    settings_set_ntc_calibration(0, 0);
+    bsp_heating_set_ntc_calibration(BSP_NTC_CAL_GAIN_ONE, 0);
+    app_ntc_cal_begin();
+
+    ESP_LOGW(TAG, "NTC calibration cleared");
+    return settings_write_parameter_to_nvs();
+}
+
+void app_ntc_cal_get_status(app_ntc_cal_status_t* status) {
+    status->calibrated = settings_get_ntc_calibration(&status->gain_q16, &status->offset_mC);
+    if (!status->calibrated) {
+        status->gain_q16 = BSP_NTC_CAL_GAIN_ONE;
+        status->offset_mC = 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        status->captured[i] = cal_points.captured[i];
+        status->measured_mC[i] = cal_points.measured_mC[i];
+        status->reference_mC[i] = cal_points.reference_mC[i];
+    }
+}
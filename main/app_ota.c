@@ -0,0 +1,281 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mbedtls/sha256.h"
+
+#include "app_lzss.h"
+#include "app_memory.h"
+#include "app_ota.h"
+#include "app_safety.h"
+#include "app_tasks.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_ota";
+
+#define OTA_PACKAGE_MAGIC   "TRCZ"
+#define OTA_PACKAGE_VERSION 1
+#define OTA_URL_MAX         256
+#define OTA_RX_CHUNK        1024 // 每次从HTTP读取的字节数
+#define OTA_WRITE_CHUNK     4096 // 每次写入flash的字节数, 一个扇区
+#define OTA_REBOOT_POLL_MS  (10 * 1000)
+
+/* 升级包包头, 格式见 tools/ota_pack.py */
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint8_t version;
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint8_t reserved;
+    uint32_t image_size;   // 解压后镜像大小
+    uint32_t payload_size; // 压缩数据大小
+    uint8_t sha256[32];    // 解压后镜像的SHA-256
+} ota_package_header_t;
+
+_Static_assert(sizeof(ota_package_header_t) == 48, "OTA package header must match tools/ota_pack.py");
+
+/* 下载会话的工作缓冲区, 只在升级期间从堆中分配 */
+typedef struct {
+    app_lzss_decoder_t decoder;
+    mbedtls_sha256_context sha;
+    uint8_t rx[OTA_RX_CHUNK];
+    uint8_t out[OTA_WRITE_CHUNK];
+    size_t out_len;
+} ota_session_t;
+
+static struct {
+    volatile app_ota_state_t state;
+    volatile bool cancel; // 由OTA任务在处理下一块数据前检查
+    char url[OTA_URL_MAX];
+    uint32_t image_size;
+    uint32_t written;
+    uint32_t received;
+    esp_err_t last_error;
+} ota = {.state = APP_OTA_IDLE};
+
+static TaskHandle_t ota_task_handle = NULL;
+
+/**
+ * @brief 从HTTP连接读取指定长度的数据
+ */
+static esp_err_t ota_read_exact(esp_http_client_handle_t client, uint8_t* buf, const size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        const int n = esp_http_client_read(client, (char*)buf + done, (int)(len - done));
+        if (n <= 0) { return ESP_ERR_INVALID_RESPONSE; }
+        done += n;
+    }
+    ota.received += len;
+    return ESP_OK;
+}
+
+/**
+ * @brief 将解压缓冲区写入OTA分区并计入镜像摘要
+ */
+static esp_err_t ota_flush(ota_session_t* session, const esp_ota_handle_t ota_handle) {
+    mbedtls_sha256_update(&session->sha, session->out, session->out_len);
+    ESP_RETURN_ON_ERROR(esp_ota_write(ota_handle, session->out, session->out_len), TAG, "Flash write failed");
+    ota.written += session->out_len;
+    session->out_len = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief 下载升级包, 流式解压写入空闲OTA分区, 校验后切换启动分区
+ */
+static esp_err_t ota_download(ota_session_t* session) {
+    esp_err_t ret = ESP_OK;
+    esp_ota_handle_t ota_handle = 0;
+    bool ota_begun = false;
+
+    const esp_http_client_config_t http_config = {
+        .url = ota.url,
+        .timeout_ms = CONFIG_APP_OTA_HTTP_TIMEOUT_MS,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&http_config);
+    ESP_RETURN_ON_FALSE(client != NULL, ESP_ERR_NO_MEM, TAG, "HTTP client init failed");
+
+    app_lzss_init(&session->decoder);
+    mbedtls_sha256_init(&session->sha);
+    mbedtls_sha256_starts(&session->sha, 0);
+
+    ESP_GOTO_ON_ERROR(esp_http_client_open(client, 0), cleanup, TAG, "Connection to %s failed", ota.url);
+    esp_http_client_fetch_headers(client);
+    const int status = esp_http_client_get_status_code(client);
+    ESP_GOTO_ON_FALSE(status == 200, ESP_ERR_INVALID_RESPONSE, cleanup, TAG, "HTTP status %d", status);
+
+    /* 检查包头 */
+    ota_package_header_t header;
+    ESP_GOTO_ON_ERROR(ota_read_exact(client, (uint8_t*)&header, sizeof(header)), cleanup, TAG, "Header read failed");
+    ESP_GOTO_ON_FALSE(memcmp(header.magic, OTA_PACKAGE_MAGIC, sizeof(header.magic)) == 0 &&
+                          header.version == OTA_PACKAGE_VERSION,
+                      ESP_ERR_INVALID_VERSION, cleanup, TAG, "Not an OTA package");
+    ESP_GOTO_ON_FALSE(header.window_bits == APP_LZSS_WINDOW_BITS && header.lookahead_bits == APP_LZSS_LOOKAHEAD_BITS,
+                      ESP_ERR_NOT_SUPPORTED, cleanup, TAG, "Unsupported compression -w %d -l %d", header.window_bits,
+                      header.lookahead_bits);
+
+    const esp_partition_t* target = esp_ota_get_next_update_partition(NULL);
+    ESP_GOTO_ON_FALSE(target != NULL, ESP_ERR_NOT_FOUND, cleanup, TAG, "No OTA partition");
+    ESP_GOTO_ON_FALSE(header.image_size <= target->size, ESP_ERR_INVALID_SIZE, cleanup, TAG,
+                      "Image of %" PRIu32 " bytes does not fit %s", header.image_size, target->label);
+    ota.image_size = header.image_size;
+
+    /* 顺序写入时按需逐扇区擦除, 避免一次擦除整个分区长时间占用flash */
+    ESP_GOTO_ON_ERROR(esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &ota_handle), cleanup, TAG,
+                      "OTA begin failed");
+    ota_begun = true;
+    ESP_LOGI(TAG, "Writing %" PRIu32 " bytes (%" PRIu32 " compressed) to %s", header.image_size,
+             header.payload_size, target->label);
+
+    uint32_t payload_left = header.payload_size;
+    while (ota.written < header.image_size) {
+        ESP_GOTO_ON_FALSE(!ota.cancel, ESP_ERR_INVALID_STATE, cleanup, TAG, "Cancelled");
+        ESP_GOTO_ON_FALSE(payload_left > 0, ESP_ERR_INVALID_SIZE, cleanup, TAG, "Payload truncated");
+
+        const int len = esp_http_client_read(client, (char*)session->rx,
+                                             (int)(payload_left < OTA_RX_CHUNK ? payload_left : OTA_RX_CHUNK));
+        ESP_GOTO_ON_FALSE(len > 0, ESP_ERR_INVALID_RESPONSE, cleanup, TAG, "Connection lost after %" PRIu32 " bytes",
+                          ota.received);
+        payload_left -= len;
+        ota.received += len;
+
+        /* 解压本次收到的数据, 写满一个扇区或到达镜像末尾时写入flash */
+        const uint8_t* in = session->rx;
+        size_t in_len = len;
+        while (ota.written < header.image_size) {
+            const uint32_t image_left = header.image_size - ota.written - session->out_len;
+            const size_t cap = image_left < OTA_WRITE_CHUNK - session->out_len ? image_left
+                                                                               : OTA_WRITE_CHUNK - session->out_len;
+            session->out_len += app_lzss_decode(&session->decoder, &in, &in_len, session->out + session->out_len, cap);
+
+            if (session->out_len < OTA_WRITE_CHUNK && ota.written + session->out_len < header.image_size) { break; }
+            ESP_GOTO_ON_ERROR(ota_flush(session, ota_handle), cleanup, TAG, "Write failed at %" PRIu32, ota.written);
+        }
+    }
+
+    /* 校验镜像摘要, esp_ota_end 再校验应用镜像格式 (及安全启动签名) */
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&session->sha, digest);
+    ESP_GOTO_ON_FALSE(memcmp(digest, header.sha256, sizeof(digest)) == 0, ESP_ERR_INVALID_CRC, cleanup, TAG,
+                      "Image digest mismatch");
+    ota_begun = false;
+    ESP_GOTO_ON_ERROR(esp_ota_end(ota_handle), cleanup, TAG, "Image validation failed");
+    ESP_GOTO_ON_ERROR(esp_ota_set_boot_partition(target), cleanup, TAG, "Set boot partition failed");
+
+cleanup:
+    if (ota_begun) { esp_ota_abort(ota_handle); }
+    mbedtls_sha256_free(&session->sha);
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return ret;
+}
+
+/**
+ * @brief 新镜像首次启动后的健康检查, 未通过则回滚
+ *
+ * 检查项: 安全监控无故障, NTC可读. 运行到检查点之前的任何复位都会由 bootloader 回滚.
+ */
+static void ota_health_check(void) {
+    esp_ota_img_states_t img_state;
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (esp_ota_get_state_partition(running, &img_state) != ESP_OK || img_state != ESP_OTA_IMG_PENDING_VERIFY) {
+        return;
+    }
+
+    ESP_LOGW(TAG, "Image in %s pending verification, health check in %d s", running->label,
+             CONFIG_APP_OTA_HEALTH_CHECK_S);
+    vTaskDelay(BSP_MS_TO_TICKS(CONFIG_APP_OTA_HEALTH_CHECK_S * 1000));
+
+    int32_t temp;
+    const app_safety_fault_t fault = app_safety_get_fault();
+    const esp_err_t ntc_ret = bsp_heating_read_temp(&temp);
+    if (fault == APP_SAFETY_FAULT_NONE && ntc_ret == ESP_OK) {
+        ESP_ERROR_CHECK(esp_ota_mark_app_valid_cancel_rollback());
+        ESP_LOGI(TAG, "Health check passed, image confirmed");
+        return;
+    }
+
+    ESP_LOGE(TAG, "Health check failed (fault E%d, NTC %s), rolling back", fault, esp_err_to_name(ntc_ret));
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+}
+
+/**
+ * @brief [任务]OTA升级
+ *
+ * 优先级低于所有控制任务, 下载与写入flash只占用空闲时间.
+ * 升级完成后等待设备关机 (不在加热中) 再重启, 避免中断正在进行的加热.
+ */
+_Noreturn static void ota_task(__attribute__((unused)) void* pvParameters) {
+    ota_health_check();
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        ota_session_t* session = calloc(1, sizeof(ota_session_t));
+        const esp_err_t ret = session != NULL ? ota_download(session) : ESP_ERR_NO_MEM;
+        free(session);
+
+        if (ret != ESP_OK) {
+            ota.last_error = ret;
+            ota.state = ota.cancel ? APP_OTA_CANCELLED : APP_OTA_FAILED;
+            ESP_LOGE(TAG, "Update %s (%s)", ota.cancel ? "cancelled" : "failed", esp_err_to_name(ret));
+            continue;
+        }
+
+        ota.state = APP_OTA_READY;
+        ESP_LOGI(TAG, "Update written, restarting once heating is off");
+        while (app_tasks_is_on()) { vTaskDelay(BSP_MS_TO_TICKS(OTA_REBOOT_POLL_MS)); }
+        esp_restart();
+    }
+}
+
+APP_TASK_STORAGE(ota_task, 8192);
+
+void app_ota_init(void) {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    ESP_LOGI(TAG, "Running from %s", running->label);
+
+    APP_TASK_CREATE(
+        // 创建OTA任务, 优先级低于所有控制任务
+        ota_task, ota_task, "OTA", NULL, 2, &ota_task_handle
+    );
+}
+
+esp_err_t app_ota_start(const char* url) {
+    ESP_RETURN_ON_FALSE(ota.state != APP_OTA_DOWNLOADING && ota.state != APP_OTA_READY, ESP_ERR_INVALID_STATE, TAG,
+                        "Update already in progress");
+    ESP_RETURN_ON_FALSE(strlen(url) < OTA_URL_MAX, ESP_ERR_INVALID_ARG, TAG, "URL too long");
+
+    strcpy(ota.url, url);
+    ota.image_size = 0;
+    ota.written = 0;
+    ota.received = 0;
+    ota.last_error = ESP_OK;
+    ota.cancel = false;
+    ota.state = APP_OTA_DOWNLOADING;
+    xTaskNotifyGive(ota_task_handle);
+
+    ESP_LOGI(TAG, "Update from %s", url);
+    return ESP_OK;
+}
+
+void app_ota_cancel(void) {
+    if (ota.state == APP_OTA_DOWNLOADING) { ota.cancel = true; }
+}
+
+void app_ota_get_status(app_ota_status_t* status) {
+    status->state = ota.state;
+    status->image_size = ota.image_size;
+    status->written = ota.written;
+    status->received = ota.received;
+    status->last_error = ota.last_error;
+}
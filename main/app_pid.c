@@ -0,0 +1,33 @@
+#include "app_pid.h"
+
+#define PID_OUTPUT_MAX 1000.0f
+
+void app_pid_init(app_pid_t* pid, const float kp, const float ki, const float kd) {
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->integral = 0;
+    pid->last_input = 0;
+    pid->primed = false;
+}
+
+uint32_t app_pid_update(app_pid_t* pid, const float setpoint, const float input, const float dt_s) {
+    const float error = setpoint - input;
+    const float derivative = pid->primed ? (input - pid->last_input) / dt_s : 0;
+
+    pid->last_input = input;
+    pid->primed = true;
+
+    const float unclamped = pid->kp * error + pid->integral - pid->kd * derivative;
+
+    /* 条件积分: 输出饱和且误差会加深饱和时不再累积 */
+    const bool saturated_high = unclamped >= PID_OUTPUT_MAX && error > 0;
+    const bool saturated_low = unclamped <= 0 && error < 0;
+    if (!saturated_high && !saturated_low) { pid->integral += pid->ki * error * dt_s; }
+
+    float output = pid->kp * error + pid->integral - pid->kd * derivative;
+    if (output > PID_OUTPUT_MAX) { output = PID_OUTPUT_MAX; }
+    if (output < 0) { output = 0; }
+
+    return (uint32_t)output;
+}
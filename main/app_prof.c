@@ -0,0 +1,191 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "riscv/csr.h"
+
+#include "app_prof.h"
+
+static const char* TAG = "app_prof";
+
+#define PROF_TIMER_RESOLUTION_HZ 1000000 // 1MHz
+#define PROF_TIMER_PRIORITY      3       // C中断处理程序可用的最高优先级, 可打断数码管刷新等中断
+#define PROF_PROBE_MAX           8       // 直方图线性探测的最大次数, 限制中断耗时
+#define PROF_TASKS_MAX           24      // 可区分的任务数, 包含 ISR
+#define PROF_TASK_ISR            0       // 被中断的代码在中断中
+#define PROF_TASK_OTHER          0xFF    // 任务表已满
+
+/* 直方图槽位, count 为0表示空闲 */
+typedef struct {
+    uint32_t pc;
+    uint32_t count;
+    uint8_t task;
+} prof_slot_t;
+
+/* 任务表, 采样中断中登记; 名字在登记时复制, 任务被删除后仍可输出 */
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+} prof_task_t;
+
+static prof_slot_t prof_slots[CONFIG_APP_PROF_SLOTS];
+static prof_task_t prof_tasks[PROF_TASKS_MAX];
+static int prof_task_count = 0;
+
+static struct {
+    gptimer_handle_t timer;
+    bool running;
+    uint32_t rate_hz;
+    uint32_t samples;
+    uint32_t dropped;
+    uint32_t slots_used;
+    int64_t start_us;
+    int64_t duration_us;
+} prof = {0};
+
+/**************************************************************************************************
+ * Sampling ISR
+ **************************************************************************************************/
+
+/**
+ * @brief 当前任务在任务表中的序号, 首次出现时登记
+ *
+ * 被中断的代码是否在中断中由移植层的公开接口 xPortInterruptedFromISRContext() 判断.
+ * 若移植层把采样中断本身也计入, 所有采样都会归入 ISR, tools/profile_fold.py 对此给出警告.
+ */
+static uint8_t IRAM_ATTR prof_task_index(void) {
+    if (xPortInterruptedFromISRContext()) { return PROF_TASK_ISR; }
+
+    const TaskHandle_t handle = xTaskGetCurrentTaskHandle();
+    for (int i = 1; i < prof_task_count; i++) {
+        if (prof_tasks[i].handle == handle) { return (uint8_t)i; }
+    }
+    if (prof_task_count >= PROF_TASKS_MAX) { return PROF_TASK_OTHER; }
+
+    prof_task_t* task = &prof_tasks[prof_task_count];
+    task->handle = handle;
+    strncpy(task->name, pcTaskGetName(handle), sizeof(task->name) - 1);
+    return (uint8_t)prof_task_count++;
+}
+
+/**
+ * @brief 采样定时器回调: 读取被中断的指令地址, 计入直方图
+ *
+ * 其他中断不会嵌套在本中断中, 读取前 mepc 不会被覆盖.
+ */
+static bool IRAM_ATTR prof_sample_cb(
+    gptimer_handle_t timer, const gptimer_alarm_event_data_t* event, void* user_data
+) {
+    const uint32_t pc = RV_READ_CSR(mepc);
+    const uint8_t task = prof_task_index();
+
+    uint32_t index = ((pc >> 1) * 2654435761U ^ task) % CONFIG_APP_PROF_SLOTS;
+    for (int probe = 0; probe < PROF_PROBE_MAX; probe++) {
+        prof_slot_t* slot = &prof_slots[index];
+        if (slot->count == 0) {
+            slot->pc = pc;
+            slot->task = task;
+            prof.slots_used++;
+        }
+        if (slot->pc == pc && slot->task == task) {
+            slot->count++;
+            prof.samples++;
+            return pdFALSE;
+        }
+        index = (index + 1) % CONFIG_APP_PROF_SLOTS;
+    }
+    prof.dropped++;
+    return pdFALSE;
+}
+
+/**************************************************************************************************
+ * Control
+ **************************************************************************************************/
+
+static esp_err_t prof_timer_init(void) {
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PROF_TIMER_RESOLUTION_HZ,
+        .intr_priority = PROF_TIMER_PRIORITY,
+    };
+    const gptimer_event_callbacks_t callbacks = {
+        .on_alarm = prof_sample_cb,
+    };
+
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &prof.timer), TAG, "Failed to create sampling timer");
+    ESP_RETURN_ON_ERROR(gptimer_register_event_callbacks(prof.timer, &callbacks, NULL), TAG,
+                        "Failed to register sampling callback");
+    return gptimer_enable(prof.timer);
+}
+
+esp_err_t app_prof_start(uint32_t rate_hz) {
+    if (rate_hz == 0) { rate_hz = CONFIG_APP_PROF_RATE_HZ; }
+    if (rate_hz < 10 || rate_hz > 10000) { return ESP_ERR_INVALID_ARG; }
+    if (prof.running) { return ESP_ERR_INVALID_STATE; }
+    if (prof.timer == NULL) { ESP_RETURN_ON_ERROR(prof_timer_init(), TAG, "Failed to initialize profiler"); }
+
+    memset(prof_slots, 0, sizeof(prof_slots));
+    memset(prof_tasks, 0, sizeof(prof_tasks));
+    strcpy(prof_tasks[PROF_TASK_ISR].name, "ISR");
+    prof_task_count = 1;
+    prof.samples = 0;
+    prof.dropped = 0;
+    prof.slots_used = 0;
+    prof.duration_us = 0;
+    prof.rate_hz = rate_hz;
+
+    const gptimer_alarm_config_t alarm_config = {
+        .alarm_count = PROF_TIMER_RESOLUTION_HZ / rate_hz,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_set_raw_count(prof.timer, 0), TAG, "Failed to reset sampling timer");
+    ESP_RETURN_ON_ERROR(gptimer_set_alarm_action(prof.timer, &alarm_config), TAG, "Failed to set sampling rate");
+    prof.start_us = esp_timer_get_time();
+    ESP_RETURN_ON_ERROR(gptimer_start(prof.timer), TAG, "Failed to start sampling timer");
+    prof.running = true;
+
+    ESP_LOGI(TAG, "Sampling at %" PRIu32 " Hz", rate_hz);
+    return ESP_OK;
+}
+
+void app_prof_stop(void) {
+    if (!prof.running) { return; }
+    ESP_ERROR_CHECK(gptimer_stop(prof.timer));
+    prof.running = false;
+    prof.duration_us += esp_timer_get_time() - prof.start_us;
+    ESP_LOGI(TAG, "Stopped after %" PRIu32 " samples (%" PRIu32 " dropped)", prof.samples, prof.dropped);
+}
+
+void app_prof_dump(void) {
+    app_prof_stop();
+
+    printf("PROF_INFO,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n", prof.rate_hz, prof.samples, prof.dropped,
+           (uint32_t)(prof.duration_us / 1000));
+    for (int i = 0; i < prof_task_count; i++) { printf("PROF_TASK,%d,%s\n", i, prof_tasks[i].name); }
+    printf("PROF_TASK,%d,other\n", PROF_TASK_OTHER);
+    for (int i = 0; i < CONFIG_APP_PROF_SLOTS; i++) {
+        const prof_slot_t* slot = &prof_slots[i];
+        if (slot->count == 0) { continue; }
+        printf("PROF,%08" PRIx32 ",%u,%" PRIu32 "\n", slot->pc, slot->task, slot->count);
+    }
+    printf("PROF_END\n");
+    fflush(stdout);
+}
+
+void app_prof_get_status(app_prof_status_t* status) {
+    status->running = prof.running;
+    status->rate_hz = prof.rate_hz;
+    status->samples = prof.samples;
+    status->dropped = prof.dropped;
+    status->slots_used = prof.slots_used;
+    const int64_t running_us = prof.running ? esp_timer_get_time() - prof.start_us : 0;
+    status->duration_ms = (uint32_t)((prof.duration_us + running_us) / 1000);
+}
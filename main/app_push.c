@@ -0,0 +1,534 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/sha1.h"
+
+#include "app_memory.h"
+#include "app_push.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_push";
+
+#define PUSH_POLL_MS  100  // 无状态更新时的套接字轮询间隔
+#define PUSH_RETRY_MS 5000 // 监听套接字创建失败后的重试间隔
+#define PUSH_RX_MAX   512  // 握手请求与客户端帧的接收缓冲区
+#define PUSH_WS_GUID  "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+_Static_assert(CONFIG_APP_PUSH_TX_BUFFER >= 2 + 125, "push frames must fit in the transmit buffer");
+
+/* 状态字段, 用作待发送字段的位掩码 */
+enum {
+    PUSH_FIELD_SETPOINT = 1 << 0,
+    PUSH_FIELD_TEMP = 1 << 1,
+    PUSH_FIELD_MODE = 1 << 2,
+    PUSH_FIELD_REMAINING = 1 << 3,
+    PUSH_FIELD_ALL = (1 << 4) - 1,
+};
+
+typedef enum {
+    PUSH_CLIENT_FREE,
+    PUSH_CLIENT_HANDSHAKE, // 等待 HTTP Upgrade 请求
+    PUSH_CLIENT_OPEN,      // 已建立, 推送状态帧
+    PUSH_CLIENT_CLOSING,   // 发送完缓冲区后关闭
+} push_client_phase_t;
+
+/* 客户端连接, 只在推送任务中访问 */
+typedef struct {
+    int sock;
+    push_client_phase_t phase;
+    char rx[PUSH_RX_MAX + 1]; // 预留结尾的 '\0' 供解析握手请求
+    size_t rx_len;
+    uint8_t tx[CONFIG_APP_PUSH_TX_BUFFER];
+    size_t tx_len;            // 缓冲区中的字节数
+    size_t tx_sent;           // 已写入套接字的字节数
+    int64_t last_frame_ms;    // 上一状态帧生成的时刻
+    int64_t stalled_since_ms; // 发送开始没有进展的时刻, 0 为未停滞
+} push_client_t;
+
+static push_client_t push_clients[CONFIG_APP_PUSH_MAX_CLIENTS];
+static TaskHandle_t push_task_handle = NULL;
+
+/* 与发布者共享的状态, 由 push_lock 保护 */
+static SemaphoreHandle_t push_lock = NULL;
+static struct {
+    app_push_state_t state;                      // 最近发布的状态
+    uint32_t dirty[CONFIG_APP_PUSH_MAX_CLIENTS]; // 各客户端待发送的字段
+    bool open[CONFIG_APP_PUSH_MAX_CLIENTS];      // 客户端是否已建立 WebSocket 连接
+    app_push_status_t status;
+} push = {0};
+
+static int64_t push_now_ms(void) { return (int64_t)BSP_TICKS_TO_MS(xTaskGetTickCount()); }
+
+/**
+ * @brief 温度按推送的分辨率 (0.1°C) 取整
+ */
+static int32_t push_temp_decicelsius(const int32_t milli_celsius) {
+    return milli_celsius >= 0 ? (milli_celsius + 50) / 100 : (milli_celsius - 50) / 100;
+}
+
+/**************************************************************************************************
+ * Frames
+ **************************************************************************************************/
+
+static const char* push_mode_name(const app_push_mode_t mode) {
+    switch (mode) {
+        case APP_PUSH_MODE_ON: return "on";
+        case APP_PUSH_MODE_AUTOTUNE: return "autotune";
+        case APP_PUSH_MODE_FAULT: return "fault";
+        default: return "off";
+    }
+}
+
+/**
+ * @brief 生成只含 fields 中字段的 JSON 对象
+ *
+ * @return 长度, 不含结尾的 '\0'
+ */
+static size_t push_format_delta(char* out, const size_t size, const uint32_t fields, const app_push_state_t* state) {
+    size_t len = 0;
+    const char* sep = "{";
+
+    if (fields & PUSH_FIELD_SETPOINT) {
+        len += snprintf(out + len, size - len, "%s\"setpoint\":%d", sep, state->setpoint);
+        sep = ",";
+    }
+    if (fields & PUSH_FIELD_TEMP) {
+        const int32_t dc = push_temp_decicelsius(state->temperature);
+        const int32_t abs_dc = dc < 0 ? -dc : dc;
+        len += snprintf(out + len, size - len, "%s\"temp\":%s%" PRId32 ".%" PRId32, sep, dc < 0 ? "-" : "",
+                        abs_dc / 10, abs_dc % 10);
+        sep = ",";
+    }
+    if (fields & PUSH_FIELD_MODE) {
+        len += snprintf(out + len, size - len, "%s\"mode\":\"%s\"", sep, push_mode_name(state->mode));
+        sep = ",";
+    }
+    if (fields & PUSH_FIELD_REMAINING) {
+        len += snprintf(out + len, size - len, "%s\"remaining\":%d", sep, state->remaining_min);
+    }
+    len += snprintf(out + len, size - len, "}");
+    return len;
+}
+
+/**
+ * @brief 在发送缓冲区末尾追加一个不分片、不加掩码的服务端帧
+ *
+ * @return 缓冲区空间不足时返回 false, 不追加
+ */
+static bool push_queue_frame(push_client_t* client, const uint8_t opcode, const void* payload, const size_t len) {
+    if (len > 125 || client->tx_len + 2 + len > sizeof(client->tx)) { return false; }
+
+    client->tx[client->tx_len++] = 0x80 | opcode; // FIN
+    client->tx[client->tx_len++] = (uint8_t)len;
+    memcpy(client->tx + client->tx_len, payload, len);
+    client->tx_len += len;
+    return true;
+}
+
+/**************************************************************************************************
+ * Connections
+ **************************************************************************************************/
+
+static void push_set_open(const int index, const bool open) {
+    xSemaphoreTake(push_lock, portMAX_DELAY);
+    if (open != push.open[index]) { push.status.clients += open ? 1 : -1; }
+    push.open[index] = open;
+    push.dirty[index] = open ? PUSH_FIELD_ALL : 0; // 新连接先推送完整状态
+    xSemaphoreGive(push_lock);
+}
+
+static void push_close(const int index) {
+    push_client_t* client = &push_clients[index];
+
+    close(client->sock);
+    client->sock = -1;
+    client->phase = PUSH_CLIENT_FREE;
+    push_set_open(index, false);
+}
+
+/**
+ * @brief 在握手请求中查找请求头, 头名不区分大小写
+ *
+ * @param name 请求头名, 含开头的 "\r\n" 与结尾的 ':'
+ * @return 去掉前导空格的头值, 不存在时返回 NULL
+ */
+static const char* push_find_header(const char* request, const char* name) {
+    const size_t name_len = strlen(name);
+    for (const char* line = strstr(request, "\r\n"); line != NULL; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line, name, name_len) == 0) {
+            const char* value = line + name_len;
+            while (*value == ' ') { value++; }
+            return value;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 头值是否以 token 开头 (不区分大小写), 且 token 后为值的结尾或分隔符
+ */
+static bool push_header_is(const char* value, const char* token) {
+    const size_t len = strlen(token);
+    return value != NULL && strncasecmp(value, token, len) == 0 && strchr(" ,\r", value[len]) != NULL;
+}
+
+/**
+ * @brief 回复握手失败并在发送完后关闭连接
+ */
+static void push_reject(push_client_t* client, const char* response) {
+    client->tx_len = snprintf((char*)client->tx, sizeof(client->tx), "%sConnection: close\r\nContent-Length: 0\r\n\r\n",
+                              response);
+    client->phase = PUSH_CLIENT_CLOSING;
+}
+
+/**
+ * @brief 处理 HTTP Upgrade 请求, 回复握手响应
+ *
+ * 按 RFC 6455 4.2.1 检查请求: 非 GET 或缺少 Sec-WebSocket-Key 回复 400,
+ * 不是 websocket 升级或版本不为 13 回复 426 并注明支持的协议与版本
+ *
+ * @return 请求尚未接收完整时返回 false
+ */
+static bool push_handshake(const int index) {
+    push_client_t* client = &push_clients[index];
+    client->rx[client->rx_len] = '\0';
+    if (strstr(client->rx, "\r\n\r\n") == NULL) { return false; }
+
+    const char* key = push_find_header(client->rx, "\r\nSec-WebSocket-Key:");
+    if (strncmp(client->rx, "GET ", 4) != 0 || key == NULL || *key == '\r') {
+        push_reject(client, "HTTP/1.1 400 Bad Request\r\n");
+        return true;
+    }
+    if (!push_header_is(push_find_header(client->rx, "\r\nUpgrade:"), "websocket")) {
+        push_reject(client, "HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\n");
+        return true;
+    }
+    if (!push_header_is(push_find_header(client->rx, "\r\nSec-WebSocket-Version:"), "13")) {
+        push_reject(client, "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\n");
+        return true;
+    }
+
+    /* Sec-WebSocket-Accept = base64(SHA-1(key + GUID)) */
+    size_t key_len = strcspn(key, " \r");
+    if (key_len > 64) { key_len = 64; }
+    char material[64 + sizeof(PUSH_WS_GUID)];
+    memcpy(material, key, key_len);
+    memcpy(material + key_len, PUSH_WS_GUID, sizeof(PUSH_WS_GUID) - 1);
+    uint8_t digest[20];
+    unsigned char accept[32];
+    size_t accept_len = 0;
+    mbedtls_sha1((const unsigned char*)material, key_len + sizeof(PUSH_WS_GUID) - 1, digest);
+    mbedtls_base64_encode(accept, sizeof(accept), &accept_len, digest, sizeof(digest));
+
+    client->tx_len = snprintf((char*)client->tx, sizeof(client->tx),
+                              "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                              "Sec-WebSocket-Accept: %.*s\r\n\r\n",
+                              (int)accept_len, accept);
+    client->rx_len = 0; // 客户端在收到响应前不会发送帧
+    client->phase = PUSH_CLIENT_OPEN;
+    push_set_open(index, true);
+    return true;
+}
+
+/**
+ * @brief 处理客户端发来的帧: 回应 ping 与 close, 其余丢弃
+ *
+ * 客户端帧必须加掩码 (RFC 6455 5.1), 未加掩码时以状态码 1002 (协议错误) 关闭连接
+ *
+ * @return 帧超过接收缓冲区或格式错误时返回 false
+ */
+static bool push_process_frames(push_client_t* client) {
+    while (client->rx_len >= 2) {
+        const uint8_t* rx = (const uint8_t*)client->rx;
+        const uint8_t opcode = rx[0] & 0x0F;
+        const bool masked = rx[1] & 0x80;
+        size_t header = 2;
+
+        if (!masked) {
+            static const uint8_t protocol_error[] = {1002 >> 8, 1002 & 0xFF};
+            client->rx_len = 0;
+            client->phase = PUSH_CLIENT_CLOSING;
+            return push_queue_frame(client, 0x8, protocol_error, sizeof(protocol_error));
+        }
+        uint64_t len = rx[1] & 0x7F;
+
+        if (len == 126) {
+            if (client->rx_len < 4) { return true; }
+            len = (uint64_t)rx[2] << 8 | rx[3];
+            header = 4;
+        } else if (len == 127) {
+            return false; // 超过接收缓冲区
+        }
+        header += 4;
+        if (header + len > PUSH_RX_MAX) { return false; }
+        if (client->rx_len < header + len) { return true; }
+
+        uint8_t payload[125];
+        const size_t payload_len = len < sizeof(payload) ? (size_t)len : sizeof(payload);
+        for (size_t i = 0; i < payload_len; i++) {
+            payload[i] = rx[header + i] ^ rx[header - 4 + i % 4];
+        }
+
+        if (opcode == 0x8) { // close: 回应相同的状态码后关闭
+            push_queue_frame(client, 0x8, payload, payload_len < 2 ? payload_len : 2);
+            client->phase = PUSH_CLIENT_CLOSING;
+        } else if (opcode == 0x9) { // ping: 缓冲区已满时不回应, 由客户端超时重试
+            push_queue_frame(client, 0xA, payload, payload_len);
+        }
+
+        memmove(client->rx, client->rx + header + len, client->rx_len - header - len);
+        client->rx_len -= header + len;
+    }
+    return true;
+}
+
+/**
+ * @brief 将发送缓冲区写入套接字
+ *
+ * @return 连接出错或停滞超时时返回 false
+ */
+static bool push_flush(const int index, const int64_t now_ms) {
+    push_client_t* client = &push_clients[index];
+
+    while (client->tx_sent < client->tx_len) {
+        const ssize_t n = send(client->sock, client->tx + client->tx_sent, client->tx_len - client->tx_sent,
+                               MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            client->tx_sent += n;
+            client->stalled_since_ms = 0;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (client->stalled_since_ms == 0) { client->stalled_since_ms = now_ms; }
+            if (now_ms - client->stalled_since_ms < CONFIG_APP_PUSH_STALL_TIMEOUT_S * 1000) { return true; }
+
+            ESP_LOGW(TAG, "Client %d stalled for %d s, dropping", index, CONFIG_APP_PUSH_STALL_TIMEOUT_S);
+            xSemaphoreTake(push_lock, portMAX_DELAY);
+            push.status.dropped++;
+            xSemaphoreGive(push_lock);
+        }
+        return false;
+    }
+
+    client->tx_len = 0;
+    client->tx_sent = 0;
+    return true;
+}
+
+/**
+ * @brief 发送缓冲区已排空且满足最小间隔时, 把待发送字段合并为一帧
+ */
+static void push_compose(const int index, const int64_t now_ms) {
+    push_client_t* client = &push_clients[index];
+    if (client->phase != PUSH_CLIENT_OPEN || client->tx_len > 0) { return; }
+    if (now_ms - client->last_frame_ms < CONFIG_APP_PUSH_MIN_INTERVAL_MS) { return; }
+
+    xSemaphoreTake(push_lock, portMAX_DELAY);
+    const uint32_t fields = push.dirty[index];
+    const app_push_state_t state = push.state;
+    push.dirty[index] = 0;
+    if (fields) { push.status.frames++; }
+    xSemaphoreGive(push_lock);
+    if (!fields) { return; }
+
+    char json[126];
+    const size_t len = push_format_delta(json, sizeof(json), fields, &state);
+    push_queue_frame(client, 0x1, json, len);
+    client->last_frame_ms = now_ms;
+}
+
+/**
+ * @brief 接收, 处理并发送一个客户端的数据
+ */
+static void push_poll_client(const int index, const int64_t now_ms) {
+    push_client_t* client = &push_clients[index];
+
+    if (client->phase != PUSH_CLIENT_CLOSING) {
+        const ssize_t n = recv(client->sock, client->rx + client->rx_len, PUSH_RX_MAX - client->rx_len, MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            push_close(index);
+            return;
+        }
+        if (n > 0) { client->rx_len += n; }
+
+        const bool ok = client->phase == PUSH_CLIENT_HANDSHAKE
+                            ? push_handshake(index) || client->rx_len < PUSH_RX_MAX
+                            : push_process_frames(client);
+        if (!ok) {
+            push_close(index);
+            return;
+        }
+    }
+
+    push_compose(index, now_ms);
+    if (!push_flush(index, now_ms) || (client->phase == PUSH_CLIENT_CLOSING && client->tx_len == 0)) {
+        push_close(index);
+    }
+}
+
+/**
+ * @brief 接受所有等待中的连接, 没有空闲槽位时立即关闭
+ */
+static void push_accept(const int listen_sock) {
+    int sock;
+    while ((sock = accept(listen_sock, NULL, NULL)) >= 0) {
+        int index = 0;
+        while (index < CONFIG_APP_PUSH_MAX_CLIENTS && push_clients[index].phase != PUSH_CLIENT_FREE) { index++; }
+        if (index == CONFIG_APP_PUSH_MAX_CLIENTS) {
+            ESP_LOGW(TAG, "Too many clients, rejecting");
+            close(sock);
+            continue;
+        }
+
+        const int nodelay = 1; // 状态帧很小, 不等待合并到更大的报文
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+        push_clients[index] = (push_client_t){
+            .sock = sock,
+            .phase = PUSH_CLIENT_HANDSHAKE,
+            .last_frame_ms = push_now_ms() - CONFIG_APP_PUSH_MIN_INTERVAL_MS,
+        };
+        ESP_LOGI(TAG, "Client %d connected", index);
+    }
+}
+
+/**
+ * @brief 创建非阻塞的监听套接字
+ *
+ * 非阻塞使任务可以定时轮询, 仿真板上阻塞的系统调用会挂起整个调度器
+ */
+static int push_open_socket(void) {
+    const int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) { return -1; }
+
+    const int reuse = 1;
+    const struct sockaddr_in bind_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_APP_PUSH_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+        bind(sock, (const struct sockaddr*)&bind_addr, sizeof(bind_addr)) < 0 || listen(sock, 2) < 0 ||
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) < 0) {
+        ESP_LOGW(TAG, "Listen on port %d failed: errno %d", CONFIG_APP_PUSH_PORT, errno);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/**
+ * @brief 距离下一次需要处理的时刻 (ms): 有客户端因最小间隔推迟发送时为其到期时刻, 否则为轮询间隔
+ */
+static uint32_t push_next_wait_ms(const int64_t now_ms) {
+    uint32_t wait_ms = PUSH_POLL_MS;
+
+    xSemaphoreTake(push_lock, portMAX_DELAY);
+    for (int i = 0; i < CONFIG_APP_PUSH_MAX_CLIENTS; i++) {
+        if (!push.dirty[i] || push_clients[i].tx_len > 0) { continue; }
+        const int64_t due_ms = push_clients[i].last_frame_ms + CONFIG_APP_PUSH_MIN_INTERVAL_MS - now_ms;
+        if (due_ms < wait_ms) { wait_ms = due_ms > 0 ? (uint32_t)due_ms : 0; }
+    }
+    xSemaphoreGive(push_lock);
+
+    return wait_ms;
+}
+
+/**
+ * @brief [任务]状态推送
+ *
+ * 发布者更新状态后立即唤醒, 否则按 PUSH_POLL_MS 轮询新连接与发送缓冲区
+ */
+_Noreturn static void push_task(__attribute__((unused)) void* pvParameters) {
+    int listen_sock = -1;
+
+    while (1) {
+        if (listen_sock < 0) {
+            listen_sock = push_open_socket();
+            xSemaphoreTake(push_lock, portMAX_DELAY);
+            push.status.listening = listen_sock >= 0;
+            xSemaphoreGive(push_lock);
+            if (listen_sock < 0) {
+                vTaskDelay(BSP_MS_TO_TICKS(PUSH_RETRY_MS));
+                continue;
+            }
+            ESP_LOGI(TAG, "Listening on port %d", CONFIG_APP_PUSH_PORT);
+        }
+
+        push_accept(listen_sock);
+
+        const int64_t now_ms = push_now_ms();
+        for (int i = 0; i < CONFIG_APP_PUSH_MAX_CLIENTS; i++) {
+            if (push_clients[i].phase != PUSH_CLIENT_FREE) { push_poll_client(i, now_ms); }
+        }
+
+        /* 不足一个节拍的等待按一个节拍计, 避免在到期前空转 */
+        const uint32_t wait_ms = push_next_wait_ms(now_ms);
+        const TickType_t wait_ticks = BSP_MS_TO_TICKS(wait_ms);
+        if (wait_ms > 0) { ulTaskNotifyTake(pdTRUE, wait_ticks > 0 ? wait_ticks : 1); }
+    }
+}
+
+APP_TASK_STORAGE(push_task, 4096);
+APP_MUTEX_STORAGE(push_lock);
+
+void app_push_init(void) {
+    push_lock = APP_MUTEX_CREATE(push_lock);
+    for (int i = 0; i < CONFIG_APP_PUSH_MAX_CLIENTS; i++) { push_clients[i].sock = -1; }
+
+    APP_TASK_CREATE(
+        // 创建状态推送任务, 优先级低于应用任务
+        push_task, push_task, "StatePush", NULL, 5, &push_task_handle
+    );
+}
+
+void app_push_update(const app_push_state_t* state) {
+    if (push_lock == NULL) { return; }
+
+    xSemaphoreTake(push_lock, portMAX_DELAY);
+    const uint32_t changed =
+        (state->setpoint != push.state.setpoint ? PUSH_FIELD_SETPOINT : 0) |
+        (push_temp_decicelsius(state->temperature) != push_temp_decicelsius(push.state.temperature)
+             ? PUSH_FIELD_TEMP
+             : 0) |
+        (state->mode != push.state.mode ? PUSH_FIELD_MODE : 0) |
+        (state->remaining_min != push.state.remaining_min ? PUSH_FIELD_REMAINING : 0);
+    push.state = *state;
+    if (changed) {
+        push.status.updates++;
+        for (int i = 0; i < CONFIG_APP_PUSH_MAX_CLIENTS; i++) {
+            if (!push.open[i]) { continue; }
+            if (push.dirty[i]) { push.status.merged++; } // 与尚未发送的更新合并为一帧
+            push.dirty[i] |= changed;
+        }
+    }
+    xSemaphoreGive(push_lock);
+
+    if (changed && push_task_handle != NULL) { xTaskNotifyGive(push_task_handle); }
+}
+
+void app_push_get_status(app_push_status_t* status) {
+    xSemaphoreTake(push_lock, portMAX_DELAY);
+    *status = push.status;
+    xSemaphoreGive(push_lock);
+}
@@ -0,0 +1,146 @@
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "app_safety.h"
+#include "app_memory.h"
+#include "app_tasks.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_safety";
+
+#define SAFETY_RAW_SHORT_MAX   40                                                         // ADC原始值不高于该值判定为短路
+#define SAFETY_RAW_OPEN_MIN    (BSP_NTC_ADC_RAW_MAX - 40)                                 // ADC原始值不低于该值判定为开路
+#define SAFETY_RISE_WINDOW_LEN (CONFIG_APP_SAFETY_RISE_WINDOW_S * 1000 / CONFIG_APP_SAFETY_PERIOD_MS)
+#define SAFETY_HEATING_WATCH_LEN (CONFIG_APP_SAFETY_HEATING_WATCH_S * 1000 / CONFIG_APP_SAFETY_PERIOD_MS)
+
+static volatile app_safety_fault_t safety_fault = APP_SAFETY_FAULT_NONE; // 锁存的故障码
+
+/* 每个加热通道的监控状态 */
+typedef struct {
+    int read_failures;                          // 连续读取失败次数
+    int32_t rise_window[SAFETY_RISE_WINDOW_LEN]; // 升温速率检测窗口 (m°C)
+    int rise_index;                             // 窗口中最早采样的位置
+    bool rise_window_full;                      // 窗口是否已填满
+    int heating_samples;                        // 加热器持续开启的采样数
+    int32_t heating_start_temp;                 // 本次加热观察窗口起始温度 (m°C)
+} safety_channel_t;
+
+/* 安全监控状态变量, 只在监控任务中访问 */
+static struct {
+    safety_channel_t channels[BSP_HEATING_CHANNEL_NUM];
+    int64_t max_cycle_us; // 单次检查 (全部通道) 的最长耗时
+} safety_state = {0};
+
+/**
+ * @brief 对一个加热通道执行一次全部安全检查
+ *
+ * @param ch 通道号
+ * @return 检测到的故障, 无故障时返回 APP_SAFETY_FAULT_NONE
+ */
+static app_safety_fault_t safety_check(const int ch) {
+    safety_channel_t* state = &safety_state.channels[ch];
+    int raw;
+    int32_t temp;
+
+    /* 1. 读取失败 */
+    if (bsp_heating_channel_read_ntc_raw(ch, &raw) != ESP_OK || bsp_heating_channel_read_temp(ch, &temp) != ESP_OK) {
+        state->read_failures++;
+        return state->read_failures >= CONFIG_APP_SAFETY_READ_RETRIES
+                   ? APP_SAFETY_FAULT_SENSOR_READ
+                   : APP_SAFETY_FAULT_NONE;
+    }
+    state->read_failures = 0;
+
+    /* 2. 开路/短路: NTC接地, 短路时分压点接近0V, 开路时接近满量程 */
+    if (raw <= SAFETY_RAW_SHORT_MAX) { return APP_SAFETY_FAULT_SENSOR_SHORT; }
+    if (raw >= SAFETY_RAW_OPEN_MIN) { return APP_SAFETY_FAULT_SENSOR_OPEN; }
+
+    /* 3. 温度合理性 */
+    if (temp < CONFIG_APP_SAFETY_MIN_TEMP * 1000 || temp > CONFIG_APP_SAFETY_MAX_TEMP * 1000) {
+        return APP_SAFETY_FAULT_IMPLAUSIBLE;
+    }
+
+    /* 4. 升温速率: 与窗口内最早的采样比较 */
+    const int32_t oldest = state->rise_window[state->rise_index];
+    state->rise_window[state->rise_index] = temp;
+    state->rise_index = (state->rise_index + 1) % SAFETY_RISE_WINDOW_LEN;
+    if (state->rise_window_full && temp - oldest > CONFIG_APP_SAFETY_MAX_RISE_C * 1000) {
+        return APP_SAFETY_FAULT_RATE_OF_RISE;
+    }
+    if (state->rise_index == 0) { state->rise_window_full = true; }
+
+    /* 5. 加热有效性: 加热器持续开启一个观察窗口后温度必须上升 */
+    if (!bsp_heating_channel_is_enabled(ch)) {
+        state->heating_samples = 0;
+        return APP_SAFETY_FAULT_NONE;
+    }
+    if (state->heating_samples++ == 0) { state->heating_start_temp = temp; }
+    if (state->heating_samples >= SAFETY_HEATING_WATCH_LEN) {
+        if (temp - state->heating_start_temp < CONFIG_APP_SAFETY_HEATING_MIN_RISE_C * 1000) {
+            return APP_SAFETY_FAULT_NO_RISE;
+        }
+        state->heating_samples = 0; // 开始新的观察窗口
+    }
+
+    return APP_SAFETY_FAULT_NONE;
+}
+
+/**
+ * @brief [RT任务]安全监控
+ *
+ * 以最高优先级周期检查所有通道的NTC, 任一通道发现故障时立即锁定全部加热器并锁存故障码.
+ * 故障锁存后每个周期仍会重复锁定, 防止任何路径重新打开加热器.
+ */
+_Noreturn static void safety_monitor_task(__attribute__((unused)) void* pvParameters) {
+    TickType_t last_wake_time = xTaskGetTickCount();
+
+    while (1) {
+        xTaskDelayUntil(&last_wake_time, BSP_MS_TO_TICKS(CONFIG_APP_SAFETY_PERIOD_MS));
+
+        if (safety_fault != APP_SAFETY_FAULT_NONE) {
+            bsp_heating_lockout();
+            continue;
+        }
+
+        const int64_t start_us = esp_timer_get_time();
+        app_safety_fault_t fault = APP_SAFETY_FAULT_NONE;
+        int fault_channel = 0;
+        for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM && fault == APP_SAFETY_FAULT_NONE; ch++) {
+            fault = safety_check(ch);
+            fault_channel = ch;
+        }
+
+        if (fault != APP_SAFETY_FAULT_NONE) {
+            bsp_heating_lockout();
+            safety_fault = fault;
+            app_tasks_wake_heating(); // 立即显示故障
+
+            const int64_t cutoff_us = esp_timer_get_time() - start_us;
+            ESP_LOGE(TAG, "Fault E%d on channel %d: heaters locked out %" PRId64 " us after sampling "
+                          "(period %d ms, worst check %" PRId64 " us)",
+                     fault, fault_channel, cutoff_us, CONFIG_APP_SAFETY_PERIOD_MS, safety_state.max_cycle_us);
+            continue;
+        }
+
+        const int64_t cycle_us = esp_timer_get_time() - start_us;
+        if (cycle_us > safety_state.max_cycle_us) { safety_state.max_cycle_us = cycle_us; }
+    }
+}
+
+APP_TASK_STORAGE(safety_monitor_task, 2048);
+
+/**
+ * @brief 启动安全监控任务
+ */
+void app_safety_init(void) {
+    APP_TASK_CREATE(
+        // 创建安全监控任务, 优先级高于所有应用任务
+        safety_monitor_task, safety_monitor_task, "SafetyMonitor", NULL, configMAX_PRIORITIES - 1, NULL
+    );
+}
+
+app_safety_fault_t app_safety_get_fault(void) { return safety_fault; }
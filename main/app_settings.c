@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <string.h>
 
 #include "esp_check.h"
@@ -17,6 +18,7 @@ static sys_param_t g_sys_param = {0};
 static const sys_param_t g_default_sys_param = {
     .magic = MAGIC_HEAD,
     .dev_adopted = false,
+    .pid_tuned = false,
 };
 
 /**
@@ -34,6 +36,8 @@ reset:
 
 /**
  * @brief 从NVS中读取系统参数
+ *
+ * @return 读取失败时返回错误, 此时使用默认参数, NVS中的参数保持不变
  */
 esp_err_t settings_read_parameter_from_nvs(void) {
     ESP_LOGI(TAG, "Loading settings");
@@ -52,9 +56,19 @@ esp_err_t settings_read_parameter_from_nvs(void) {
     /* NVS打开失败 */
     ESP_GOTO_ON_FALSE(ESP_OK == ret, ret, err, TAG, "NVS open failed (0x%x)", ret);
 
-    /* 读取系统参数 */
-    size_t len = sizeof(sys_param_t);
-    ret = nvs_get_blob(my_handle, KEY, &g_sys_param, &len);
+    /* 读取系统参数: 旧版本保存的参数较短时新增字段保持为0; 回滚后新版本保存的参数较长时只取本版本已知的前缀 */
+    size_t stored = 0;
+    ret = nvs_get_blob(my_handle, KEY, NULL, &stored);
+    ESP_GOTO_ON_FALSE(ESP_OK == ret, ret, err, TAG, "Can't read param size");
+
+    uint8_t* blob = malloc(stored);
+    ESP_GOTO_ON_FALSE(blob != NULL, ESP_ERR_NO_MEM, err, TAG, "No memory for %u B param", (unsigned)stored);
+    ret = nvs_get_blob(my_handle, KEY, blob, &stored);
+    if (ESP_OK == ret) {
+        memset(&g_sys_param, 0, sizeof(sys_param_t));
+        memcpy(&g_sys_param, blob, stored < sizeof(sys_param_t) ? stored : sizeof(sys_param_t));
+    }
+    free(blob);
     ESP_GOTO_ON_FALSE(ESP_OK == ret, ret, err, TAG, "Can't read param");
 
     nvs_close(my_handle);
@@ -63,6 +77,7 @@ esp_err_t settings_read_parameter_from_nvs(void) {
     return ret;
 err:
     if (my_handle) { nvs_close(my_handle); }
+    memcpy(&g_sys_param, &g_default_sys_param, sizeof(sys_param_t));
     return ret;
 }
 
@@ -97,3 +112,103 @@ bool settings_get_dev_adopted(void) { return g_sys_param.dev_adopted; }
  * @brief 设置 dev_adopted 位为 true
  */
 void settings_set_dev_adopted(void) { g_sys_param.dev_adopted = true; }
+
+/**
+ * @brief 获取自整定得到的PID增益
+ *
+ * @return 是否已完成自整定, 未整定时增益无效
+ */
+bool settings_get_pid_gains(float* kp, float* ki, float* kd) {
+    *kp = g_sys_param.pid_kp;
+    *ki = g_sys_param.pid_ki;
+    *kd = g_sys_param.pid_kd;
+    return g_sys_param.pid_tuned;
+}
+
+/**
+ * @brief 设置PID增益并标记为已整定
+ */
+void settings_set_pid_gains(const float kp, const float ki, const float kd) {
+    g_sys_param.pid_kp = kp;
+    g_sys_param.pid_ki = ki;
+    g_sys_param.pid_kd = kd;
+    g_sys_param.pid_tuned = true;
+}
+
+/**
+ * @brief 获取毛巾干燥检测的占空比基线, 0表示尚未学习
+ */
+float settings_get_dry_baseline(void) { return g_sys_param.dry_baseline; }
+
+/**
+ * @brief 设置毛巾干燥检测的占空比基线
+ */
+void settings_set_dry_baseline(const float baseline) { g_sys_param.dry_baseline = baseline; }
+
+/**
+ * @brief 获取累计耗电量 (mJ)
+ */
+uint64_t settings_get_energy_lifetime_mj(void) { return g_sys_param.energy_lifetime_mj; }
+
+/**
+ * @brief 设置累计耗电量 (mJ)
+ */
+void settings_set_energy_lifetime_mj(const uint64_t energy_mj) { g_sys_param.energy_lifetime_mj = energy_mj; }
+
+/**
+ * @brief 获取NTC两点校准系数
+ *
+ * @return 是否已校准, 未校准时系数无效
+ */
+bool settings_get_ntc_calibration(int32_t* gain_q16, int32_t* offset_mC) {
+    *gain_q16 = g_sys_param.ntc_cal_gain;
+    *offset_mC = g_sys_param.ntc_cal_offset;
+    return g_sys_param.ntc_cal_gain != 0;
+}
+
+/**
+ * @brief 设置NTC两点校准系数, 增益为0表示清除校准
+ */
+void settings_set_ntc_calibration(const int32_t gain_q16, const int32_t offset_mC) {
+    g_sys_param.ntc_cal_gain = gain_q16;
+    g_sys_param.ntc_cal_offset = offset_mC;
+}
+
+/**
+ * @brief 获取电价规划的舒适时段
+ *
+ * @return 是否设置过, 未设置时使用配置项中的默认时段
+ */
+bool settings_get_tariff_comfort(int* start_min, int* end_min) {
+    *start_min = g_sys_param.comfort_start_min;
+    *end_min = g_sys_param.comfort_end_min;
+    return g_sys_param.comfort_set;
+}
+
+/**
+ * @brief 设置电价规划的舒适时段
+ */
+void settings_set_tariff_comfort(const int start_min, const int end_min) {
+    g_sys_param.comfort_start_min = (int16_t)start_min;
+    g_sys_param.comfort_end_min = (int16_t)end_min;
+    g_sys_param.comfort_set = true;
+}
+
+/**
+ * @brief 获取最近保存的UTC时间与时钟频率偏差估计
+ *
+ * @return 是否保存过时间
+ */
+bool settings_get_time(int64_t* utc_s, int32_t* drift_ppb) {
+    *utc_s = g_sys_param.time_saved_utc_s;
+    *drift_ppb = g_sys_param.time_drift_ppb;
+    return g_sys_param.time_saved_utc_s != 0;
+}
+
+/**
+ * @brief 设置保存的UTC时间与时钟频率偏差估计
+ */
+void settings_set_time(const int64_t utc_s, const int32_t drift_ppb) {
+    g_sys_param.time_saved_utc_s = utc_s;
+    g_sys_param.time_drift_ppb = drift_ppb;
+}
@@ -0,0 +1,401 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#endif
+
+#include "app_memory.h"
+#include "app_settings.h"
+#include "app_tariff.h"
+#include "app_tasks.h"
+#if CONFIG_APP_TIME_ENABLE
+#include "app_time.h"
+#endif
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_tariff";
+
+#define TARIFF_TICK_MS         (10 * 1000) // 计费与规划检查周期
+#define TARIFF_RETRY_MS        (60 * 1000) // 下载失败后的重试间隔
+#define TARIFF_REFRESH_MS      (CONFIG_APP_TARIFF_REFRESH_MIN * 60 * 1000LL)
+#define TARIFF_SECONDS_PER_DAY 86400
+#define TARIFF_UCOST_DIVISOR   3600000000ULL // us × W × (0.001/kWh) -> 0.000001货币单位
+#define TARIFF_POWER_W         (BSP_HEATING_CHANNEL_NUM * BSP_BOARD_HEATER_RATED_W)
+
+static SemaphoreHandle_t tariff_lock = NULL;
+static TaskHandle_t tariff_task_handle = NULL;
+static volatile bool tariff_refresh_requested = false; // 命令行请求立即下载
+
+/* 规划状态, 由 tariff_lock 保护 */
+static struct {
+    app_tariff_schedule_t schedule;
+    bool clock_valid;
+    int64_t clock_base_s;  // 最近一次下载时电价表给出的本地时间
+    int64_t clock_base_ms; // 此时的系统时间
+    int64_t utc_offset_s;  // 电价表的本地时间相对UTC的偏移
+    int comfort_start_min;
+    int comfort_end_min;
+    bool replan;           // 输入变化, 需要重新规划
+    app_tariff_plan_t plan;
+    int plan_slot;         // 规划时所在的时段
+    int plan_target;       // 规划时的目标温度
+    int plan_band;         // 规划时的开关回差, 自整定完成后改用PID时重新规划
+    int64_t cycle_start_s; // 当前舒适时段的开始时刻, 无规划时为0
+    uint64_t cycle_expected_ucost;
+    uint64_t cycle_baseline_ucost;
+    uint64_t cycle_actual_ucost;
+    uint64_t last_on_time_us; // 上一次计费时的加热器累计开启时间
+    uint64_t residual;        // 不足1个计费单位的余数
+} tariff = {0};
+
+static int64_t tariff_uptime_ms(void) { return (int64_t)BSP_TICKS_TO_MS(xTaskGetTickCount()); }
+
+/**
+ * @brief 当前本地时间, 调用者需持有 tariff_lock
+ */
+static int64_t tariff_now_locked(void) {
+    if (!tariff.clock_valid) { return 0; }
+#if CONFIG_APP_TIME_ENABLE
+    /* 时间服务的时钟可信时以其为准, 电价表给出的时间只在下载时刻准确 */
+    int64_t utc_us;
+    if (app_time_get_utc(&utc_us)) { return utc_us / 1000000 + tariff.utc_offset_s; }
+#endif
+    return tariff.clock_base_s + (tariff_uptime_ms() - tariff.clock_base_ms) / 1000;
+}
+
+/**
+ * @brief 计算包含当前时刻或之后最近的舒适时段, 全天模式按自然日划分
+ */
+static void tariff_comfort_period(const int64_t now_s, int64_t* start_s, int64_t* end_s) {
+    const int64_t day_s = now_s - now_s % TARIFF_SECONDS_PER_DAY;
+
+    if (tariff.comfort_start_min == tariff.comfort_end_min) {
+        *start_s = day_s;
+        *end_s = day_s + TARIFF_SECONDS_PER_DAY;
+        return;
+    }
+
+    const int64_t length_s = (int64_t)((tariff.comfort_end_min - tariff.comfort_start_min + 1440) % 1440) * 60;
+    int64_t start = day_s + tariff.comfort_start_min * 60;
+    if (start > now_s) { start -= TARIFF_SECONDS_PER_DAY; } // 最近一次开始的时段, 可能跨越午夜
+    if (now_s >= start + length_s) { start += TARIFF_SECONDS_PER_DAY; }
+
+    *start_s = start;
+    *end_s = start + length_s;
+}
+
+/**
+ * @brief 结束当前舒适时段的计费并输出结构化日志, 调用者需持有 tariff_lock
+ */
+static void tariff_close_cycle_locked(const bool completed) {
+    if (tariff.cycle_start_s == 0) { return; }
+
+    if (completed) {
+        ESP_LOGI(TAG, "TARIFF,%" PRId64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, tariff.cycle_start_s,
+                 tariff.cycle_expected_ucost / 1000, tariff.cycle_baseline_ucost / 1000,
+                 tariff.cycle_actual_ucost / 1000);
+    }
+    tariff.cycle_start_s = 0;
+    tariff.cycle_expected_ucost = 0;
+    tariff.cycle_baseline_ucost = 0;
+    tariff.cycle_actual_ucost = 0;
+}
+
+/**
+ * @brief 按上次计费以来的加热器开启时间与当前电价累计实际电费, 调用者需持有 tariff_lock
+ */
+static void tariff_account_locked(const int64_t now_s) {
+    const uint64_t on_time_us = bsp_heating_get_on_time_us();
+    const uint64_t delta_us = on_time_us - tariff.last_on_time_us;
+    tariff.last_on_time_us = on_time_us;
+
+    const int slot = app_tariff_slot_at(&tariff.schedule, now_s);
+    if (tariff.cycle_start_s == 0 || slot < 0) { return; }
+
+    /* 加热器开启时间已按通道累加, 乘单个加热器的功率 */
+    const uint64_t units = delta_us * BSP_BOARD_HEATER_RATED_W * tariff.schedule.price[slot] + tariff.residual;
+    tariff.cycle_actual_ucost += units / TARIFF_UCOST_DIVISOR;
+    tariff.residual = units % TARIFF_UCOST_DIVISOR;
+}
+
+/**
+ * @brief 需要时重新规划, 调用者需持有 tariff_lock
+ *
+ * @param rack_temp 通道0的毛巾架温度 (m°C)
+ * @param target 通道0的目标温度, 关机时为0
+ * @param band 通道0的开关回差 (°C)
+ */
+static void tariff_update_plan_locked(const int64_t now_s, const int32_t rack_temp, const int target,
+                                      const int band) {
+    const int slot = app_tariff_slot_at(&tariff.schedule, now_s);
+
+    if (!tariff.clock_valid || target == 0 || slot < 0) {
+        if (tariff.plan.valid) { ESP_LOGI(TAG, "Planner inactive"); }
+        tariff.plan.valid = false;
+        tariff_close_cycle_locked(false);
+        return;
+    }
+
+    int64_t comfort_start_s, comfort_end_s;
+    tariff_comfort_period(now_s, &comfort_start_s, &comfort_end_s);
+
+    /* 舒适时段结束, 结算后为下一个时段规划 */
+    if (tariff.cycle_start_s != 0 && comfort_start_s != tariff.cycle_start_s) {
+        tariff_close_cycle_locked(true);
+        tariff.replan = true;
+    }
+
+    if (tariff.plan.valid && !tariff.replan && slot == tariff.plan_slot && target == tariff.plan_target &&
+        band == tariff.plan_band) {
+        return;
+    }
+
+    const app_tariff_plan_input_t input = {
+        .now_s = now_s,
+        .comfort_start_s = comfort_start_s,
+        .comfort_end_s = comfort_end_s,
+        .rack_temp = rack_temp,
+        .target = target,
+        .power_w = TARIFF_POWER_W,
+        .band = band,
+    };
+    app_tariff_plan(&tariff.schedule, &input, &tariff.plan);
+    tariff.plan_slot = slot;
+    tariff.plan_target = target;
+    tariff.plan_band = band;
+    tariff.replan = false;
+
+    /* 舒适时段的预期电费 = 已产生的电费 + 本次规划的剩余部分 */
+    if (tariff.cycle_start_s == 0) {
+        tariff.cycle_start_s = comfort_start_s;
+        tariff.cycle_baseline_ucost = tariff.plan.baseline_ucost;
+    }
+    tariff.cycle_expected_ucost = tariff.cycle_actual_ucost + tariff.plan.expected_ucost;
+
+    const int64_t lead_s = comfort_start_s - tariff.plan.preheat_s;
+    ESP_LOGI(TAG, "Plan: preheat %" PRId64 " min ahead, comfort floor %d C, expected cost %" PRIu64
+                  " (baseline %" PRIu64 ")%s",
+             lead_s > 0 ? lead_s / 60 : 0, target - CONFIG_APP_TARIFF_COAST_C, tariff.plan.expected_ucost / 1000,
+             tariff.plan.baseline_ucost / 1000, tariff.plan.feasible ? "" : ", comfort not reachable");
+}
+
+esp_err_t app_tariff_load_json(const char* json, const size_t len) {
+    esp_err_t ret = ESP_OK;
+    cJSON* root = cJSON_ParseWithLength(json, len);
+    ESP_RETURN_ON_FALSE(root != NULL, ESP_ERR_INVALID_ARG, TAG, "Tariff feed is not valid JSON");
+
+    const cJSON* now = cJSON_GetObjectItem(root, "now");
+    const cJSON* start = cJSON_GetObjectItem(root, "start");
+    const cJSON* slot_s = cJSON_GetObjectItem(root, "slot_s");
+    const cJSON* prices = cJSON_GetObjectItem(root, "prices");
+    const cJSON* utc_offset = cJSON_GetObjectItem(root, "utc_offset_s");
+    ESP_GOTO_ON_FALSE(cJSON_IsNumber(now) && cJSON_IsNumber(start) && cJSON_IsNumber(slot_s) &&
+                          cJSON_IsArray(prices) && (utc_offset == NULL || cJSON_IsNumber(utc_offset)),
+                      ESP_ERR_INVALID_ARG, cleanup, TAG, "Tariff feed missing now/start/slot_s/prices");
+    ESP_GOTO_ON_FALSE(slot_s->valuedouble >= 60, ESP_ERR_INVALID_ARG, cleanup, TAG, "Tariff slot too short");
+
+    const int count = cJSON_GetArraySize(prices);
+    ESP_GOTO_ON_FALSE(count > 0 && count <= CONFIG_APP_TARIFF_MAX_SLOTS, ESP_ERR_INVALID_SIZE, cleanup, TAG,
+                      "Tariff has %d slots, at most %d supported", count, CONFIG_APP_TARIFF_MAX_SLOTS);
+
+    app_tariff_schedule_t schedule = {.slot_s = (uint32_t)slot_s->valuedouble, .count = count};
+    const int64_t offset_s = utc_offset != NULL ? (int64_t)utc_offset->valuedouble : 0;
+    schedule.start_s = (int64_t)start->valuedouble + offset_s;
+    for (int i = 0; i < count; i++) {
+        const cJSON* price = cJSON_GetArrayItem(prices, i);
+        ESP_GOTO_ON_FALSE(cJSON_IsNumber(price) && price->valuedouble >= 0, ESP_ERR_INVALID_ARG, cleanup, TAG,
+                          "Tariff price %d invalid", i);
+        schedule.price[i] = (uint32_t)price->valuedouble;
+    }
+
+    xSemaphoreTake(tariff_lock, portMAX_DELAY);
+    tariff.schedule = schedule;
+    tariff.clock_valid = true;
+    tariff.clock_base_s = (int64_t)now->valuedouble + offset_s;
+    tariff.clock_base_ms = tariff_uptime_ms();
+    tariff.utc_offset_s = offset_s;
+    tariff.replan = true;
+    xSemaphoreGive(tariff_lock);
+
+    ESP_LOGI(TAG, "Tariff loaded: %d slots of %" PRIu32 " s", count, schedule.slot_s);
+
+cleanup:
+    cJSON_Delete(root);
+    return ret;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief 从文件载入电价表, 环境变量 TRC_SIM_TARIFF 优先于配置项
+ *
+ * 文件中的 now 对应模拟开始的时刻, 因此只在启动时载入一次.
+ */
+static esp_err_t tariff_fetch(void) {
+    const char* path = getenv("TRC_SIM_TARIFF");
+    if (path == NULL) { path = CONFIG_SIM_TARIFF_FILE; }
+    ESP_RETURN_ON_FALSE(strlen(path) > 0, ESP_ERR_NOT_FOUND, TAG, "No tariff file configured");
+
+    FILE* file = fopen(path, "r");
+    ESP_RETURN_ON_FALSE(file != NULL, ESP_ERR_NOT_FOUND, TAG, "Can't open tariff file %s", path);
+
+    static char buf[CONFIG_APP_TARIFF_MAX_BYTES];
+    const size_t len = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+    return app_tariff_load_json(buf, len);
+}
+#else
+/**
+ * @brief 通过HTTP下载电价表
+ */
+static esp_err_t tariff_fetch(void) {
+    esp_err_t ret = ESP_OK;
+    char* buf = malloc(CONFIG_APP_TARIFF_MAX_BYTES);
+    ESP_RETURN_ON_FALSE(buf != NULL, ESP_ERR_NO_MEM, TAG, "No memory for tariff feed");
+
+    const esp_http_client_config_t http_config = {
+        .url = CONFIG_APP_TARIFF_URL,
+        .timeout_ms = CONFIG_APP_TARIFF_HTTP_TIMEOUT_MS,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&http_config);
+    ESP_GOTO_ON_FALSE(client != NULL, ESP_ERR_NO_MEM, free_buf, TAG, "HTTP client init failed");
+
+    ESP_GOTO_ON_ERROR(esp_http_client_open(client, 0), cleanup, TAG, "Connection to %s failed", CONFIG_APP_TARIFF_URL);
+    esp_http_client_fetch_headers(client);
+    const int status = esp_http_client_get_status_code(client);
+    ESP_GOTO_ON_FALSE(status == 200, ESP_ERR_INVALID_RESPONSE, cleanup, TAG, "HTTP status %d", status);
+
+    size_t len = 0;
+    int n;
+    while (len < CONFIG_APP_TARIFF_MAX_BYTES &&
+           (n = esp_http_client_read(client, buf + len, (int)(CONFIG_APP_TARIFF_MAX_BYTES - len))) > 0) {
+        len += n;
+    }
+    ESP_GOTO_ON_FALSE(len < CONFIG_APP_TARIFF_MAX_BYTES, ESP_ERR_INVALID_SIZE, cleanup, TAG, "Tariff feed too large");
+
+    ret = app_tariff_load_json(buf, len);
+
+cleanup:
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+free_buf:
+    free(buf);
+    return ret;
+}
+#endif
+
+/**
+ * @brief [后台任务]电价下载, 计费与规划
+ */
+_Noreturn static void tariff_task(__attribute__((unused)) void* pvParameters) {
+    int64_t next_fetch_ms = 0;
+
+    while (1) {
+#if !CONFIG_IDF_TARGET_LINUX
+        const int64_t uptime_ms = tariff_uptime_ms();
+        if (uptime_ms >= next_fetch_ms || tariff_refresh_requested) {
+            tariff_refresh_requested = false;
+            next_fetch_ms = uptime_ms + (tariff_fetch() == ESP_OK ? TARIFF_REFRESH_MS : TARIFF_RETRY_MS);
+        }
+#else
+        if (next_fetch_ms == 0) {
+            tariff_fetch();
+            next_fetch_ms = INT64_MAX;
+        }
+#endif
+
+        app_zone_status_t zone;
+        app_tasks_get_zone_status(0, &zone);
+
+        xSemaphoreTake(tariff_lock, portMAX_DELAY);
+        const int64_t now_s = tariff_now_locked();
+        tariff_account_locked(now_s);
+        tariff_update_plan_locked(now_s, zone.temperature, zone.target_temperature, zone.switching_band);
+        xSemaphoreGive(tariff_lock);
+
+        ulTaskNotifyTake(pdTRUE, BSP_MS_TO_TICKS(TARIFF_TICK_MS));
+    }
+}
+
+APP_TASK_STORAGE(tariff_task, 6144);
+APP_MUTEX_STORAGE(tariff_lock);
+
+void app_tariff_init(void) {
+    tariff_lock = APP_MUTEX_CREATE(tariff_lock);
+
+    if (!settings_get_tariff_comfort(&tariff.comfort_start_min, &tariff.comfort_end_min)) {
+        tariff.comfort_start_min = CONFIG_APP_TARIFF_COMFORT_START_MIN;
+        tariff.comfort_end_min = CONFIG_APP_TARIFF_COMFORT_END_MIN;
+    }
+    tariff.last_on_time_us = bsp_heating_get_on_time_us();
+
+    APP_TASK_CREATE(
+        // 创建电价规划任务, 规划需要模拟整个舒适时段, 栈较大
+        tariff_task, tariff_task, "TariffPlanner", NULL, 4, &tariff_task_handle
+    );
+}
+
+void app_tariff_refresh(void) {
+    tariff_refresh_requested = true;
+    xTaskNotifyGive(tariff_task_handle);
+}
+
+esp_err_t app_tariff_set_comfort(const int start_min, const int end_min) {
+    ESP_RETURN_ON_FALSE(start_min >= 0 && start_min < 1440 && end_min >= 0 && end_min < 1440, ESP_ERR_INVALID_ARG,
+                        TAG, "Comfort window out of range");
+
+    xSemaphoreTake(tariff_lock, portMAX_DELAY);
+    tariff.comfort_start_min = start_min;
+    tariff.comfort_end_min = end_min;
+    tariff.replan = true;
+    tariff_close_cycle_locked(false);
+    xSemaphoreGive(tariff_lock);
+
+    settings_set_tariff_comfort(start_min, end_min);
+    xTaskNotifyGive(tariff_task_handle);
+    return settings_write_parameter_to_nvs();
+}
+
+bool app_tariff_get_offset(int8_t* offset) {
+    *offset = 0;
+
+    xSemaphoreTake(tariff_lock, portMAX_DELAY);
+    const int slot = app_tariff_slot_at(&tariff.schedule, tariff_now_locked());
+    const bool active = tariff.plan.valid && slot >= 0;
+    if (active) { *offset = tariff.plan.offset[slot]; }
+    xSemaphoreGive(tariff_lock);
+
+    return active;
+}
+
+void app_tariff_get_status(app_tariff_status_t* status) {
+    xSemaphoreTake(tariff_lock, portMAX_DELAY);
+    const int64_t now_s = tariff_now_locked();
+    const int slot = app_tariff_slot_at(&tariff.schedule, now_s);
+    *status = (app_tariff_status_t){
+        .schedule_loaded = tariff.schedule.count > 0,
+        .now_s = now_s,
+        .price = slot >= 0 ? tariff.schedule.price[slot] : 0,
+        .active = tariff.plan.valid && slot >= 0,
+        .offset = tariff.plan.valid && slot >= 0 ? tariff.plan.offset[slot] : 0,
+        .comfort_start_min = tariff.comfort_start_min,
+        .comfort_end_min = tariff.comfort_end_min,
+        .preheat_s = tariff.plan.preheat_s,
+        .cycle_start_s = tariff.cycle_start_s,
+        .feasible = tariff.plan.feasible,
+        .expected_ucost = tariff.cycle_expected_ucost,
+        .baseline_ucost = tariff.cycle_baseline_ucost,
+        .actual_ucost = tariff.cycle_actual_ucost,
+    };
+    xSemaphoreGive(tariff_lock);
+}
@@ -0,0 +1,147 @@
+#include <string.h>
+
+#include "app_tariff_plan.h"
+
+#define PLAN_STEP_S           10 // 模拟步长
+#define PLAN_SECONDS_PER_HOUR 3600
+#define PLAN_TOLERANCE_MC     500 // 开关控制在设定温度附近的波动, 不计为温度缺口 (m°C)
+
+/* 模拟一个候选方案的结果 */
+typedef struct {
+    uint64_t ucost;
+    uint64_t on_s;
+    int32_t deficit; // 舒适时段内温度低于下限的最大值 (m°C), 不低于时 <= 0
+} plan_sim_t;
+
+int app_tariff_slot_at(const app_tariff_schedule_t* schedule, const int64_t time_s) {
+    if (schedule->count == 0 || time_s < schedule->start_s) { return -1; }
+    const int64_t slot = (time_s - schedule->start_s) / schedule->slot_s;
+    return slot < schedule->count ? (int)slot : -1;
+}
+
+static int64_t plan_slot_start(const app_tariff_schedule_t* schedule, const int slot) {
+    return schedule->start_s + (int64_t)slot * schedule->slot_s;
+}
+
+/**
+ * @brief 按时段偏移表模拟毛巾架温度与电费
+ *
+ * 热模型与 app_estimator 的毛巾架节点相同, 控制按设定温度与开关回差做开关近似: 达到设定温度关闭,
+ * 降到 设定温度 - 回差 以下才重新开启, 回差为0时即恒温开关.
+ */
+static void plan_simulate(const app_tariff_schedule_t* schedule, const app_tariff_plan_input_t* input,
+                          const int8_t* offset, const int64_t end_s, plan_sim_t* sim) {
+    const int32_t ambient = CONFIG_APP_ESTIMATOR_AMBIENT_TEMP * 1000;
+    const int32_t comfort_min = (input->target - CONFIG_APP_TARIFF_COAST_C) * 1000 - PLAN_TOLERANCE_MC;
+    const int32_t band = input->band * 1000;
+    int32_t temp = input->rack_temp;
+    bool on = false; // 在回差内开始时按关闭计, 温度偏低的一侧
+
+    *sim = (plan_sim_t){.deficit = INT32_MIN};
+    for (int64_t t = input->now_s; t < end_s; t += PLAN_STEP_S) {
+        const int slot = app_tariff_slot_at(schedule, t);
+        if (slot < 0) { break; }
+
+        if (t >= input->comfort_start_s && comfort_min - temp > sim->deficit) { sim->deficit = comfort_min - temp; }
+
+        const int32_t setpoint = (input->target + offset[slot]) * 1000;
+        if (offset[slot] == APP_TARIFF_OFF || temp >= setpoint) {
+            on = false;
+        } else if (temp < setpoint - band) {
+            on = true;
+        }
+        if (on) {
+            sim->ucost += (uint64_t)input->power_w * PLAN_STEP_S * schedule->price[slot] / PLAN_SECONDS_PER_HOUR;
+            sim->on_s += PLAN_STEP_S;
+        }
+
+        const int64_t heat = on ? (int64_t)CONFIG_APP_ESTIMATOR_HEAT_RATE * PLAN_STEP_S : 0;
+        const int64_t loss = (int64_t)(temp - ambient) * PLAN_STEP_S / CONFIG_APP_ESTIMATOR_LOSS_TAU_S;
+        temp += (int32_t)(heat - loss);
+    }
+}
+
+/**
+ * @brief 为规划范围内的时段分配偏移规则: 昂贵时段滑行, 昂贵时段前的便宜时段蓄热
+ *
+ * 规则针对开关回差的下沿: 设定温度再提高一个回差, 使温度回落后重新加热的位置落在规划的温度上.
+ */
+static void plan_assign_rules(const app_tariff_schedule_t* schedule, const int first, const int last,
+                              const int band, int8_t* rule) {
+    uint32_t min_price = UINT32_MAX;
+    for (int s = first; s <= last; s++) {
+        if (schedule->price[s] < min_price) { min_price = schedule->price[s]; }
+    }
+    const uint64_t threshold = (uint64_t)min_price * (100 + CONFIG_APP_TARIFF_EXPENSIVE_PCT) / 100;
+
+    for (int s = first; s <= last; s++) {
+        const bool expensive = schedule->price[s] > min_price && schedule->price[s] >= threshold;
+        const bool next_expensive =
+            s < last && schedule->price[s + 1] > min_price && schedule->price[s + 1] >= threshold;
+        rule[s] = band + (expensive ? -CONFIG_APP_TARIFF_COAST_C : next_expensive ? CONFIG_APP_TARIFF_BOOST_C : 0);
+    }
+}
+
+void app_tariff_plan(const app_tariff_schedule_t* schedule, const app_tariff_plan_input_t* input,
+                     app_tariff_plan_t* plan) {
+    memset(plan, 0, sizeof(*plan));
+    memset(plan->offset, APP_TARIFF_OFF, sizeof(plan->offset));
+
+    const int first = app_tariff_slot_at(schedule, input->now_s);
+    if (first < 0) { return; }
+
+    /* 规划到舒适时段结束, 电价表不够长时到电价表结束 */
+    const int64_t schedule_end_s = plan_slot_start(schedule, schedule->count);
+    const int64_t end_s = input->comfort_end_s < schedule_end_s ? input->comfort_end_s : schedule_end_s;
+    const int last = app_tariff_slot_at(schedule, end_s - 1);
+    if (last < first) { return; }
+
+    int8_t rule[CONFIG_APP_TARIFF_MAX_SLOTS];
+    plan_assign_rules(schedule, first, last, input->band, rule);
+
+    /* 基准: 不做规划, 一直维持目标温度 */
+    int8_t offset[CONFIG_APP_TARIFF_MAX_SLOTS];
+    plan_sim_t sim;
+    memset(offset, 0, sizeof(offset));
+    plan_simulate(schedule, input, offset, end_s, &sim);
+    plan->baseline_ucost = sim.ucost;
+
+    /* 电价表还不覆盖舒适时段, 先不加热, 等待新的电价表 */
+    plan->valid = true;
+    plan->end_s = end_s;
+    if (input->comfort_start_s >= end_s) {
+        plan->preheat_s = input->comfort_start_s;
+        plan->feasible = true;
+        return;
+    }
+
+    /* 候选预热起点: 舒适时段开始前 PREHEAT_MAX_H 内的各时段起点, 以及当前时刻 */
+    const int64_t earliest_s = input->comfort_start_s - CONFIG_APP_TARIFF_PREHEAT_MAX_H * PLAN_SECONDS_PER_HOUR;
+    bool have_best = false;
+    plan_sim_t best = {0};
+
+    for (int p = first; p <= last; p++) {
+        const int64_t preheat_s = p == first ? input->now_s : plan_slot_start(schedule, p);
+        if (preheat_s > input->comfort_start_s && p != first) { break; }
+        if (p != first && plan_slot_start(schedule, p + 1) <= earliest_s) { continue; }
+
+        memset(offset, APP_TARIFF_OFF, sizeof(offset));
+        for (int s = p; s <= last; s++) { offset[s] = rule[s]; }
+        plan_simulate(schedule, input, offset, end_s, &sim);
+
+        /* 满足舒适要求的方案中取电费最低者, 都不满足时取温度缺口最小者 */
+        const bool feasible = sim.deficit <= 0;
+        const bool better = !have_best ||
+                            (feasible ? best.deficit > 0 || sim.ucost < best.ucost : sim.deficit < best.deficit);
+        if (better) {
+            have_best = true;
+            best = sim;
+            plan->preheat_s = preheat_s;
+            memcpy(plan->offset, offset, sizeof(plan->offset));
+        }
+    }
+
+    plan->feasible = best.deficit <= 0;
+    plan->expected_ucost = best.ucost;
+    plan->expected_wh = (uint32_t)(best.on_s * input->power_w / PLAN_SECONDS_PER_HOUR);
+}
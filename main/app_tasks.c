@@ -1,15 +1,40 @@
+#include <inttypes.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 
+#include "app_autotune.h"
+#include "app_coord.h"
+#if CONFIG_APP_DRYDETECT_ENABLE
+#include "app_drydetect.h"
+#endif
+#include "app_energy.h"
+#include "app_estimator.h"
+#include "app_memory.h"
+#include "app_ntc_cal.h"
+#include "app_pid.h"
+#if CONFIG_APP_PUSH_ENABLE
+#include "app_push.h"
+#endif
+#include "app_safety.h"
+#include "app_settings.h"
+#if CONFIG_APP_TARIFF_ENABLE
+#include "app_tariff.h"
+#endif
 #include "app_tasks.h"
+#include "app_zone_sched.h"
 #include "bsp/towelrack_controller_a1.h"
 
 __unused static const char* TAG = "app_tasks";
 
 static const int fe_task_hold_time = 2 * 1000;    // 前台任务保持时间
+static const int ntc_cal_hold_time = 10 * 60 * 1000; // NTC校准保持时间, 需等待传感器达到热平衡
+static const int heating_period_ms = 1000;        // 加热控制最短周期, 温度稳定时逐次加倍
+static const int pid_window_ms = CONFIG_APP_PID_WINDOW_S * 1000; // PID时间比例输出窗口
+static const int heating_hysteresis_c = 5;        // 回差控制的回差, 低于 目标温度 - 回差 时重新加热
 static const int target_temperature_default = 50; // 默认开机目标温度
 static const int target_time_hours_default = 3;   // 默认开机目标时间
 static const int target_temperature_min = 40;     // 目标温度范围_下限
@@ -19,11 +44,15 @@ static const int target_time_hours_max = 24;      // 目标时间范围_上限
 
 static QueueHandle_t bsp_input_queue = NULL;              // 输入事件队列
 static TaskHandle_t app_fe_status_watchdog_handle = NULL; // 前台状态看门狗任务句柄
+static TaskHandle_t heating_task_handle = NULL;           // 加热控制任务句柄
 
 typedef enum {
     APP_FE_STATUS_IDLE,
     APP_FE_STATUS_TEMP_INTERACT,
     APP_FE_STATUS_TIMER_INTERACT,
+    APP_FE_STATUS_ENERGY,
+    APP_FE_STATUS_NTC_CAL,
+    APP_FE_STATUS_MAX,
 } app_frontend_status_t;
 
 /* 系统状态变量 */
@@ -34,6 +63,11 @@ static struct {
     int target_temperature;               // 目标温度
     int target_time_hours;                // 目标时间
     bool target_time_dirty;               // 目标时间是否被修改过
+    int remaining_min;                    // 定时关机剩余时间 (min), 未定时为0
+    int ntc_cal_point;                    // NTC校准当前采集的校准点
+    int ntc_cal_reference;                // NTC校准当前输入的参考温度
+    int zone_target_temperature[BSP_HEATING_CHANNEL_NUM]; // 各加热通道目标温度, 界面设置的目标温度作用于所有通道
+    int32_t zone_temperature[BSP_HEATING_CHANNEL_NUM];    // 各加热通道参与控制的温度 (m°C)
 } app_context = {
     .be_status_on = false,
     .fe_status = APP_FE_STATUS_IDLE,
@@ -43,15 +77,51 @@ static struct {
     .target_time_dirty = true,
 };
 
+/**
+ * @brief 向状态推送发布当前状态, 在 app_context 的各更新点调用, 只有变化的字段会推送给客户端
+ */
+void app_tasks_publish_state(void) {
+#if CONFIG_APP_PUSH_ENABLE
+    app_push_mode_t mode = APP_PUSH_MODE_OFF;
+    if (app_safety_get_fault() != APP_SAFETY_FAULT_NONE) {
+        mode = APP_PUSH_MODE_FAULT;
+    } else if (app_context.be_status_on) {
+        mode = app_autotune_get_state() == APP_AUTOTUNE_RUNNING ? APP_PUSH_MODE_AUTOTUNE : APP_PUSH_MODE_ON;
+    }
+
+    const app_push_state_t state = {
+        .setpoint = app_context.target_temperature,
+        .temperature = app_context.zone_temperature[0],
+        .mode = mode,
+        .remaining_min = app_context.remaining_min,
+    };
+    app_push_update(&state);
+#endif
+}
+
 /**
  * @brief 根据系统状态刷新显示内容
  */
 static void app_refresh_display(void) {
+    /* 安全故障优先显示故障码 */
+    const app_safety_fault_t fault = app_safety_get_fault();
+    if (fault != APP_SAFETY_FAULT_NONE) {
+        char str[3];
+        snprintf(str, sizeof(str), "E%d", fault);
+        bsp_display_set_c_flag(false);
+        bsp_display_set_h_flag(false);
+        bsp_display_write_str(str);
+        return;
+    }
+
     bsp_display_set_c_flag(
-        app_context.fe_status == APP_FE_STATUS_TEMP_INTERACT ||
+        app_context.fe_status == APP_FE_STATUS_TEMP_INTERACT || app_context.fe_status == APP_FE_STATUS_NTC_CAL ||
         (app_context.be_status_on == true && app_context.fe_status == APP_FE_STATUS_IDLE)
     );
-    bsp_display_set_h_flag(app_context.fe_status == APP_FE_STATUS_TIMER_INTERACT);
+    bsp_display_set_h_flag(
+        app_context.fe_status == APP_FE_STATUS_TIMER_INTERACT ||
+        (app_context.fe_status == APP_FE_STATUS_NTC_CAL && app_context.ntc_cal_point == 1)
+    );
 
     switch (app_context.fe_status) {
         case APP_FE_STATUS_TEMP_INTERACT:
@@ -60,6 +130,17 @@ static void app_refresh_display(void) {
         case APP_FE_STATUS_TIMER_INTERACT:
             bsp_display_write_int(app_context.target_time_hours);
             break;
+        case APP_FE_STATUS_ENERGY: {
+            /* 两位数码管以 0.1kWh 为单位显示本次开机耗电量 */
+            app_energy_snapshot_t energy;
+            app_energy_get_snapshot(&energy);
+            const uint32_t hecto_wh = energy.session_wh / 100;
+            bsp_display_write_int(hecto_wh > 99 ? 99 : (int)hecto_wh);
+            break;
+        }
+        case APP_FE_STATUS_NTC_CAL:
+            bsp_display_write_int(app_context.ntc_cal_reference);
+            break;
         case APP_FE_STATUS_IDLE:
             app_context.be_status_on
                 ? bsp_display_write_int(app_context.target_temperature)
@@ -92,6 +173,12 @@ static void app_fe_switch_status(const app_frontend_status_t status) {
         case APP_FE_STATUS_TIMER_INTERACT:
             bsp_led_strip_write(BSP_STRIP_BLUE);
             break;
+        case APP_FE_STATUS_ENERGY:
+            bsp_led_strip_write(BSP_STRIP_WHITE);
+            break;
+        case APP_FE_STATUS_NTC_CAL:
+            bsp_led_strip_write(BSP_STRIP_GREEN);
+            break;
         default:
             break;
     }
@@ -100,6 +187,25 @@ static void app_fe_switch_status(const app_frontend_status_t status) {
     app_refresh_display();
 }
 
+/**
+ * @brief 更新空闲状态灯带模式, 前台空闲时立即生效
+ */
+static void app_set_idle_strip_mode(const bsp_led_strip_mode_t mode) {
+    if (app_context.idle_strip_mode == mode) { return; }
+    app_context.idle_strip_mode = mode;
+    if (app_context.fe_status == APP_FE_STATUS_IDLE) { bsp_led_strip_write(app_context.idle_strip_mode); }
+}
+
+/**
+ * @brief 设置界面目标温度, 并作用于所有加热通道
+ */
+static void app_set_target_temperature(const int temperature) {
+    app_context.target_temperature = temperature;
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { app_context.zone_target_temperature[ch] = temperature; }
+    app_tasks_wake_heating();
+    app_tasks_publish_state();
+}
+
 /**
  * @brief 切换应用后台状态
  */
@@ -109,15 +215,19 @@ static void app_be_toggle_status(void) {
 
     /* 恢复应用目标参数 */
     if (app_context.be_status_on) {
+        app_energy_session_start();
         app_context.idle_strip_mode = BSP_STRIP_ORANGE;
-        app_context.target_temperature = target_temperature_default;
+        app_set_target_temperature(target_temperature_default);
         app_context.target_time_hours = target_time_hours_default;
     } else {
+        app_energy_session_end();
         app_context.idle_strip_mode = BSP_STRIP_OFF;
-        app_context.target_temperature = 0;
+        app_set_target_temperature(0);
         app_context.target_time_hours = 0;
     }
     app_context.target_time_dirty = true;
+    app_context.remaining_min = app_context.target_time_hours * 60;
+    app_tasks_publish_state();
 
     /* 更新灯带状态 */
     bsp_led_strip_write(app_context.idle_strip_mode);
@@ -126,6 +236,27 @@ static void app_be_toggle_status(void) {
     app_fe_switch_status(APP_FE_STATUS_IDLE);
 }
 
+#if CONFIG_APP_DRYDETECT_ENABLE
+/**
+ * @brief 毛巾已干燥: 结束本次加热, 或降到保温温度
+ *
+ * 干燥检测只跟踪通道0, 保温温度只作用于通道0
+ */
+static void app_on_towels_dry(void) {
+#if CONFIG_APP_DRYDETECT_ACTION_OFF
+    ESP_LOGI(TAG, "Towels dry, ending session");
+    app_be_toggle_status();
+#elif CONFIG_APP_DRYDETECT_ACTION_MAINTAIN
+    if (app_context.target_temperature <= CONFIG_APP_DRYDETECT_MAINTAIN_TEMP) { return; }
+    ESP_LOGI(TAG, "Towels dry, holding %d C", CONFIG_APP_DRYDETECT_MAINTAIN_TEMP);
+    app_context.target_temperature = CONFIG_APP_DRYDETECT_MAINTAIN_TEMP;
+    app_context.zone_target_temperature[0] = CONFIG_APP_DRYDETECT_MAINTAIN_TEMP;
+    app_refresh_display();
+    app_tasks_publish_state();
+#endif
+}
+#endif
+
 /**
  * @brief 温度交互事件处理
  *
@@ -151,6 +282,7 @@ static void temp_inter_handler(const bsp_input_event_t event) {
     if (app_context.target_temperature > target_temperature_max) {
         app_context.target_temperature = target_temperature_min;
     }
+    app_set_target_temperature(app_context.target_temperature);
 
     ESP_LOGI(TAG, "Target temperature changed: %d", app_context.target_temperature);
 }
@@ -181,73 +313,229 @@ static void timer_inter_handler(const bsp_input_event_t event) {
     if (app_context.target_time_hours > target_time_hours_max) {
         app_context.target_time_hours = target_time_hours_min;
     }
+    app_context.remaining_min = app_context.target_time_hours * 60;
+    app_tasks_publish_state();
 
     ESP_LOGI(TAG, "Target time changed: %d", app_context.target_time_hours);
 }
 
 /**
- * @brief 处理系统开启状态下的用户输入事件
+ * @brief NTC校准参考温度的初始值: 当前未校准读数
+ */
+static int ntc_cal_default_reference(void) {
+    int32_t temp;
+    if (bsp_heating_read_temp_uncalibrated(&temp) != ESP_OK) { return 25; }
+    return (int)((temp + 500) / 1000);
+}
+
+/**
+ * @brief NTC校准参考温度交互事件处理
  *
  * @param event 设备输入事件
  */
-static void app_be_active_status_input_handler(const bsp_input_event_t event) {
-    /* 处理按钮切换前台任务事件 */
-    if (event == BSP_TOUCH_BUTTON_L_CLICK || event == BSP_TOUCH_BUTTON_R_CLICK) {
-        app_fe_switch_status(
-            event == BSP_TOUCH_BUTTON_L_CLICK ? APP_FE_STATUS_TEMP_INTERACT : APP_FE_STATUS_TIMER_INTERACT
-        );
-        return;
-    }
-
-    /* 其余输入事件根据前台任务状态分发 */
-    switch (app_context.fe_status) {
-        case APP_FE_STATUS_TEMP_INTERACT:
-            temp_inter_handler(event);
+static void ntc_cal_inter_handler(const bsp_input_event_t event) {
+    switch (event) {
+        case BSP_KNOB_ENCODER_ACW:
+            app_context.ntc_cal_reference--;
             break;
-        case APP_FE_STATUS_TIMER_INTERACT:
-            timer_inter_handler(event);
+        case BSP_KNOB_ENCODER_CW:
+            app_context.ntc_cal_reference++;
             break;
         default:
-            break;
+            return;
     }
 
-    app_refresh_display();
+    xTaskNotifyGive(app_fe_status_watchdog_handle);
+
+    if (app_context.ntc_cal_reference < 0) { app_context.ntc_cal_reference = 99; }
+    if (app_context.ntc_cal_reference > 99) { app_context.ntc_cal_reference = 0; }
 }
 
 /**
- * @brief 处理系统休眠状态下的用户输入事件
+ * @brief 进入NTC两点校准 (状态转移动作)
  *
- * @param event 设备输入事件
+ * 旋钮输入参考温度计读数, 右键采集当前校准点; H标志亮表示正在采集第二个点
  */
-static void app_be_sleep_status_input_handler(const bsp_input_event_t event) {
-    /* 处理显示系统信息事件 */
-    if (app_context.fe_status == APP_FE_STATUS_IDLE && event == BSP_KNOB_MT8_CLICK) {
-        ESP_LOGI(TAG, "System version: %s", esp_get_idf_version());
+static void app_ui_enter_ntc_cal(__attribute__((unused)) const bsp_input_event_t event) {
+    app_ntc_cal_begin();
+    app_context.ntc_cal_point = 0;
+    app_context.ntc_cal_reference = ntc_cal_default_reference();
+}
+
+/**
+ * @brief 采集NTC校准点, 第二个点采集后计算并保存校准系数 (状态转移动作)
+ */
+static void app_ui_ntc_cal_capture(__attribute__((unused)) const bsp_input_event_t event) {
+    if (app_ntc_cal_capture(app_context.ntc_cal_point, app_context.ntc_cal_reference * 1000) != ESP_OK) {
+        app_fe_switch_status(APP_FE_STATUS_IDLE);
         return;
     }
 
-    /* 处理按钮切换前台任务事件, 休眠状态下只允许定时任务 */
-    if (event == BSP_TOUCH_BUTTON_R_CLICK) {
-        app_fe_switch_status(APP_FE_STATUS_TIMER_INTERACT);
+    if (app_context.ntc_cal_point == 0) {
+        app_context.ntc_cal_point = 1;
+        app_context.ntc_cal_reference = ntc_cal_default_reference();
+        app_fe_switch_status(APP_FE_STATUS_NTC_CAL);
         return;
     }
 
-    /* 其余输入事件根据前台任务状态分发 */
-    switch (app_context.fe_status) {
-        case APP_FE_STATUS_TIMER_INTERACT:
-            timer_inter_handler(event);
+    app_ntc_cal_commit();
+    app_fe_switch_status(APP_FE_STATUS_IDLE);
+}
+
+/**
+ * @brief 切换系统开关机状态 (状态转移动作)
+ */
+static void app_ui_toggle_power(__attribute__((unused)) const bsp_input_event_t event) { app_be_toggle_status(); }
+
+/**
+ * @brief 显示系统信息 (状态转移动作)
+ */
+static void app_ui_show_version(__attribute__((unused)) const bsp_input_event_t event) {
+    ESP_LOGI(TAG, "System version: %s", esp_get_idf_version());
+    app_ui_log_transition_counters();
+}
+
+/**
+ * @brief 开始/取消PID自整定 (状态转移动作)
+ */
+static void app_ui_toggle_autotune(__attribute__((unused)) const bsp_input_event_t event) {
+    if (app_autotune_get_state() == APP_AUTOTUNE_RUNNING) {
+        app_autotune_cancel();
+    } else {
+        app_tasks_start_autotune();
+    }
+}
+
+/**************************************************************************************************
+ * UI State Machine
+ *
+ * 用户界面状态由 (后台状态, 前台状态) 组成, 输入事件按状态转移表分发:
+ *   (后台状态, 前台状态, 输入事件) -> (动作, 次态)
+ * 转移表在编译期由下方的声明式规格生成, 未列出的组合默认为 "无动作, 保持状态并刷新显示".
+ **************************************************************************************************/
+
+typedef enum {
+    APP_UI_NEXT_STAY = 0,              // 保持前台状态, 刷新显示
+    APP_UI_NEXT_DONE,                  // 动作已完成全部处理, 不再刷新显示
+    APP_UI_NEXT_IDLE,                  // 切换到 APP_FE_STATUS_IDLE
+    APP_UI_NEXT_TEMP_INTERACT,         // 切换到 APP_FE_STATUS_TEMP_INTERACT
+    APP_UI_NEXT_TIMER_INTERACT,        // 切换到 APP_FE_STATUS_TIMER_INTERACT
+    APP_UI_NEXT_ENERGY,                // 切换到 APP_FE_STATUS_ENERGY
+    APP_UI_NEXT_NTC_CAL,               // 切换到 APP_FE_STATUS_NTC_CAL
+} app_ui_next_t;
+
+_Static_assert(APP_UI_NEXT_TEMP_INTERACT - APP_UI_NEXT_IDLE == APP_FE_STATUS_TEMP_INTERACT, "UI next order");
+_Static_assert(APP_UI_NEXT_TIMER_INTERACT - APP_UI_NEXT_IDLE == APP_FE_STATUS_TIMER_INTERACT, "UI next order");
+_Static_assert(APP_UI_NEXT_ENERGY - APP_UI_NEXT_IDLE == APP_FE_STATUS_ENERGY, "UI next order");
+_Static_assert(APP_UI_NEXT_NTC_CAL - APP_UI_NEXT_IDLE == APP_FE_STATUS_NTC_CAL, "UI next order");
+
+typedef struct {
+    void (*action)(bsp_input_event_t event); // 转移动作, 可为空
+    app_ui_next_t next;                      // 次态
+} app_ui_transition_t;
+
+#define APP_UI_BE_OFF       0
+#define APP_UI_BE_ON        1
+#define APP_UI_STATE_NUM    (2 * APP_FE_STATUS_MAX)
+#define APP_UI_STATE(be, fe) ((be) * APP_FE_STATUS_MAX + (fe))
+
+/**
+ * 状态转移规格: X(后台状态, 前台状态, 输入事件, 动作, 次态)
+ */
+#define APP_UI_TRANSITION_SPEC(X)                                                                       \
+    /* 休眠状态: 长按开机, 连击8次显示系统信息, 只允许进入定时设置与耗电量页面,                       \
+     * 耗电量页面连击8次进入NTC两点校准 */                                                            \
+    X(OFF, IDLE,           BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(OFF, IDLE,           BSP_KNOB_MT8_CLICK,       app_ui_show_version,  DONE)                        \
+    X(OFF, IDLE,           BSP_TOUCH_BUTTON_R_CLICK, NULL,                 TIMER_INTERACT)              \
+    X(OFF, TEMP_INTERACT,  BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(OFF, TEMP_INTERACT,  BSP_TOUCH_BUTTON_R_CLICK, NULL,                 TIMER_INTERACT)              \
+    X(OFF, TIMER_INTERACT, BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(OFF, TIMER_INTERACT, BSP_TOUCH_BUTTON_R_CLICK, NULL,                 ENERGY)                      \
+    X(OFF, TIMER_INTERACT, BSP_KNOB_ENCODER_ACW,     timer_inter_handler,  STAY)                        \
+    X(OFF, TIMER_INTERACT, BSP_KNOB_ENCODER_CW,      timer_inter_handler,  STAY)                        \
+    X(OFF, ENERGY,         BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(OFF, ENERGY,         BSP_TOUCH_BUTTON_R_CLICK, NULL,                 TIMER_INTERACT)              \
+    X(OFF, ENERGY,         BSP_KNOB_MT8_CLICK,       app_ui_enter_ntc_cal, NTC_CAL)                     \
+    X(OFF, NTC_CAL,        BSP_KNOB_LONG_PRESS,      NULL,                 IDLE)                        \
+    X(OFF, NTC_CAL,        BSP_TOUCH_BUTTON_L_CLICK, NULL,                 IDLE)                        \
+    X(OFF, NTC_CAL,        BSP_TOUCH_BUTTON_R_CLICK, app_ui_ntc_cal_capture, DONE)                      \
+    X(OFF, NTC_CAL,        BSP_KNOB_ENCODER_ACW,     ntc_cal_inter_handler, STAY)                       \
+    X(OFF, NTC_CAL,        BSP_KNOB_ENCODER_CW,      ntc_cal_inter_handler, STAY)                       \
+    /* 开启状态: 长按关机, 连击8次开始/取消自整定, 左/右键进入温度/定时设置, 定时设置中右键看耗电量 */ \
+    X(ON,  IDLE,           BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(ON,  IDLE,           BSP_KNOB_MT8_CLICK,       app_ui_toggle_autotune, STAY)                      \
+    X(ON,  IDLE,           BSP_TOUCH_BUTTON_L_CLICK, NULL,                 TEMP_INTERACT)               \
+    X(ON,  IDLE,           BSP_TOUCH_BUTTON_R_CLICK, NULL,                 TIMER_INTERACT)              \
+    X(ON,  TEMP_INTERACT,  BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(ON,  TEMP_INTERACT,  BSP_TOUCH_BUTTON_L_CLICK, NULL,                 TEMP_INTERACT)               \
+    X(ON,  TEMP_INTERACT,  BSP_TOUCH_BUTTON_R_CLICK, NULL,                 TIMER_INTERACT)              \
+    X(ON,  TEMP_INTERACT,  BSP_KNOB_ENCODER_ACW,     temp_inter_handler,   STAY)                        \
+    X(ON,  TEMP_INTERACT,  BSP_KNOB_ENCODER_CW,      temp_inter_handler,   STAY)                        \
+    X(ON,  TIMER_INTERACT, BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(ON,  TIMER_INTERACT, BSP_TOUCH_BUTTON_L_CLICK, NULL,                 TEMP_INTERACT)               \
+    X(ON,  TIMER_INTERACT, BSP_TOUCH_BUTTON_R_CLICK, NULL,                 ENERGY)                      \
+    X(ON,  TIMER_INTERACT, BSP_KNOB_ENCODER_ACW,     timer_inter_handler,  STAY)                        \
+    X(ON,  TIMER_INTERACT, BSP_KNOB_ENCODER_CW,      timer_inter_handler,  STAY)                        \
+    X(ON,  ENERGY,         BSP_KNOB_LONG_PRESS,      app_ui_toggle_power,  DONE)                        \
+    X(ON,  ENERGY,         BSP_TOUCH_BUTTON_L_CLICK, NULL,                 TEMP_INTERACT)               \
+    X(ON,  ENERGY,         BSP_TOUCH_BUTTON_R_CLICK, NULL,                 TIMER_INTERACT)
+
+#define APP_UI_TRANSITION_ENTRY(be, fe, event, action_fn, next_state)                                   \
+    [APP_UI_STATE(APP_UI_BE_##be, APP_FE_STATUS_##fe)][event] = {                                        \
+        .action = (action_fn),                                                                          \
+        .next = APP_UI_NEXT_##next_state,                                                               \
+    },
+
+/* 状态转移表 */
+static const app_ui_transition_t app_ui_transitions[APP_UI_STATE_NUM][BSP_INPUT_EVENT_MAX] = {
+    APP_UI_TRANSITION_SPEC(APP_UI_TRANSITION_ENTRY)
+};
+
+/* 状态转移计数器 */
+static uint32_t app_ui_transition_counters[APP_UI_STATE_NUM][BSP_INPUT_EVENT_MAX] = {0};
+
+/**
+ * @brief 根据状态转移表处理用户输入事件
+ *
+ * @param event 设备输入事件
+ */
+static void app_ui_dispatch(const bsp_input_event_t event) {
+    if (event >= BSP_INPUT_EVENT_MAX) { return; }
+
+    const int state = APP_UI_STATE(app_context.be_status_on, app_context.fe_status);
+    const app_ui_transition_t* transition = &app_ui_transitions[state][event];
+
+    app_ui_transition_counters[state][event]++;
+
+    if (transition->action != NULL) { transition->action(event); }
+
+    switch (transition->next) {
+        case APP_UI_NEXT_STAY:
+            app_refresh_display();
+            break;
+        case APP_UI_NEXT_DONE:
             break;
         default:
+            app_fe_switch_status((app_frontend_status_t)(transition->next - APP_UI_NEXT_IDLE));
             break;
     }
+}
 
-    app_refresh_display();
+void app_ui_log_transition_counters(void) {
+    for (int state = 0; state < APP_UI_STATE_NUM; state++) {
+        for (int event = 0; event < BSP_INPUT_EVENT_MAX; event++) {
+            if (app_ui_transition_counters[state][event] == 0) { continue; }
+            ESP_LOGI(TAG, "[UI] be:%d fe:%d %s x%" PRIu32, state / APP_FE_STATUS_MAX, state % APP_FE_STATUS_MAX,
+                     bsp_input_event_to_string(event), app_ui_transition_counters[state][event]);
+        }
+    }
 }
 
 /**
  * @brief [RT任务]用户输入处理
  *
- * 该任务负责从输入队列中获取用户输入事件，并根据当前应用状态进行处理。
+ * 该任务负责从输入队列中获取用户输入事件，并根据UI状态转移表进行处理。
  */
 _Noreturn static void input_redirect_task(__attribute__((unused)) void* pvParameters) {
     bsp_input_event_t event;
@@ -257,16 +545,7 @@ _Noreturn static void input_redirect_task(__attribute__((unused)) void* pvParame
 
         ESP_LOGI(TAG, "[InputRedirectTask] Received input event: %d:%s", event, bsp_input_event_to_string(event));
 
-        /* 拦截处理长按按钮事件，实现系统开关 */
-        if (event == BSP_KNOB_LONG_PRESS) {
-            app_be_toggle_status();
-            continue;
-        }
-
-        /* 根据当前后端状态分发事件处理 */
-        app_context.be_status_on
-            ? app_be_active_status_input_handler(event)
-            : app_be_sleep_status_input_handler(event);
+        app_ui_dispatch(event);
     }
 }
 
@@ -277,7 +556,8 @@ _Noreturn static void input_redirect_task(__attribute__((unused)) void* pvParame
  */
 _Noreturn static void fe_status_watchdog(__attribute__((unused)) void* pvParameters) {
     while (true) {
-        const uint32_t notify_value = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(fe_task_hold_time));
+        const int hold_time = app_context.fe_status == APP_FE_STATUS_NTC_CAL ? ntc_cal_hold_time : fe_task_hold_time;
+        const uint32_t notify_value = ulTaskNotifyTake(pdTRUE, BSP_MS_TO_TICKS(hold_time));
 
         if (notify_value == 0 && app_context.fe_status != APP_FE_STATUS_IDLE) {
             app_fe_switch_status(APP_FE_STATUS_IDLE);
@@ -285,48 +565,334 @@ _Noreturn static void fe_status_watchdog(__attribute__((unused)) void* pvParamet
     }
 }
 
+/* 加热通道控制器状态 */
+typedef struct {
+    uint8_t heating_status;    // 回差控制升温模式: [0]干柴烈火, [1]贤者模式
+    app_estimator_t estimator; // 毛巾架温度估计器, 每次开机时用NTC读数重新初始化
+    bool estimator_ready;
+    app_pid_t pid;             // PID控制器及时间比例输出窗口
+    bool pid_ready;
+    int pid_window_elapsed_ms;
+    int pid_on_ms;
+    int32_t last_temp;         // 上一周期参与控制的温度 (m°C)
+    bool fast;                 // 升温中或接近切换温度, 需要按最短周期采样
+} heating_zone_t;
+
+static heating_zone_t heating_zones[BSP_HEATING_CHANNEL_NUM] = {0}; // 只在加热控制任务中访问
+
+/**
+ * @brief 计算一个加热通道本周期的加热器期望状态
+ *
+ * 控制方式按优先级选择:
+ *   1. 自整定进行中 (仅通道0): 继电反馈实验
+ *   2. 已整定: PID, 以 CONFIG_APP_PID_WINDOW_S 为窗口做时间比例输出
+ *   3. 未整定: 回差开关控制
+ *
+ * @param ch 通道号
+ * @param target_offset 电价规划给出的目标温度偏移 (°C)
+ * @param dt_ms 距上一周期的时间 (ms), 开机后的第一个周期为0
+ * @param[out] request 加热器期望状态
+ * @param[out] at_target 是否已达到目标温度
+ * @return ESP_OK; NTC读取失败时返回错误, 此时期望状态为关闭
+ */
+static esp_err_t heating_zone_step(
+    const int ch, const int target_offset, const uint32_t dt_ms, bool* request, bool* at_target
+) {
+    heating_zone_t* zone = &heating_zones[ch];
+    const int target_temperature = app_context.zone_target_temperature[ch] + target_offset;
+
+    *request = false;
+    *at_target = false;
+    zone->fast = true;
+
+    int32_t ntc_temp;
+    const esp_err_t ret = bsp_heating_channel_read_temp(ch, &ntc_temp);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read temperature of zone %d, heating paused", ch);
+        return ret;
+    }
+
+    /* 上一周期加热器的占空比即当前的加热器状态 */
+    const uint32_t duty_permille = bsp_heating_channel_is_enabled(ch) ? 1000 : 0;
+    if (!zone->estimator_ready) {
+        app_estimator_init(&zone->estimator, ntc_temp);
+        zone->estimator_ready = true;
+        zone->last_temp = ntc_temp;
+    }
+    const int32_t rack_temp = app_estimator_update(&zone->estimator, ntc_temp, duty_permille, dt_ms);
+
+#if CONFIG_APP_ESTIMATOR_LOG
+    ESP_LOGI(TAG, "EST,%" PRIu32 ",%" PRIu32 ",%" PRId32 ",%" PRId32,
+             (uint32_t)BSP_TICKS_TO_MS(xTaskGetTickCount()), duty_permille, ntc_temp, rack_temp);
+#endif
+
+    /* 使用估计的毛巾架温度调节, 补偿NTC的热滞后 */
+#if CONFIG_APP_ESTIMATOR_ENABLE
+    const int32_t control_temp = rack_temp;
+#else
+    const int32_t control_temp = ntc_temp;
+#endif
+    app_context.zone_temperature[ch] = control_temp;
+    const int current_temperature = control_temp / 1000;
+    ESP_LOGI(TAG, "Current temperature: %d (zone %d)", current_temperature, ch);
+
+    /* 温度变化速率超过阈值视为升温或降温中 */
+    const int64_t change_mC = labs(control_temp - zone->last_temp);
+    const bool ramping = change_mC * 1000 > (int64_t)CONFIG_APP_HEATING_STABLE_RATE * dt_ms;
+    zone->last_temp = control_temp;
+
+    float kp, ki, kd;
+
+    if (ch == 0 && app_autotune_get_state() == APP_AUTOTUNE_RUNNING) {
+        /* 继电反馈实验, 结束后下一周期按新增益重新初始化PID */
+        *request = app_autotune_step(control_temp, dt_ms);
+        zone->pid_ready = false;
+    } else if (settings_get_pid_gains(&kp, &ki, &kd)) {
+        if (!zone->pid_ready) {
+            app_pid_init(&zone->pid, kp, ki, kd);
+            zone->pid_window_elapsed_ms = 0;
+            zone->pid_ready = true;
+        } else {
+            /* 按实际间隔推进窗口, 唤醒晚于窗口结束时从本次唤醒开始新窗口 */
+            zone->pid_window_elapsed_ms += (int)dt_ms;
+            if (zone->pid_window_elapsed_ms >= pid_window_ms) { zone->pid_window_elapsed_ms = 0; }
+        }
+
+        /* 每个窗口开始时计算占空比, 窗口内先开后关 */
+        if (zone->pid_window_elapsed_ms == 0) {
+            const uint32_t duty = app_pid_update(&zone->pid, (float)target_temperature, (float)control_temp / 1000,
+                                                 (float)pid_window_ms / 1000);
+            zone->pid_on_ms = (int)(duty * pid_window_ms / 1000);
+            ESP_LOGI(TAG, "PID duty: %" PRIu32 " permille (zone %d)", duty, ch);
+        }
+        *request = zone->pid_window_elapsed_ms < zone->pid_on_ms;
+        *at_target = current_temperature >= target_temperature - 1;
+        zone->fast = ramping; // 输出只在窗口的开关时刻变化, 见 heating_zone_next_edge_ms
+    } else {
+        switch (zone->heating_status) {
+            case 0:
+                if (current_temperature >= target_temperature) { zone->heating_status = 1; }
+                *request = true;
+                break;
+            case 1:
+                if (current_temperature < target_temperature - heating_hysteresis_c) { zone->heating_status = 0; }
+                break;
+            default:
+                ESP_LOGE(TAG, "Invalid heating status: %d", zone->heating_status);
+        }
+        *at_target = zone->heating_status == 1;
+
+        /* 接近下一次切换的温度时按最短周期采样, 避免错过切换造成过冲 */
+        const int threshold =
+            zone->heating_status == 0 ? target_temperature : target_temperature - heating_hysteresis_c;
+        zone->fast = ramping || labs(control_temp - threshold * 1000) <= CONFIG_APP_HEATING_NEAR_BAND_C * 1000;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 距离PID时间比例输出下一次开关的时间 (ms), 未使用PID时返回 UINT32_MAX
+ */
+static uint32_t heating_zone_next_edge_ms(const heating_zone_t* zone) {
+    if (!zone->pid_ready) { return UINT32_MAX; }
+    if (zone->pid_window_elapsed_ms < zone->pid_on_ms) { return zone->pid_on_ms - zone->pid_window_elapsed_ms; }
+    return pid_window_ms - zone->pid_window_elapsed_ms;
+}
+
+/* 加热控制任务唤醒统计, 只在加热控制任务中写入 */
+static struct {
+    uint32_t wakeups;      // 启动以来的唤醒次数
+    uint32_t hour_count;   // 本小时内的唤醒次数
+    uint32_t last_hour;    // 上一小时的唤醒次数
+    TickType_t hour_start; // 本小时开始的时刻
+    uint32_t period_ms;    // 当前控制周期, 0 为等待通知
+} heating_loop;
+
+/**
+ * @brief 记录一次唤醒, 每满一小时输出上一小时的唤醒次数
+ *
+ * 加热控制任务至少在每个整小时唤醒一次 (见 heating_task), 关机等待期间统计也按时输出.
+ */
+static void heating_loop_count_wakeup(const TickType_t now) {
+    const TickType_t hour_ticks = BSP_MS_TO_TICKS(3600 * 1000);
+    const TickType_t elapsed = now - heating_loop.hour_start;
+
+    if (elapsed >= hour_ticks) {
+        /* 关机等待期间可能跨过整小时而没有唤醒 */
+        heating_loop.last_hour = elapsed < 2 * hour_ticks ? heating_loop.hour_count : 0;
+        heating_loop.hour_start = elapsed < 2 * hour_ticks ? heating_loop.hour_start + hour_ticks : now;
+        heating_loop.hour_count = 0;
+        ESP_LOGI(TAG, "Heating loop: %" PRIu32 " wakeups in the last hour, period %" PRIu32 " ms",
+                 heating_loop.last_hour, heating_loop.period_ms);
+    }
+    heating_loop.wakeups++;
+    heating_loop.hour_count++;
+}
+
+/**
+ * @brief 计算下一个控制周期
+ *
+ * 任一通道升温中, 接近切换温度或自整定时为最短周期. 否则使用PID时直接等到时间比例窗口的下一次开关时刻,
+ * 每个窗口只在开始与关断时唤醒两次 (占空比为0或满时一次); 回差控制在上一周期基础上加倍, 不超过
+ * CONFIG_APP_HEATING_PERIOD_MAX_MS. 开关时刻向上取整到系统节拍, 避免提前一个节拍醒来后再唤醒一次.
+ */
+static uint32_t heating_loop_next_period(const uint32_t period_ms) {
+    bool fast = false;
+    uint32_t next_edge_ms = UINT32_MAX;
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        fast = fast || heating_zones[ch].fast;
+        const uint32_t edge_ms = heating_zone_next_edge_ms(&heating_zones[ch]);
+        if (edge_ms < next_edge_ms) { next_edge_ms = edge_ms; }
+    }
+#if CONFIG_APP_COORD_ENABLE
+    /* 分时期间本节点的时段随时间切换 */
+    app_coord_status_t coord;
+    app_coord_get_status(&coord);
+    fast = fast || coord.limited;
+#endif
+
+    uint32_t next_ms;
+    if (fast || period_ms == 0) {
+        next_ms = heating_period_ms;
+    } else if (next_edge_ms != UINT32_MAX) {
+        next_ms = next_edge_ms;
+    } else {
+        next_ms = period_ms * 2 < CONFIG_APP_HEATING_PERIOD_MAX_MS ? period_ms * 2 : CONFIG_APP_HEATING_PERIOD_MAX_MS;
+    }
+    if (next_ms > next_edge_ms) { next_ms = next_edge_ms; }
+    if (next_ms < heating_period_ms) { next_ms = heating_period_ms; }
+
+    const uint32_t tick_ms = BSP_TICKS_TO_MS(1);
+    return (next_ms + tick_ms - 1) / tick_ms * tick_ms;
+}
+
 /**
  * @brief [RT任务]加热控制任务
+ *
+ * 每个周期依次计算各加热通道的期望输出, 再由调度器错开打开加热器 (见 app_zone_sched.h).
+ * 灯带显示所有通道的汇总状态: 自整定中为白色, 全部达到目标温度为绿色, 否则为橙色.
+ * 控制周期随温度状态在 1000ms 与 CONFIG_APP_HEATING_PERIOD_MAX_MS 之间调整; 关机或故障锁定后
+ * 只在整小时唤醒一次输出唤醒统计, 开关机, 修改目标温度与安全故障通过 app_tasks_wake_heating 立即唤醒.
  */
 _Noreturn void heating_task(__attribute__((unused)) void* pvParameters) {
-    /* 升温模式: [0]干柴烈火, [1]贤者模式 */
-    uint8_t heating_status = 0;
+    TickType_t last_wake_time = xTaskGetTickCount();
+    heating_loop.hour_start = last_wake_time;
+    heating_loop.period_ms = heating_period_ms;
+
     while (1) {
+        /* 最迟在本小时结束时唤醒, 输出唤醒统计 */
+        const TickType_t hour_ticks = BSP_MS_TO_TICKS(3600 * 1000);
+        const TickType_t hour_elapsed = xTaskGetTickCount() - heating_loop.hour_start;
+        TickType_t timeout = hour_elapsed < hour_ticks ? hour_ticks - hour_elapsed : 0;
+
+        /* 按上次唤醒时刻计时, 处理耗时 (如调度器错开打开) 不累积到周期中 */
+        if (heating_loop.period_ms > 0) {
+            const TickType_t period = BSP_MS_TO_TICKS(heating_loop.period_ms);
+            const TickType_t spent = xTaskGetTickCount() - last_wake_time;
+            if (spent >= period) {
+                timeout = 0;
+            } else if (period - spent < timeout) {
+                timeout = period - spent;
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, timeout);
+
+        /* 从等待通知中恢复时重新初始化各通道, 间隔不参与推算 */
+        const TickType_t now = xTaskGetTickCount();
+        const uint32_t dt_ms = heating_loop.period_ms > 0 ? (uint32_t)BSP_TICKS_TO_MS(now - last_wake_time) : 0;
+        last_wake_time = now;
+        heating_loop_count_wakeup(now);
+
+        /* 安全监控已锁定加热器, 只需显示故障 */
+        if (app_safety_get_fault() != APP_SAFETY_FAULT_NONE) {
+#if CONFIG_APP_COORD_ENABLE
+            app_coord_set_demand(0);
+#endif
+            app_autotune_cancel();
+            if (app_context.idle_strip_mode != BSP_STRIP_RED) {
+                app_context.idle_strip_mode = BSP_STRIP_RED;
+                bsp_led_strip_write(app_context.idle_strip_mode);
+                app_refresh_display();
+            }
+            app_tasks_publish_state();
+            heating_loop.period_ms = 0;
+            continue;
+        }
+
         if (!app_context.be_status_on) {
-            bsp_heating_disable();
-            vTaskDelay(pdMS_TO_TICKS(1000));
+#if CONFIG_APP_COORD_ENABLE
+            app_coord_set_demand(0);
+#endif
+            app_zone_sched_all_off();
+            app_autotune_cancel();
+#if CONFIG_APP_DRYDETECT_ENABLE
+            app_drydetect_reset();
+#endif
+            for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+                heating_zones[ch].estimator_ready = false;
+                heating_zones[ch].pid_ready = false;
+            }
+            heating_loop.period_ms = 0;
             continue;
         }
 
-        const int current_temperature = bsp_heating_get_temp();
-        ESP_LOGI(TAG, "Current temperature: %d", current_temperature);
+        /* 电价规划调整目标温度或暂停加热, 自整定期间不调整 */
+        int target_offset = 0;
+        bool tariff_hold = false;
+#if CONFIG_APP_TARIFF_ENABLE
+        int8_t tariff_offset;
+        if (app_autotune_get_state() != APP_AUTOTUNE_RUNNING && app_tariff_get_offset(&tariff_offset)) {
+            tariff_hold = tariff_offset == APP_TARIFF_OFF;
+            target_offset = tariff_hold ? 0 : tariff_offset;
+        }
+#endif
+
+        bool request[BSP_HEATING_CHANNEL_NUM];
+        bool all_at_target = true;
+        bool zone0_ok = true;
+        for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+            bool at_target;
+            const esp_err_t ret = heating_zone_step(ch, target_offset, dt_ms, &request[ch], &at_target);
+            if (ch == 0) { zone0_ok = ret == ESP_OK; }
+            all_at_target = all_at_target && at_target;
+
+            /* 暂停期间仍然更新温度估计, 恢复加热时重新初始化PID, 避免积分饱和 */
+            if (tariff_hold) {
+                request[ch] = false;
+                heating_zones[ch].pid_ready = false;
+            }
+        }
+#if CONFIG_APP_COORD_ENABLE
+        /* 需求按开机期间所有通道的额定功率公告, 不随占空比跳变; 不在本节点的时段内时关闭所有通道 */
+        app_coord_set_demand(tariff_hold ? 0 : BSP_HEATING_CHANNEL_NUM * BSP_BOARD_HEATER_RATED_W);
+        if (!app_coord_may_heat()) {
+            for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { request[ch] = false; }
+        }
+#endif
+        app_zone_sched_apply(request);
 
-        switch (heating_status) {
-            case 0:
-                bsp_heating_enable();
-                if (current_temperature >= app_context.target_temperature) {
-                    app_context.idle_strip_mode = BSP_STRIP_GREEN;
-                    if (app_context.fe_status == APP_FE_STATUS_IDLE) {
-                        bsp_led_strip_write(app_context.idle_strip_mode);
-                    }
-                    heating_status = 1;
-                }
-                break;
-            case 1:
-                bsp_heating_disable();
-                if (current_temperature < app_context.target_temperature - 5) {
-                    app_context.idle_strip_mode = BSP_STRIP_ORANGE;
-                    if (app_context.fe_status == APP_FE_STATUS_IDLE) {
-                        bsp_led_strip_write(app_context.idle_strip_mode);
-                    }
-                    heating_status = 0;
-                }
-                break;
-            default:
-                ESP_LOGE(TAG, "Invalid heating status: %d", heating_status);
+        if (app_autotune_get_state() == APP_AUTOTUNE_RUNNING) {
+            app_set_idle_strip_mode(BSP_STRIP_WHITE);
+        } else {
+            app_set_idle_strip_mode(all_at_target ? BSP_STRIP_GREEN : BSP_STRIP_ORANGE);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
+#if CONFIG_APP_DRYDETECT_ENABLE
+        /* 干燥检测只跟踪通道0, 自整定与电价规划暂停期间的占空比不反映毛巾状态 */
+        if (app_autotune_get_state() == APP_AUTOTUNE_RUNNING || tariff_hold) {
+            app_drydetect_reset();
+        } else if (zone0_ok && app_drydetect_update(bsp_heating_channel_is_enabled(0), app_context.zone_temperature[0],
+                                                    app_context.zone_target_temperature[0] + target_offset,
+                                                    dt_ms)) {
+            app_on_towels_dry();
+        }
+#else
+        (void)zone0_ok;
+#endif
+
+        app_tasks_publish_state();
+        heating_loop.period_ms = heating_loop_next_period(heating_loop.period_ms);
     }
 }
 
@@ -337,7 +903,8 @@ _Noreturn void power_on_off_task(__attribute__((unused)) void* pvParameters) {
     int rest_3sec_counter = 0; // 3秒计数器
     while (1) {
         if (app_context.target_time_hours == 0) {
-            vTaskDelay(pdMS_TO_TICKS(3000)); // 3秒检查一次
+            app_context.remaining_min = 0;
+            vTaskDelay(BSP_MS_TO_TICKS(3000)); // 3秒检查一次
             continue;
         }
 
@@ -346,7 +913,7 @@ _Noreturn void power_on_off_task(__attribute__((unused)) void* pvParameters) {
             app_context.target_time_dirty = false;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(3000)); // 3秒检查一次
+        vTaskDelay(BSP_MS_TO_TICKS(3000)); // 3秒检查一次
         rest_3sec_counter--;
 
         if (app_context.target_time_dirty) { continue; }
@@ -357,10 +924,70 @@ _Noreturn void power_on_off_task(__attribute__((unused)) void* pvParameters) {
         }
 
         app_context.target_time_hours = ceil((float)rest_3sec_counter / 20 / 60);
+        app_context.remaining_min = (rest_3sec_counter + 19) / 20;
+        app_tasks_publish_state();
         if (app_context.fe_status == APP_FE_STATUS_TIMER_INTERACT) { app_refresh_display(); }
     }
 }
 
+/**
+ * @brief 以当前目标温度开始PID自整定
+ */
+esp_err_t app_tasks_start_autotune(void) {
+    if (!app_context.be_status_on) {
+        ESP_LOGW(TAG, "Auto-tune requires the heater to be on");
+        return ESP_ERR_INVALID_STATE;
+    }
+    app_autotune_start(app_context.target_temperature);
+    app_tasks_wake_heating();
+    return ESP_OK;
+}
+
+bool app_tasks_is_on(void) { return app_context.be_status_on; }
+
+esp_err_t app_tasks_set_zone_target(const int channel, const int temperature) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return ESP_ERR_INVALID_ARG; }
+    if (temperature < target_temperature_min || temperature > target_temperature_max) { return ESP_ERR_INVALID_ARG; }
+    if (!app_context.be_status_on) { return ESP_ERR_INVALID_STATE; }
+
+    app_context.zone_target_temperature[channel] = temperature;
+    ESP_LOGI(TAG, "Zone %d target temperature changed: %d", channel, temperature);
+    app_tasks_wake_heating();
+    return ESP_OK;
+}
+
+void app_tasks_get_zone_status(const int channel, app_zone_status_t* status) {
+    status->target_temperature = app_context.zone_target_temperature[channel];
+    status->temperature = app_context.zone_temperature[channel];
+    status->heater_on = bsp_heating_channel_is_enabled(channel);
+
+    float kp, ki, kd;
+    status->switching_band = settings_get_pid_gains(&kp, &ki, &kd) ? 0 : heating_hysteresis_c;
+}
+
+void app_tasks_wake_heating(void) {
+    if (heating_task_handle != NULL) { xTaskNotifyGive(heating_task_handle); }
+}
+
+void app_tasks_get_heating_loop_status(app_heating_loop_status_t* status) {
+    const TickType_t hour_ticks = BSP_MS_TO_TICKS(3600 * 1000);
+    const TickType_t elapsed = xTaskGetTickCount() - heating_loop.hour_start;
+
+    status->wakeups = heating_loop.wakeups;
+    status->wakeups_this_hour = elapsed < hour_ticks ? heating_loop.hour_count : 0;
+    if (elapsed < hour_ticks) {
+        status->wakeups_last_hour = heating_loop.last_hour;
+    } else {
+        status->wakeups_last_hour = elapsed < 2 * hour_ticks ? heating_loop.hour_count : 0;
+    }
+    status->period_ms = heating_loop.period_ms;
+}
+
+APP_TASK_STORAGE(fe_status_watchdog, 2048);
+APP_TASK_STORAGE(input_redirect_task, 2048);
+APP_TASK_STORAGE(heating_task, 3584); // 自整定与干燥检测会在该任务中写NVS
+APP_TASK_STORAGE(power_on_off_task, 2048);
+
 /**
  * @brief 初始化系统任务
  */
@@ -368,20 +995,20 @@ void app_tasks_init(void) {
     bsp_input_queue = bsp_input_get_queue();
     assert(bsp_input_queue != NULL); // 输入事件队列必须存在
 
-    xTaskCreate(
+    APP_TASK_CREATE(
         // 创建前台状态看门狗任务
-        fe_status_watchdog, "FeStatusWatchdog", 2048, NULL, 10, &app_fe_status_watchdog_handle
+        fe_status_watchdog, fe_status_watchdog, "FeStatusWatchdog", NULL, 10, &app_fe_status_watchdog_handle
     );
-    xTaskCreate(
+    APP_TASK_CREATE(
         // 创建设备输入处理任务
-        input_redirect_task, "InputRedirectTask", 2048, NULL, 10, NULL
+        input_redirect_task, input_redirect_task, "InputRedirectTask", NULL, 10, NULL
     );
-    xTaskCreate(
+    APP_TASK_CREATE(
         // 创建加热控制任务
-        heating_task, "HeatingTask", 2048, NULL, 10, NULL
+        heating_task, heating_task, "HeatingTask", NULL, 10, &heating_task_handle
     );
-    xTaskCreate(
+    APP_TASK_CREATE(
         // 创建定时开关机任务
-        power_on_off_task, "PowerOnOffTask", 2048, NULL, 10, NULL
+        power_on_off_task, power_on_off_task, "PowerOnOffTask", NULL, 10, NULL
     );
 }
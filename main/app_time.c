@@ -0,0 +1,400 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_system.h"
+#include "esp_timer.h"
+#endif
+
+#include "app_memory.h"
+#include "app_settings.h"
+#include "app_time.h"
+#include "bsp/towelrack_controller_a1.h"
+
+static const char* TAG = "app_time";
+
+#define TIME_NTP_PACKET_SIZE   48
+#define TIME_NTP_UNIX_OFFSET_S 2208988800LL // 1900-01-01 (NTP纪元) 到 1970-01-01 的秒数
+#define TIME_VALID_AFTER_S     1704067200LL // 2024-01-01, 早于此的时间视为无效
+#define TIME_POLL_MS           10           // 等待服务器响应的轮询间隔
+#define TIME_RESPONSE_MS       2000         // 等待服务器响应的超时
+#define TIME_RETRY_MS          (30 * 1000)  // 同步失败后的重试间隔
+#define TIME_TICK_MS           (10 * 1000)  // 同步与保存检查周期
+#define TIME_SYNC_INTERVAL_US  (CONFIG_APP_TIME_SYNC_INTERVAL_MIN * 60 * 1000000LL)
+#define TIME_SAVE_INTERVAL_US  (CONFIG_APP_TIME_SAVE_INTERVAL_MIN * 60 * 1000000LL)
+#define TIME_DRIFT_SPAN_US     (CONFIG_APP_TIME_DRIFT_MIN_SPAN_MIN * 60 * 1000000LL)
+#define TIME_DRIFT_MAX_PPB     (CONFIG_APP_TIME_DRIFT_MAX_PPM * 1000LL)
+
+static SemaphoreHandle_t time_lock = NULL;
+static TaskHandle_t time_task_handle = NULL;
+static volatile bool time_sync_requested = false; // 命令行请求立即同步
+
+/* 时钟模型, 由 time_lock 保护. UTC = 基点UTC + 单调时钟经过的时间 × (1 - 频率偏差) */
+static struct {
+    app_time_source_t source;
+    int64_t base_mono_us; // 推算基点 (最近一次同步或恢复)
+    int64_t base_utc_us;
+    int32_t drift_ppb;
+    bool drift_valid;
+    bool anchor_valid;      // 频率偏差估计的起点, 跨越 CONFIG_APP_TIME_DRIFT_MIN_SPAN_MIN 后才更新
+    int64_t anchor_mono_us;
+    int64_t anchor_utc_us;
+    uint32_t sync_count;
+    uint32_t sync_failures;
+    int64_t last_sync_mono_us;
+    int64_t last_offset_us;
+    uint32_t last_delay_us;
+} time_clock = {0};
+
+int64_t app_time_monotonic_us(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    /* 仿真板按虚拟时间计时, 与应用层的延时一致 */
+    return (int64_t)BSP_TICKS_TO_MS(xTaskGetTickCount()) * 1000;
+#else
+    return esp_timer_get_time();
+#endif
+}
+
+/**
+ * @brief 按当前频率偏差估计, 从参考点推算单调时刻 mono_us 的UTC时间
+ *
+ * 按毫秒计算修正量, 避免长时间不同步时乘法溢出
+ */
+static int64_t time_project(const int64_t ref_mono_us, const int64_t ref_utc_us, const int32_t drift_ppb,
+                            const int64_t mono_us) {
+    const int64_t elapsed_us = mono_us - ref_mono_us;
+    return ref_utc_us + elapsed_us - elapsed_us / 1000 * drift_ppb / 1000000;
+}
+
+static int64_t time_utc_at_locked(const int64_t mono_us) {
+    return time_project(time_clock.base_mono_us, time_clock.base_utc_us, time_clock.drift_ppb, mono_us);
+}
+
+/**
+ * @brief 用一次同步的结果更新频率偏差估计
+ *
+ * 从估计起点按当前偏差推算到同步时刻, 残差除以间隔即为估计的剩余偏差. 首次估计直接采用,
+ * 之后以 1/2 的系数滤波以抑制网络时延抖动. 偏差超出 CONFIG_APP_TIME_DRIFT_MAX_PPM 时认为
+ * 服务器时间发生了跳变, 只重置估计起点.
+ */
+static void time_update_drift_locked(const int64_t mono_us, const int64_t utc_us) {
+    if (time_clock.anchor_valid) {
+        const int64_t span_us = mono_us - time_clock.anchor_mono_us;
+        if (span_us < TIME_DRIFT_SPAN_US) { return; } // 间隔太短, 残差主要是时延抖动
+
+        const int64_t residual_us =
+            time_project(time_clock.anchor_mono_us, time_clock.anchor_utc_us, time_clock.drift_ppb, mono_us) -
+            utc_us;
+        const int64_t residual_ppb =
+            llabs(residual_us) < span_us / 1000 ? residual_us * 1000000000LL / span_us : TIME_DRIFT_MAX_PPB * 2;
+        const int64_t measured_ppb = time_clock.drift_ppb + residual_ppb;
+
+        if (llabs(measured_ppb) > TIME_DRIFT_MAX_PPB) {
+            ESP_LOGW(TAG, "Server time stepped by %" PRId64 " ms, restarting drift estimation", -residual_us / 1000);
+        } else {
+            time_clock.drift_ppb = (int32_t)(time_clock.drift_valid ? time_clock.drift_ppb + residual_ppb / 2
+                                                                    : measured_ppb);
+            time_clock.drift_valid = true;
+        }
+    }
+
+    time_clock.anchor_valid = true;
+    time_clock.anchor_mono_us = mono_us;
+    time_clock.anchor_utc_us = utc_us;
+}
+
+static uint32_t time_read_be32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+/**
+ * @brief NTP时间戳 (1900年起的秒数与 2^-32 秒的小数) 转为Unix时间 (us)
+ *
+ * 秒数最高位为0时属于2036年之后的第1个NTP纪元
+ */
+static int64_t time_ntp_to_unix_us(const uint8_t* p) {
+    const uint32_t sec = time_read_be32(p);
+    const uint32_t frac = time_read_be32(p + 4);
+    const int64_t era_s = sec < 0x80000000U ? 1LL << 32 : 0;
+    return (era_s + sec - TIME_NTP_UNIX_OFFSET_S) * 1000000 + (int64_t)(((uint64_t)frac * 1000000) >> 32);
+}
+
+/**
+ * @brief 向 CONFIG_APP_TIME_NTP_SERVER:CONFIG_APP_TIME_NTP_PORT 发送一次SNTP请求
+ *
+ * 请求的发送时间戳字段填入单调时钟作为随机数, 服务器原样放入响应的起源时间戳, 用于匹配响应.
+ * 按 RFC 4330 由收发时刻计算往返时延, 认为响应在单程时延后到达:
+ *   UTC(t4) = T3 + ((t4 - t1) - (T3 - T2)) / 2
+ * 套接字以非阻塞方式轮询, 仿真板上阻塞的系统调用会挂起整个调度器.
+ *
+ * @param[out] mono_us 收到响应的单调时刻 t4
+ * @param[out] utc_us 此时的UTC时间
+ * @param[out] delay_us 网络往返时延
+ */
+static esp_err_t time_sntp_query(int64_t* mono_us, int64_t* utc_us, uint32_t* delay_us) {
+    const struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_DGRAM};
+    struct addrinfo* server = NULL;
+    char port[8];
+    snprintf(port, sizeof(port), "%d", CONFIG_APP_TIME_NTP_PORT);
+    if (getaddrinfo(CONFIG_APP_TIME_NTP_SERVER, port, &hints, &server) != 0 || server == NULL) {
+        ESP_LOGW(TAG, "Cannot resolve %s", CONFIG_APP_TIME_NTP_SERVER);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        freeaddrinfo(server);
+        return ESP_FAIL;
+    }
+
+    uint8_t packet[TIME_NTP_PACKET_SIZE] = {0};
+    packet[0] = 0x23; // LI = 0, VN = 4, Mode = 3 (客户端)
+    const int64_t t1 = app_time_monotonic_us();
+    uint8_t nonce[8];
+    for (int i = 0; i < 8; i++) { nonce[i] = (uint8_t)((uint64_t)t1 >> (56 - 8 * i)); }
+    memcpy(&packet[40], nonce, sizeof(nonce));
+
+    esp_err_t ret = ESP_ERR_TIMEOUT;
+    if (sendto(sock, packet, sizeof(packet), 0, server->ai_addr, server->ai_addrlen) < 0) {
+        ESP_LOGW(TAG, "Send to %s failed: errno %d", CONFIG_APP_TIME_NTP_SERVER, errno);
+        ret = ESP_FAIL;
+        goto cleanup;
+    }
+
+    for (int waited_ms = 0; waited_ms < TIME_RESPONSE_MS; waited_ms += TIME_POLL_MS) {
+        const ssize_t len = recvfrom(sock, packet, sizeof(packet), MSG_DONTWAIT, NULL, NULL);
+        const int64_t t4 = app_time_monotonic_us();
+        if (len < 0) {
+            vTaskDelay(BSP_MS_TO_TICKS(TIME_POLL_MS));
+            continue;
+        }
+
+        const uint8_t mode = packet[0] & 0x07;
+        const uint8_t stratum = packet[1];
+        if (len < TIME_NTP_PACKET_SIZE || mode != 4 || memcmp(&packet[24], nonce, sizeof(nonce)) != 0) {
+            continue; // 不是本次请求的响应
+        }
+        if (stratum == 0 || stratum > 15) {
+            ESP_LOGW(TAG, "Server %s unsynchronized (stratum %u)", CONFIG_APP_TIME_NTP_SERVER, stratum);
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+
+        const int64_t t2 = time_ntp_to_unix_us(&packet[32]);
+        const int64_t t3 = time_ntp_to_unix_us(&packet[40]);
+        const int64_t delay = (t4 - t1) - (t3 - t2);
+        *delay_us = delay > 0 ? (uint32_t)delay : 0;
+        *mono_us = t4;
+        *utc_us = t3 + (int64_t)*delay_us / 2;
+        ret = *utc_us >= TIME_VALID_AFTER_S * 1000000 ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+        break;
+    }
+
+cleanup:
+    close(sock);
+    freeaddrinfo(server);
+    return ret;
+}
+
+/**
+ * @brief 同步一次并更新时钟模型
+ */
+static esp_err_t time_sync(void) {
+    int64_t mono_us, utc_us;
+    uint32_t delay_us;
+    const esp_err_t err = time_sntp_query(&mono_us, &utc_us, &delay_us);
+
+    xSemaphoreTake(time_lock, portMAX_DELAY);
+    if (err != ESP_OK) {
+        time_clock.sync_failures++;
+        xSemaphoreGive(time_lock);
+        ESP_LOGW(TAG, "Sync failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const int64_t offset_us = time_clock.source != APP_TIME_SOURCE_NONE ? time_utc_at_locked(mono_us) - utc_us : 0;
+    time_update_drift_locked(mono_us, utc_us);
+    time_clock.source = APP_TIME_SOURCE_SYNCED;
+    time_clock.base_mono_us = mono_us;
+    time_clock.base_utc_us = utc_us;
+    time_clock.sync_count++;
+    time_clock.last_sync_mono_us = mono_us;
+    time_clock.last_offset_us = offset_us;
+    time_clock.last_delay_us = delay_us;
+    const int32_t drift_ppb = time_clock.drift_ppb;
+    xSemaphoreGive(time_lock);
+
+    ESP_LOGI(TAG, "Synced with %s: offset %" PRId64 " us, delay %" PRIu32 " us, drift %" PRId32 " ppb",
+             CONFIG_APP_TIME_NTP_SERVER, offset_us, delay_us, drift_ppb);
+    return ESP_OK;
+}
+
+/**
+ * @brief 保存当前时间与频率偏差估计
+ *
+ * 芯片上同时用修正后的时间校准系统时间, 软件复位后由RTC保持
+ */
+static void time_save(void) {
+    xSemaphoreTake(time_lock, portMAX_DELAY);
+    const app_time_source_t source = time_clock.source;
+    const int64_t utc_us = time_utc_at_locked(app_time_monotonic_us());
+    const int32_t drift_ppb = time_clock.drift_valid ? time_clock.drift_ppb : 0;
+    xSemaphoreGive(time_lock);
+
+    if (source == APP_TIME_SOURCE_NONE) { return; }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    if (source != APP_TIME_SOURCE_SAVED) {
+        const struct timeval tv = {.tv_sec = utc_us / 1000000, .tv_usec = utc_us % 1000000};
+        settimeofday(&tv, NULL);
+    }
+#endif
+
+    settings_set_time(utc_us / 1000000, drift_ppb);
+    if (settings_write_parameter_to_nvs() != ESP_OK) { ESP_LOGE(TAG, "Failed to save time"); }
+}
+
+/**
+ * @brief 启动时恢复时间: 优先使用RTC保持的系统时间, 其次使用NVS中保存的时间
+ */
+static void time_restore(void) {
+    int64_t saved_utc_s;
+    int32_t drift_ppb;
+    const bool saved = settings_get_time(&saved_utc_s, &drift_ppb);
+
+    time_clock.drift_ppb = drift_ppb;
+    time_clock.drift_valid = drift_ppb != 0;
+    time_clock.base_mono_us = app_time_monotonic_us();
+
+#if !CONFIG_IDF_TARGET_LINUX
+    /* 上电与欠压复位时RTC一并复位; 系统时间早于保存的时间说明RTC计时不可信 */
+    const esp_reset_reason_t reason = esp_reset_reason();
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT && tv.tv_sec >= TIME_VALID_AFTER_S &&
+        (!saved || tv.tv_sec >= saved_utc_s)) {
+        time_clock.source = APP_TIME_SOURCE_RETAINED;
+        time_clock.base_utc_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+        ESP_LOGI(TAG, "Time retained across reset: %" PRId64 " s", (int64_t)tv.tv_sec);
+        return;
+    }
+#endif
+
+    if (saved && saved_utc_s >= TIME_VALID_AFTER_S) {
+        time_clock.source = APP_TIME_SOURCE_SAVED;
+        time_clock.base_utc_us = saved_utc_s * 1000000;
+        ESP_LOGI(TAG, "Time restored from flash: %" PRId64 " s or later", saved_utc_s);
+    }
+}
+
+/**
+ * @brief [后台任务]SNTP同步与时间保存
+ *
+ * 启动后立即同步, 之后每 CONFIG_APP_TIME_SYNC_INTERVAL_MIN 分钟同步一次, 失败时每 30 s 重试;
+ * 每次同步成功及每 CONFIG_APP_TIME_SAVE_INTERVAL_MIN 分钟保存一次时间, 限制NVS写入频率.
+ */
+_Noreturn static void time_task(__attribute__((unused)) void* pvParameters) {
+    int64_t next_sync_us = 0;
+    int64_t last_save_us = app_time_monotonic_us();
+
+    while (1) {
+        if (app_time_monotonic_us() >= next_sync_us || time_sync_requested) {
+            time_sync_requested = false;
+            const bool synced = time_sync() == ESP_OK;
+            next_sync_us = app_time_monotonic_us() + (synced ? TIME_SYNC_INTERVAL_US : TIME_RETRY_MS * 1000LL);
+            if (synced) {
+                time_save();
+                last_save_us = app_time_monotonic_us();
+            }
+        }
+
+        if (app_time_monotonic_us() - last_save_us >= TIME_SAVE_INTERVAL_US) {
+            time_save();
+            last_save_us = app_time_monotonic_us();
+        }
+
+        ulTaskNotifyTake(pdTRUE, BSP_MS_TO_TICKS(TIME_TICK_MS));
+    }
+}
+
+APP_TASK_STORAGE(time_task, 4096);
+APP_MUTEX_STORAGE(time_lock);
+
+void app_time_init(void) {
+    time_lock = APP_MUTEX_CREATE(time_lock);
+
+    setenv("TZ", CONFIG_APP_TIME_TZ, 1);
+    tzset();
+    time_restore();
+
+    APP_TASK_CREATE(
+        // 创建SNTP同步任务
+        time_task, time_task, "TimeSync", NULL, 3, &time_task_handle
+    );
+}
+
+bool app_time_get_utc(int64_t* utc_us) {
+    xSemaphoreTake(time_lock, portMAX_DELAY);
+    const app_time_source_t source = time_clock.source;
+    *utc_us = source != APP_TIME_SOURCE_NONE ? time_utc_at_locked(app_time_monotonic_us()) : 0;
+    xSemaphoreGive(time_lock);
+
+    return source >= APP_TIME_SOURCE_RETAINED;
+}
+
+/**
+ * @brief 公历日期到1970-01-01的天数
+ */
+static int64_t time_days_from_civil(int year, const int month, const int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + doe - 719468;
+}
+
+int32_t app_time_to_local(const int64_t utc_s, struct tm* local) {
+    const time_t t = (time_t)utc_s;
+    localtime_r(&t, local);
+
+    /* 把本地日历时间当作UTC换算回秒数, 与原时间之差即为时区与夏令时偏移 */
+    const int64_t local_s =
+        time_days_from_civil(local->tm_year + 1900, local->tm_mon + 1, local->tm_mday) * 86400 +
+        local->tm_hour * 3600 + local->tm_min * 60 + local->tm_sec;
+    return (int32_t)(local_s - utc_s);
+}
+
+void app_time_sync_now(void) {
+    time_sync_requested = true;
+    xTaskNotifyGive(time_task_handle);
+}
+
+void app_time_get_status(app_time_status_t* status) {
+    const int64_t now_us = app_time_monotonic_us();
+
+    xSemaphoreTake(time_lock, portMAX_DELAY);
+    *status = (app_time_status_t){
+        .source = time_clock.source,
+        .utc_us = time_clock.source != APP_TIME_SOURCE_NONE ? time_utc_at_locked(now_us) : 0,
+        .drift_ppb = time_clock.drift_ppb,
+        .drift_valid = time_clock.drift_valid,
+        .sync_count = time_clock.sync_count,
+        .sync_failures = time_clock.sync_failures,
+        .last_sync_age_us = time_clock.sync_count > 0 ? now_us - time_clock.last_sync_mono_us : -1,
+        .last_offset_us = time_clock.last_offset_us,
+        .last_delay_us = time_clock.last_delay_us,
+    };
+    xSemaphoreGive(time_lock);
+}
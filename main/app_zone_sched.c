@@ -0,0 +1,52 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "app_zone_sched.h"
+
+/* 调度状态, 只在加热控制任务中访问 */
+static struct {
+    int next;                // 下一轮最先打开的通道, 每轮后移一位
+    int last_channel;        // 最近一次打开的通道, 尚未打开过时为 -1
+    TickType_t last_on_tick; // 最近一次打开的时刻
+} zone_sched = {
+    .next = 0,
+    .last_channel = -1,
+};
+
+/**
+ * @brief 距其他通道上次打开不足错开间隔时等待
+ */
+static void zone_sched_wait_stagger(const int channel) {
+    if (CONFIG_APP_ZONE_STAGGER_MS == 0 || zone_sched.last_channel < 0 || zone_sched.last_channel == channel) {
+        return;
+    }
+
+    const TickType_t stagger = BSP_MS_TO_TICKS(CONFIG_APP_ZONE_STAGGER_MS);
+    const TickType_t elapsed = xTaskGetTickCount() - zone_sched.last_on_tick;
+    if (elapsed < stagger) { vTaskDelay(stagger - elapsed); }
+}
+
+void app_zone_sched_apply(const bool request[BSP_HEATING_CHANNEL_NUM]) {
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        if (!request[ch]) { bsp_heating_channel_disable(ch); }
+    }
+
+    const int first = zone_sched.next;
+    bool switched_on = false;
+    for (int i = 0; i < BSP_HEATING_CHANNEL_NUM; i++) {
+        const int ch = (first + i) % BSP_HEATING_CHANNEL_NUM;
+        if (!request[ch] || bsp_heating_channel_is_enabled(ch)) { continue; }
+
+        zone_sched_wait_stagger(ch);
+        bsp_heating_channel_enable(ch);
+        zone_sched.last_channel = ch;
+        zone_sched.last_on_tick = xTaskGetTickCount();
+        switched_on = true;
+    }
+
+    if (switched_on) { zone_sched.next = (first + 1) % BSP_HEATING_CHANNEL_NUM; }
+}
+
+void app_zone_sched_all_off(void) {
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { bsp_heating_channel_disable(ch); }
+}
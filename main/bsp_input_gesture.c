@@ -0,0 +1,185 @@
+#include "bsp/input_gesture.h"
+
+#define KNOB    BSP_GESTURE_KEY_BIT(BSP_GESTURE_KEY_KNOB)
+#define TOUCH_L BSP_GESTURE_KEY_BIT(BSP_GESTURE_KEY_TOUCH_L)
+#define TOUCH_R BSP_GESTURE_KEY_BIT(BSP_GESTURE_KEY_TOUCH_R)
+
+/**************************************************************************************************
+ * Gesture Table
+ *
+ * 新增手势只需在此添加表项, 没有触摸按键的版本中相关表项不会被触发
+ **************************************************************************************************/
+
+const bsp_gesture_t bsp_gesture_table[] = {
+    {.kind = BSP_GESTURE_ROTATE, .keys = 0, .direction = -1, .event = BSP_KNOB_ENCODER_ACW},
+    {.kind = BSP_GESTURE_ROTATE, .keys = 0, .direction = 1, .event = BSP_KNOB_ENCODER_CW},
+    {.kind = BSP_GESTURE_ROTATE, .keys = KNOB, .direction = -1, .event = BSP_KNOB_HOLD_ENCODER_ACW},
+    {.kind = BSP_GESTURE_ROTATE, .keys = KNOB, .direction = 1, .event = BSP_KNOB_HOLD_ENCODER_CW},
+    {.kind = BSP_GESTURE_HOLD, .keys = KNOB, .time_ms = CONFIG_BSP_GESTURE_HOLD_MS, .event = BSP_KNOB_LONG_PRESS},
+    {.kind = BSP_GESTURE_CLICK, .keys = KNOB, .clicks = 8, .event = BSP_KNOB_MT8_CLICK},
+    {.kind = BSP_GESTURE_CLICK, .keys = TOUCH_L, .clicks = 1, .event = BSP_TOUCH_BUTTON_L_CLICK},
+    {.kind = BSP_GESTURE_CLICK, .keys = TOUCH_R, .clicks = 1, .event = BSP_TOUCH_BUTTON_R_CLICK},
+    {
+        .kind = BSP_GESTURE_CHORD,
+        .keys = TOUCH_L | TOUCH_R,
+        .time_ms = CONFIG_BSP_GESTURE_CHORD_WINDOW_MS,
+        .event = BSP_TOUCH_BUTTON_LR_CHORD,
+    },
+};
+
+const int bsp_gesture_table_len = sizeof(bsp_gesture_table) / sizeof(bsp_gesture_table[0]);
+
+/**************************************************************************************************
+ * Recognizer
+ **************************************************************************************************/
+
+/* 一次输入的输出缓冲 */
+typedef struct {
+    bsp_input_event_t* events;
+    int count;
+    int max;
+} gesture_out_t;
+
+static void gesture_emit(gesture_out_t* out, const bsp_input_event_t event) {
+    if (out->count < out->max) { out->events[out->count++] = event; }
+}
+
+/**
+ * @brief keys 中最后一个按键按下的时刻, 时间允许回绕
+ */
+static uint32_t gesture_last_press(const bsp_gesture_engine_t* engine, const uint8_t keys) {
+    bool found = false;
+    uint32_t last = 0;
+    for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+        if (!(keys & BSP_GESTURE_KEY_BIT(k))) { continue; }
+        if (!found || (int32_t)(engine->press_ms[k] - last) > 0) { last = engine->press_ms[k]; }
+        found = true;
+    }
+    return last;
+}
+
+/**
+ * @brief HOLD 表项是否在等待到期: 按键全部按下且都未参与其他手势
+ */
+static bool gesture_hold_armed(const bsp_gesture_engine_t* engine, const bsp_gesture_t* g) {
+    return g->kind == BSP_GESTURE_HOLD && (engine->held & g->keys) == g->keys && !(engine->consumed & g->keys);
+}
+
+/**
+ * @brief 结算到 now_ms 为止到期的长按
+ */
+static void gesture_check_holds(bsp_gesture_engine_t* engine, const uint32_t now_ms, gesture_out_t* out) {
+    for (int i = 0; i < engine->table_len; i++) {
+        const bsp_gesture_t* g = &engine->table[i];
+        if (!gesture_hold_armed(engine, g)) { continue; }
+        if (now_ms - gesture_last_press(engine, g->keys) >= g->time_ms) {
+            engine->consumed |= g->keys;
+            gesture_emit(out, g->event);
+        }
+    }
+}
+
+static void gesture_on_press(bsp_gesture_engine_t* engine, const bsp_gesture_key_t key, const uint32_t now_ms,
+                             gesture_out_t* out) {
+    const uint8_t bit = BSP_GESTURE_KEY_BIT(key);
+    if (engine->held & bit) { return; } // 重复的按下
+
+    engine->held |= bit;
+    if (now_ms - engine->release_ms[key] > CONFIG_BSP_GESTURE_CLICK_GAP_MS) { engine->clicks[key] = 0; }
+    engine->press_ms[key] = now_ms;
+
+    /* 本按键是最后按下的, 其他按键按下的时刻都在时间窗内即构成组合键 */
+    for (int i = 0; i < engine->table_len; i++) {
+        const bsp_gesture_t* g = &engine->table[i];
+        if (g->kind != BSP_GESTURE_CHORD || !(g->keys & bit) || (engine->held & g->keys) != g->keys ||
+            (engine->consumed & g->keys)) {
+            continue;
+        }
+
+        bool within = true;
+        for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+            if ((g->keys & BSP_GESTURE_KEY_BIT(k)) && now_ms - engine->press_ms[k] > g->time_ms) { within = false; }
+        }
+        if (within) {
+            engine->consumed |= g->keys;
+            gesture_emit(out, g->event);
+        }
+    }
+}
+
+static void gesture_on_release(bsp_gesture_engine_t* engine, const bsp_gesture_key_t key, const uint32_t now_ms,
+                               gesture_out_t* out) {
+    const uint8_t bit = BSP_GESTURE_KEY_BIT(key);
+    if (!(engine->held & bit)) { return; }
+
+    engine->held &= ~bit;
+    if (engine->consumed & bit) {
+        engine->consumed &= ~bit;
+        engine->clicks[key] = 0;
+        return;
+    }
+    if (now_ms - engine->press_ms[key] >= CONFIG_BSP_GESTURE_HOLD_MS) {
+        engine->clicks[key] = 0;
+        return;
+    }
+
+    if (engine->clicks[key] < UINT8_MAX) { engine->clicks[key]++; }
+    engine->release_ms[key] = now_ms;
+
+    for (int i = 0; i < engine->table_len; i++) {
+        const bsp_gesture_t* g = &engine->table[i];
+        if (g->kind == BSP_GESTURE_CLICK && g->keys == bit && g->clicks == engine->clicks[key]) {
+            gesture_emit(out, g->event);
+        }
+    }
+}
+
+static void gesture_on_detent(bsp_gesture_engine_t* engine, const int8_t direction, gesture_out_t* out) {
+    for (int i = 0; i < engine->table_len; i++) {
+        const bsp_gesture_t* g = &engine->table[i];
+        if (g->kind == BSP_GESTURE_ROTATE && g->direction == direction && g->keys == engine->held) {
+            engine->consumed |= g->keys;
+            gesture_emit(out, g->event);
+        }
+    }
+}
+
+void bsp_gesture_init(bsp_gesture_engine_t* engine, const bsp_gesture_t* table, const int table_len) {
+    *engine = (bsp_gesture_engine_t){.table = table, .table_len = table_len};
+}
+
+int bsp_gesture_feed(bsp_gesture_engine_t* engine, const bsp_gesture_raw_t* raw, bsp_input_event_t* out,
+                     const int out_max) {
+    gesture_out_t result = {.events = out, .max = out_max};
+
+    /* 先结算本事件之前到期的长按, 到期定时器迟到时顺序仍然正确 */
+    gesture_check_holds(engine, raw->time_ms, &result);
+
+    switch (raw->type) {
+        case BSP_GESTURE_RAW_PRESS:
+            gesture_on_press(engine, raw->key, raw->time_ms, &result);
+            break;
+        case BSP_GESTURE_RAW_RELEASE:
+            gesture_on_release(engine, raw->key, raw->time_ms, &result);
+            break;
+        case BSP_GESTURE_RAW_DETENT:
+            gesture_on_detent(engine, raw->direction, &result);
+            break;
+        case BSP_GESTURE_RAW_TICK:
+            break;
+    }
+    return result.count;
+}
+
+bool bsp_gesture_next_deadline(const bsp_gesture_engine_t* engine, uint32_t* deadline_ms) {
+    bool found = false;
+    for (int i = 0; i < engine->table_len; i++) {
+        const bsp_gesture_t* g = &engine->table[i];
+        if (!gesture_hold_armed(engine, g)) { continue; }
+
+        const uint32_t deadline = gesture_last_press(engine, g->keys) + g->time_ms;
+        if (!found || (int32_t)(deadline - *deadline_ms) < 0) { *deadline_ms = deadline; }
+        found = true;
+    }
+    return found;
+}
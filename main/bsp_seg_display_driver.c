@@ -4,27 +4,48 @@
 #include "driver/gpio.h"
 #include "driver/gptimer.h"
 #include "freertos/FreeRTOS.h"
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+#include "driver/dedic_gpio.h"
+#include "esp_log.h"
+#include "hal/dedic_gpio_cpu_ll.h"
+#endif
 
 #include "ic_74hc595_driver.h"
 
 #include "bsp/seg_display_driver.h"
 
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+static const char* TAG = "seg-display";
+#endif
+
 typedef struct {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    dedic_gpio_bundle_handle_t bundle; // DS/SHCP/STCP/U1/U2 组成的专用GPIO组
+    uint32_t bundle_offset;            // 组内第一个引脚在CPU专用GPIO输出中的位号
+    bool lsb_first;                    // 低位先移出, 与 ic_74hc595_driver 一致, 见 dedic_probe_lsb_first
+#else
     ic_74hc595_handle_t ic_74_hc595_handle;
+#endif
     gpio_num_t u1_ctrl;
     gpio_num_t u2_ctrl;
 
     uint8_t max_lens; // 数码管最大显示字符数
 
     bool status;     // 显示是否开启
+    bool held;       // 刷新定时器是否被基准测试暂停
     bool c_flag;     // 是否显示C标志
     bool h_flag;     // 是否显示H标志
     char* content;   // 显示内容
     uint8_t* buffer; // 显示缓冲区
 
     gptimer_handle_t gptimer; // LED数码管刷新定时器句柄
+
+    display_quiet_hook_t quiet_hook; // 静默窗口回调
+    void* quiet_arg;
 } display_driver_dev_t;
 
+_Static_assert(sizeof(display_driver_dev_t) <= sizeof(((display_storage_t*)0)->dev), "display_storage_t too small");
+
 /**
 * @brief 获取字符对应的数码管段亮灯配置
  *
@@ -50,26 +71,149 @@ static uint8_t display_get_segment_pattern(const char character) {
     }
 }
 
+/**************************************************************************************************
+ * Shift Register Backend
+ *
+ * 74HC595与位选引脚的输出方式由 CONFIG_DISPLAY_SHIFT_* 选择:
+ *   GPIO:       经 ic_74hc595_driver 逐位调用 gpio_set_level;
+ *   DEDIC_GPIO: 全部引脚组成专用GPIO组, 每次电平变化为一次CPU寄存器写入, 刷新中断中不调用任何驱动.
+ **************************************************************************************************/
+
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+
+/* 专用GPIO组内的引脚顺序 */
+enum { DEDIC_DS, DEDIC_SHCP, DEDIC_STCP, DEDIC_U1, DEDIC_U2, DEDIC_PIN_NUM };
+
+#define DEDIC_BIT(dev, pin) (1UL << ((dev)->bundle_offset + (pin)))
+
+/* 每个时钟相位的最小CPU周期数 */
+#define DEDIC_PHASE_CYCLES (CONFIG_DISPLAY_DEDIC_GPIO_SETUP_NS * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 1000)
+
+/**
+ * @brief 写出专用GPIO电平并保持一个时钟相位
+ */
+static inline void dedic_write(const uint32_t mask, const uint32_t value) {
+    dedic_gpio_cpu_ll_write_mask(mask, value);
+
+    for (int i = 0; i < DEDIC_PHASE_CYCLES; i++) { __asm__ __volatile__("nop"); }
+}
+
+/**
+ * @brief 探测 ic_74hc595_driver 的移位顺序
+ *
+ * 段码表 (display_get_segment_pattern) 按GPIO后端的输出接线, 专用GPIO组必须按同样的顺序移位.
+ * 驱动移位结束后DS保持最后一位: 写入0x01后为1且写入0xFE后为0为高位先出, 相反为低位先出.
+ * 驱动结束时改写DS而无法判断时按高位先出处理并告警. 探测在创建专用GPIO组之前进行, 驱动句柄之后不再使用.
+ */
+static bool dedic_probe_lsb_first(const display_config_t* config) {
+    const ic_74hc595_config_t ic_config = {
+        .ds = config->ds,
+        .shcp = config->shcp,
+        .stcp = config->stcp,
+        .oe_ = GPIO_NUM_NC,
+        .mr_ = GPIO_NUM_NC,
+    };
+    ic_74hc595_handle_t ic;
+    ESP_ERROR_CHECK(ic_74hc595_init(&ic_config, &ic));
+    ESP_ERROR_CHECK(gpio_set_direction(config->ds, GPIO_MODE_INPUT_OUTPUT));
+
+    ic_74hc595_write(ic, 0x01);
+    const int last_of_01 = gpio_get_level(config->ds);
+    ic_74hc595_write(ic, 0xFE);
+    const int last_of_fe = gpio_get_level(config->ds);
+
+    if (last_of_01 == last_of_fe) {
+        ESP_LOGW(TAG, "Cannot probe the 74HC595 driver bit order (DS %d/%d), shifting MSB first", last_of_01,
+                 last_of_fe);
+        return false;
+    }
+    ESP_LOGI(TAG, "74HC595 driver shifts %s first", last_of_01 ? "MSB" : "LSB");
+    return last_of_01 == 0;
+}
+
+#endif
+
+/**
+ * @brief 向74HC595移入一个字节, 不锁存
+ */
+static inline void display_shift_write(const display_driver_dev_t* dev, const uint8_t data) {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    const uint32_t ds = DEDIC_BIT(dev, DEDIC_DS);
+    const uint32_t shcp = DEDIC_BIT(dev, DEDIC_SHCP);
+
+    for (int i = 0; i < 8; i++) {
+        const int bit = dev->lsb_first ? i : 7 - i;
+        dedic_write(ds | shcp, data >> bit & 1 ? ds : 0); // SHCP拉低的同时送出数据
+        dedic_write(shcp, shcp);                          // 上升沿移入
+    }
+#else
+    ic_74hc595_write(dev->ic_74_hc595_handle, data);
+#endif
+}
+
+/**
+ * @brief 将移位寄存器锁存到并行输出
+ */
+static inline void display_shift_latch(const display_driver_dev_t* dev) {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    const uint32_t stcp = DEDIC_BIT(dev, DEDIC_STCP);
+
+    dedic_write(stcp, stcp);
+    dedic_write(stcp, 0);
+#else
+    ic_74hc595_latch(dev->ic_74_hc595_handle);
+#endif
+}
+
+/**
+ * @brief 清空74HC595的并行输出
+ */
+static void display_shift_reset(const display_driver_dev_t* dev) {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    display_shift_write(dev, 0);
+    display_shift_latch(dev);
+#else
+    ic_74hc595_reset(dev->ic_74_hc595_handle);
+#endif
+}
+
+/**************************************************************************************************
+ * Display
+ **************************************************************************************************/
+
 /**
  * @brief 关闭所有数码管显示
  */
 static void display_disable_output(const display_driver_dev_t* dev) {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    const uint32_t mask = DEDIC_BIT(dev, DEDIC_U1) | DEDIC_BIT(dev, DEDIC_U2);
+    dedic_gpio_cpu_ll_write_mask(mask, mask);
+#else
     gpio_set_level(dev->u1_ctrl, 1);
     gpio_set_level(dev->u2_ctrl, 1);
+#endif
 }
 
 /**
  * @brief 打开1号数码管显示
  */
 static void display_enable_u1(const display_driver_dev_t* dev) {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    dedic_gpio_cpu_ll_write_mask(DEDIC_BIT(dev, DEDIC_U1), 0);
+#else
     gpio_set_level(dev->u1_ctrl, 0);
+#endif
 }
 
 /**
  * @brief 打开2号数码管
  */
 static void display_enable_u2(const display_driver_dev_t* dev) {
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    dedic_gpio_cpu_ll_write_mask(DEDIC_BIT(dev, DEDIC_U2), 0);
+#else
     gpio_set_level(dev->u2_ctrl, 0);
+#endif
 }
 
 /**
@@ -97,11 +241,11 @@ static void display_clear_all(display_driver_dev_t* dev) {
     memset(dev->buffer, 0, sizeof(uint8_t) * dev->max_lens);
 
     /* 2. 清空74HC595 */
-    ic_74hc595_reset(dev->ic_74_hc595_handle);
+    display_shift_reset(dev);
 }
 
 static void display_pause(display_driver_dev_t* dev) {
-    if (dev->status) { ESP_ERROR_CHECK(gptimer_stop(dev->gptimer)); }
+    if (dev->status && !dev->held) { ESP_ERROR_CHECK(gptimer_stop(dev->gptimer)); }
 
     display_disable_output(dev);
     display_clear_all(dev);
@@ -112,11 +256,37 @@ static void display_pause(display_driver_dev_t* dev) {
 static void display_resume(display_driver_dev_t* dev) {
     if (dev->status) return;
 
-    ESP_ERROR_CHECK(gptimer_start(dev->gptimer));
+    if (!dev->held) { ESP_ERROR_CHECK(gptimer_start(dev->gptimer)); }
 
     dev->status = true;
 }
 
+/**
+ * @brief 利用显示缓冲区刷新一位数码管
+ *
+ * @param quiet 是否在静默窗口调用回调, 只有刷新定时器中断可以调用
+ * @return 静默窗口回调是否唤醒了更高优先级的任务
+ */
+static bool IRAM_ATTR display_refresh_digit(const display_driver_dev_t* dev, const bool quiet) {
+    static int current_digit;
+
+    if (current_digit >= dev->max_lens) { current_digit = 0; }
+
+    display_shift_write(dev, dev->buffer[current_digit]);
+    display_disable_output(dev);
+    display_shift_latch(dev);
+
+    /* 两位均熄灭且段码已稳定: 静默窗口 */
+    const display_quiet_hook_t hook = quiet ? dev->quiet_hook : NULL;
+    const bool woken = hook != NULL && hook(dev->quiet_arg);
+
+    current_digit == 0 ? display_enable_u1(dev) : display_enable_u2(dev);
+
+    current_digit++;
+
+    return woken;
+}
+
 /**
  * @brief (数码管刷新定时器回调函数) 利用显示缓冲区刷新数码管
  */
@@ -124,20 +294,31 @@ static void display_resume(display_driver_dev_t* dev) {
 static bool IRAM_ATTR display_refresh_timer_cb(
     gptimer_handle_t timer, const gptimer_alarm_event_data_t* event, void* user_data
 ) {
-    static int current_digit;
+    return display_refresh_digit(user_data, true);
+}
 
-    const display_driver_dev_t* dev = (display_driver_dev_t*)user_data;
+void display_refresh(const display_device_handle_t handle) { display_refresh_digit(handle, false); }
 
-    if (current_digit >= dev->max_lens) { current_digit = 0; }
+void display_hold_refresh(const display_device_handle_t handle, const bool hold) {
+    display_driver_dev_t* dev = handle;
 
-    ic_74hc595_write(dev->ic_74_hc595_handle, dev->buffer[current_digit]);
-    display_disable_output(dev);
-    ic_74hc595_latch(dev->ic_74_hc595_handle);
-    current_digit == 0 ? display_enable_u1(dev) : display_enable_u2(dev);
+    if (hold == dev->held) return;
+    if (dev->status) { ESP_ERROR_CHECK(hold ? gptimer_stop(dev->gptimer) : gptimer_start(dev->gptimer)); }
+    dev->held = hold;
+}
 
-    current_digit++;
+void display_set_quiet_hook(const display_device_handle_t handle, const display_quiet_hook_t hook, void* arg) {
+    display_driver_dev_t* dev = handle;
 
-    return pdFALSE;
+    /* 先清除回调再更新参数, 中断不会以新参数调用旧回调 */
+    dev->quiet_hook = NULL;
+    dev->quiet_arg = arg;
+    dev->quiet_hook = hook;
+}
+
+bool display_is_refreshing(const display_device_handle_t handle) {
+    const display_driver_dev_t* dev = handle;
+    return dev->status;
 }
 
 void display_write_str(const display_device_handle_t handle, const char* str) {
@@ -186,20 +367,41 @@ void display_enable_all(const display_device_handle_t handle) {
 
     if (dev->status) display_pause(dev);
 
-    ic_74hc595_write(dev->ic_74_hc595_handle, 0xFF);
-    ic_74hc595_latch(dev->ic_74_hc595_handle);
+    display_shift_write(dev, 0xFF);
+    display_shift_latch(dev);
     display_enable_u1(dev);
     display_enable_u2(dev);
 }
 
-void display_init(const display_config_t* config, display_device_handle_t* handle) {
-    *handle = NULL;
-
-    if (config == NULL) return;
-
-    display_driver_dev_t* dev = malloc(sizeof(display_driver_dev_t));
-    if (dev == NULL) return;
-
+/**
+ * @brief 初始化已分配好存储的数码管设备
+ */
+static void display_setup(display_driver_dev_t* dev, const display_config_t* config) {
+    dev->u1_ctrl = config->u1_ctrl;
+    dev->u2_ctrl = config->u2_ctrl;
+    dev->max_lens = config->max_lens;
+    dev->gptimer = NULL;
+    dev->quiet_hook = NULL;
+    dev->quiet_arg = NULL;
+
+#if CONFIG_DISPLAY_SHIFT_DEDIC_GPIO
+    // 74HC595与位选引脚组成专用GPIO组, 由CPU直接输出
+    const int bundle_gpios[DEDIC_PIN_NUM] = {
+        [DEDIC_DS] = config->ds,
+        [DEDIC_SHCP] = config->shcp,
+        [DEDIC_STCP] = config->stcp,
+        [DEDIC_U1] = config->u1_ctrl,
+        [DEDIC_U2] = config->u2_ctrl,
+    };
+    const dedic_gpio_bundle_config_t bundle_config = {
+        .gpio_array = bundle_gpios,
+        .array_size = DEDIC_PIN_NUM,
+        .flags.out_en = 1,
+    };
+    dev->lsb_first = dedic_probe_lsb_first(config);
+    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&bundle_config, &dev->bundle));
+    ESP_ERROR_CHECK(dedic_gpio_get_out_offset(dev->bundle, &dev->bundle_offset));
+#else
     const ic_74hc595_config_t ic_config = {
         .ds = config->ds,
         .shcp = config->shcp,
@@ -209,13 +411,6 @@ void display_init(const display_config_t* config, display_device_handle_t* handl
     };
     ESP_ERROR_CHECK(ic_74hc595_init(&ic_config, &dev->ic_74_hc595_handle));
 
-    dev->u1_ctrl = config->u1_ctrl;
-    dev->u2_ctrl = config->u2_ctrl;
-    dev->max_lens = config->max_lens;
-    dev->content = malloc(sizeof(char) * (config->max_lens + 1));
-    dev->buffer = malloc(sizeof(uint8_t) * config->max_lens);
-    dev->gptimer = NULL;
-
     // 初始化GPIO引脚
     const gpio_config_t io_config = {
         .intr_type = GPIO_INTR_DISABLE,
@@ -225,11 +420,13 @@ void display_init(const display_config_t* config, display_device_handle_t* handl
         .pull_up_en = GPIO_PULLUP_DISABLE,
     };
     gpio_config(&io_config);
+#endif
 
     // 初始化全局变量与74HC595
     display_disable_output(dev);
     display_clear_all(dev);
     dev->status = false;
+    dev->held = false;
 
     // 初始化数码管刷新定时器
     const gptimer_config_t gptimer_config = {
@@ -250,6 +447,38 @@ void display_init(const display_config_t* config, display_device_handle_t* handl
     ESP_ERROR_CHECK(gptimer_register_event_callbacks(dev->gptimer, &gptimer_callbacks, dev));
     ESP_ERROR_CHECK(gptimer_enable(dev->gptimer));
     ESP_ERROR_CHECK(gptimer_set_alarm_action(dev->gptimer, &alarm_config));
+}
+
+void display_init(const display_config_t* config, display_device_handle_t* handle) {
+    *handle = NULL;
+
+    if (config == NULL) return;
+
+    display_driver_dev_t* dev = malloc(sizeof(display_driver_dev_t));
+    if (dev == NULL) return;
+
+    dev->content = malloc(sizeof(char) * (config->max_lens + 1));
+    dev->buffer = malloc(sizeof(uint8_t) * config->max_lens);
+    if (dev->content == NULL || dev->buffer == NULL) {
+        free(dev->content);
+        free(dev->buffer);
+        free(dev);
+        return;
+    }
+
+    display_setup(dev, config);
+    *handle = dev;
+}
+
+void display_init_static(const display_config_t* config, display_storage_t* storage, display_device_handle_t* handle) {
+    *handle = NULL;
+
+    if (config == NULL || storage == NULL || config->max_lens > DISPLAY_STATIC_MAX_LENS) return;
+
+    display_driver_dev_t* dev = (display_driver_dev_t*)storage->dev;
+    dev->content = storage->content;
+    dev->buffer = storage->buffer;
 
+    display_setup(dev, config);
     *handle = dev;
 }
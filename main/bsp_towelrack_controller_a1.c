@@ -1,8 +1,22 @@
+#include <math.h>
+
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#endif
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#if CONFIG_BSP_INPUT_POLLING
 #include "iot_button.h"
 #include "iot_knob.h"
+#endif
 #include "led_strip.h"
 #include "ntc_driver.h"
 
+#include "app_memory.h"
+#include "bsp/input_gesture.h"
 #include "bsp/seg_display_driver.h"
 #include "bsp/towelrack_controller_a1.h"
 
@@ -12,25 +26,29 @@ static const char* TAG = "towelrack-controller-a1";
  * Config // 74HC595 IC & 7-Segment Display
  **************************************************************************************************/
 
+_Static_assert(BSP_BOARD_DISPLAY_DIGITS <= DISPLAY_STATIC_MAX_LENS, "Too many digits for display_storage_t");
+
 const display_config_t bsp_display_config = {
-    .ds = BSP_P_74HC595_DS,
-    .shcp = BSP_P_74HC595_SHCP,
-    .stcp = BSP_P_74HC595_STCP,
-    .u1_ctrl = BSP_P_DISP_S1_SW,
-    .u2_ctrl = BSP_P_DISP_S2_SW,
-    .max_lens = 2,
+    .ds = BSP_BOARD_PIN(74HC595_DS),
+    .shcp = BSP_BOARD_PIN(74HC595_SHCP),
+    .stcp = BSP_BOARD_PIN(74HC595_STCP),
+    .u1_ctrl = BSP_BOARD_PIN(DISP_S1_SW),
+    .u2_ctrl = BSP_BOARD_PIN(DISP_S2_SW),
+    .max_lens = BSP_BOARD_DISPLAY_DIGITS,
 };
 
 /**************************************************************************************************
  * Config // Input Devices
  **************************************************************************************************/
 
+#if CONFIG_BSP_INPUT_POLLING
+
 static const button_config_t config_touch_button_left = {
     .type = BUTTON_TYPE_GPIO,
     .short_press_time = CONFIG_BUTTON_SHORT_PRESS_TIME_MS,
     .gpio_button_config =
     {
-        .gpio_num = BSP_P_TOUCH_BUTTON_L,
+        .gpio_num = BSP_BOARD_PIN(TOUCH_BUTTON_L),
         .active_level = 1,
     },
 };
@@ -40,15 +58,15 @@ static const button_config_t config_touch_button_right = {
     .short_press_time = CONFIG_BUTTON_SHORT_PRESS_TIME_MS,
     .gpio_button_config =
     {
-        .gpio_num = BSP_P_TOUCH_BUTTON_R,
+        .gpio_num = BSP_BOARD_PIN(TOUCH_BUTTON_R),
         .active_level = 1,
     },
 };
 
 static const knob_config_t config_knob_encoder_a_b = {
     .default_direction = 0,
-    .gpio_encoder_a = BSP_P_KNOB_ENCODER_A,
-    .gpio_encoder_b = BSP_P_KNOB_ENCODER_B,
+    .gpio_encoder_a = BSP_BOARD_PIN(KNOB_ENCODER_A),
+    .gpio_encoder_b = BSP_BOARD_PIN(KNOB_ENCODER_B),
 };
 
 static const button_config_t config_knob_btn = {
@@ -57,20 +75,32 @@ static const button_config_t config_knob_btn = {
     .short_press_time = CONFIG_BUTTON_SHORT_PRESS_TIME_MS,
     .gpio_button_config =
     {
-        .gpio_num = BSP_P_KNOB_BUTTON,
+        .gpio_num = BSP_BOARD_PIN(KNOB_BUTTON),
         .active_level = 0,
     },
 };
 
+#else
+
+/* 按键引脚与有效电平, 有效电平为低时启用上拉, 为高时启用下拉 */
+static const struct {
+    gpio_num_t pin;
+    int active_level;
+} bsp_input_button_config[BSP_GESTURE_KEY_NUM] = {
+    [BSP_GESTURE_KEY_KNOB] = {.pin = BSP_BOARD_PIN(KNOB_BUTTON), .active_level = 0},
+    [BSP_GESTURE_KEY_TOUCH_L] = {.pin = BSP_BOARD_PIN(TOUCH_BUTTON_L), .active_level = 1},
+    [BSP_GESTURE_KEY_TOUCH_R] = {.pin = BSP_BOARD_PIN(TOUCH_BUTTON_R), .active_level = 1},
+};
+
+#endif
+
 /**************************************************************************************************
  * Config // LED Strip
  **************************************************************************************************/
 
-#define BSP_LED_STRIP_NUM 4
-
 const led_strip_config_t strip_config = {
-    .strip_gpio_num = BSP_P_LED_STRIP,
-    .max_leds = BSP_LED_STRIP_NUM,
+    .strip_gpio_num = BSP_BOARD_PIN(LED_STRIP),
+    .max_leds = BSP_BOARD_LED_STRIP_NUM,
     .led_model = LED_MODEL_SK6812,
     .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
     .flags.invert_out = false,
@@ -86,23 +116,27 @@ const led_strip_rmt_config_t rmt_config = {
  * Config // NTC Temperature Sensor + Heating Control
  **************************************************************************************************/
 
+typedef struct {
+    gpio_num_t heater_pin;  // 加热器控制引脚
+    adc_channel_t ntc_chan; // NTC分压点所接ADC通道
+} heating_channel_config_t;
+
+#define HEATING_CHANNEL_CONFIG_ENTRY(pin, chan) {.heater_pin = (pin), .ntc_chan = (adc_channel_t)(chan)},
+
+static const heating_channel_config_t heating_channel_config[BSP_HEATING_CHANNEL_NUM] = {
+    BSP_BOARD_HEATING_CHANNELS(HEATING_CHANNEL_CONFIG_ENTRY)
+};
+
+/* ntc_driver 只用于创建通道0的ADC单元, 温度换算由 ntc_read_temp_locked 完成 */
 static ntc_config_t ntc_config = {
-    .b_value = 3950,
-    .r25_ohm = 10000,
-    .fixed_ohm = 10000,
-    .vdd_mv = 3300,
+    .b_value = BSP_BOARD_NTC_B_VALUE,
+    .r25_ohm = BSP_BOARD_NTC_R25_OHM,
+    .fixed_ohm = BSP_BOARD_NTC_FIXED_OHM,
+    .vdd_mv = BSP_BOARD_NTC_VDD_MV,
     .circuit_mode = CIRCUIT_MODE_NTC_GND,
     .atten = ADC_ATTEN_DB_12,
-    .channel = BSP_P_NTC_ADC_CHANNEL,
-    .unit = BSP_P_NTC_ADC_UNIT,
-};
-
-static gpio_config_t heating_ctrl_config = {
-    .intr_type = GPIO_INTR_DISABLE,
-    .mode = GPIO_MODE_OUTPUT,
-    .pin_bit_mask = (1ULL << BSP_P_HEATING_CTRL),
-    .pull_down_en = GPIO_PULLDOWN_DISABLE,
-    .pull_up_en = GPIO_PULLUP_DISABLE,
+    .channel = (adc_channel_t)0, // 由 bsp_heating_init 填入通道0的ADC通道
+    .unit = (adc_unit_t)BSP_BOARD_NTC_ADC_UNIT,
 };
 
 /**************************************************************************************************
@@ -112,7 +146,12 @@ static gpio_config_t heating_ctrl_config = {
 static display_device_handle_t display_device = NULL;
 
 void bsp_display_init(void) {
+#if CONFIG_USE_STATIC_ALLOCATION
+    static display_storage_t display_storage;
+    display_init_static(&bsp_display_config, &display_storage, &display_device);
+#else
     display_init(&bsp_display_config, &display_device);
+#endif
     display_enable_all(display_device);
 }
 
@@ -124,44 +163,310 @@ void bsp_display_set_c_flag(const bool flag) { display_set_c_flag(display_device
 
 void bsp_display_set_h_flag(const bool flag) { display_set_h_flag(display_device, flag); }
 
+void bsp_display_refresh(void) { display_refresh(display_device); }
+
+void bsp_display_hold_refresh(const bool hold) { display_hold_refresh(display_device, hold); }
+
 /**************************************************************************************************
  * Implementation // Input Devices
  **************************************************************************************************/
 
 static QueueHandle_t bsp_input_queue = NULL;
+static bsp_gesture_engine_t bsp_gesture_engine;
 
-static const button_event_config_t btn_mt8_click_config = {
-    .event = BUTTON_MULTIPLE_CLICK,
-    .event_data =
-    {
-        .multiple_clicks = {.clicks = 8},
-    },
-};
+static void bsp_input_post(const bsp_input_event_t event) {
+    xQueueSend(bsp_input_queue, &event, 0);
 
-static void bsp_input_event_cb(void* _, void* usr_data) {
-    const bsp_input_event_t event = (uintptr_t)usr_data;
-    xQueueSendFromISR(bsp_input_queue, &event, NULL);
+#if CONFIG_BSP_INPUT_TRACE
+    ESP_LOGI(TAG, "[InputTrace] %lld %s", esp_timer_get_time() / 1000, bsp_input_event_to_string(event));
+#endif
 }
 
-void bsp_input_init(void) {
+/**
+ * @brief 把原始事件交给手势识别器, 识别出的事件送入输入队列
+ *
+ * 识别器只在一个上下文中调用 (轮询时为 esp_timer 任务, 中断方式时为输入任务), 不需要加锁
+ *
+ * @return 事件时刻 (ms)
+ */
+static uint32_t bsp_input_feed(const bsp_gesture_raw_type_t type, const bsp_gesture_key_t key, const int8_t direction) {
+    const bsp_gesture_raw_t raw = {
+        .type = type,
+        .key = key,
+        .direction = direction,
+        .time_ms = (uint32_t)(esp_timer_get_time() / 1000),
+    };
+    bsp_input_event_t events[BSP_GESTURE_OUT_MAX];
+    const int count = bsp_gesture_feed(&bsp_gesture_engine, &raw, events, BSP_GESTURE_OUT_MAX);
+    for (int i = 0; i < count; i++) { bsp_input_post(events[i]); }
+    return raw.time_ms;
+}
+
+#if CONFIG_BSP_INPUT_POLLING
+
+/*
+ * 轮询方式: iot_button 与 iot_knob 以 esp_timer 周期扫描引脚, 回调中上报按下/松开与旋钮转动,
+ * 长按到期由单独的 esp_timer 单次定时器触发
+ */
+
+static esp_timer_handle_t bsp_gesture_timer = NULL; // 长按到期定时器
+
+/* 按键回调的用户数据: 原始事件类型 << 8 | 按键 */
+#define BSP_INPUT_BUTTON_DATA(type, key) ((void*)(uintptr_t)((type) << 8 | (key)))
+
+/**
+ * @brief 输入原始事件, 并按下一个长按到期时刻重设定时器
+ */
+static void bsp_input_feed_and_rearm(const bsp_gesture_raw_type_t type, const bsp_gesture_key_t key,
+                                     const int8_t direction) {
+    const uint32_t now_ms = bsp_input_feed(type, key, direction);
+
+    uint32_t deadline_ms;
+    esp_timer_stop(bsp_gesture_timer); // 未启动时返回错误, 忽略
+    if (bsp_gesture_next_deadline(&bsp_gesture_engine, &deadline_ms)) {
+        const int32_t wait_ms = (int32_t)(deadline_ms - now_ms);
+        esp_timer_start_once(bsp_gesture_timer, (uint64_t)(wait_ms > 0 ? wait_ms : 1) * 1000);
+    }
+}
+
+static void bsp_input_button_cb(void* _, void* usr_data) {
+    const uintptr_t data = (uintptr_t)usr_data;
+    bsp_input_feed_and_rearm((bsp_gesture_raw_type_t)(data >> 8), (bsp_gesture_key_t)(data & 0xFF), 0);
+}
+
+static void bsp_input_knob_cb(void* _, void* usr_data) {
+    bsp_input_feed_and_rearm(BSP_GESTURE_RAW_DETENT, BSP_GESTURE_KEY_KNOB, (int8_t)(intptr_t)usr_data);
+}
+
+static void bsp_input_timer_cb(void* _) { bsp_input_feed_and_rearm(BSP_GESTURE_RAW_TICK, BSP_GESTURE_KEY_KNOB, 0); }
+
+/**
+ * @brief 注册按键的按下与松开事件, 点击, 长按等手势由识别器判断
+ */
+static void bsp_input_register_button(const button_config_t* config, const bsp_gesture_key_t key) {
+    const button_handle_t handle = iot_button_create(config);
+    iot_button_register_cb(handle, BUTTON_PRESS_DOWN, bsp_input_button_cb,
+                           BSP_INPUT_BUTTON_DATA(BSP_GESTURE_RAW_PRESS, key));
+    iot_button_register_cb(handle, BUTTON_PRESS_UP, bsp_input_button_cb,
+                           BSP_INPUT_BUTTON_DATA(BSP_GESTURE_RAW_RELEASE, key));
+}
+
+static void bsp_input_frontend_init(void) {
+    const esp_timer_create_args_t timer_args = {.callback = bsp_input_timer_cb, .name = "bsp_gesture"};
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &bsp_gesture_timer));
+
     /* 初始化旋钮编码器 */
     const knob_handle_t kb_ec_handle = iot_knob_create(&config_knob_encoder_a_b);
-    iot_knob_register_cb(kb_ec_handle, KNOB_LEFT, bsp_input_event_cb, (void*)BSP_KNOB_ENCODER_ACW);
-    iot_knob_register_cb(kb_ec_handle, KNOB_RIGHT, bsp_input_event_cb, (void*)BSP_KNOB_ENCODER_CW);
+    iot_knob_register_cb(kb_ec_handle, KNOB_LEFT, bsp_input_knob_cb, (void*)(intptr_t)-1);
+    iot_knob_register_cb(kb_ec_handle, KNOB_RIGHT, bsp_input_knob_cb, (void*)(intptr_t)1);
 
     /* 初始化旋钮按钮 */
-    const button_handle_t kb_btn_handle = iot_button_create(&config_knob_btn);
-    iot_button_register_cb(kb_btn_handle, BUTTON_LONG_PRESS_START, bsp_input_event_cb, (void*)BSP_KNOB_LONG_PRESS);
-    iot_button_register_event_cb(kb_btn_handle, btn_mt8_click_config, bsp_input_event_cb, (void*)BSP_KNOB_MT8_CLICK);
+    bsp_input_register_button(&config_knob_btn, BSP_GESTURE_KEY_KNOB);
+
+    /* 初始化触摸按键, 没有触摸按键的版本在编译期裁剪 */
+    if (BSP_BOARD_PIN(TOUCH_BUTTON_L) != GPIO_NUM_NC) {
+        bsp_input_register_button(&config_touch_button_left, BSP_GESTURE_KEY_TOUCH_L);
+    }
+    if (BSP_BOARD_PIN(TOUCH_BUTTON_R) != GPIO_NUM_NC) {
+        bsp_input_register_button(&config_touch_button_right, BSP_GESTURE_KEY_TOUCH_R);
+    }
+}
 
-    /* 初始化触摸按键 */
-    const button_handle_t tc_btn_l_handle = iot_button_create(&config_touch_button_left);
-    const button_handle_t tc_btn_r_handle = iot_button_create(&config_touch_button_right);
-    iot_button_register_cb(tc_btn_l_handle, BUTTON_SINGLE_CLICK, bsp_input_event_cb, (void*)BSP_TOUCH_BUTTON_L_CLICK);
-    iot_button_register_cb(tc_btn_r_handle, BUTTON_SINGLE_CLICK, bsp_input_event_cb, (void*)BSP_TOUCH_BUTTON_R_CLICK);
+#else
+
+/*
+ * 中断方式: 引脚电平变化触发GPIO中断, 中断只记录变化并唤醒输入任务.
+ *   - 按键: 任一边沿 (含抖动) 重新开始 CONFIG_BSP_INPUT_DEBOUNCE_MS 的消抖窗口, 窗口结束时读取电平,
+ *     与上次稳定电平不同即上报按下/松开;
+ *   - 编码器: 中断内按状态表解码正交信号, A/B 每完成半个周期 (回到 00 或 11) 计一格,
+ *     A 相超前为逆时针, 与 iot_knob 的默认方向相同. 抖动产生的来回跳变在状态表中相互抵消.
+ * 输入任务只在消抖窗口或长按等待期间带超时等待, 无人操作时不会被唤醒.
+ */
+
+#define BSP_INPUT_TASK_STACK_SIZE 4096
+#define BSP_INPUT_TASK_PRIORITY   12 // 高于应用任务, 保证输入及时
+
+static TaskHandle_t bsp_input_task_handle = NULL;
+static portMUX_TYPE bsp_input_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* 中断与输入任务共享, 由 bsp_input_lock 保护 */
+static struct {
+    uint8_t edges;    // 发生过边沿的按键 (BSP_GESTURE_KEY_BIT)
+    uint8_t encoder;  // 编码器上次的状态 A << 1 | B
+    int8_t steps;     // 当前半周期内累计的有效跳变, 正为顺时针
+    int32_t detents;  // 尚未处理的格数, 正为顺时针
+} bsp_input_irq;
+
+/* 以下只在输入任务中访问 */
+static bool bsp_input_pressed[BSP_GESTURE_KEY_NUM];    // 消抖后的按键状态
+static bool bsp_input_debouncing[BSP_GESTURE_KEY_NUM]; // 是否在消抖窗口内
+static uint32_t bsp_input_settle_ms[BSP_GESTURE_KEY_NUM];
+
+static bool bsp_input_button_level_active(const bsp_gesture_key_t key) {
+    return gpio_get_level(bsp_input_button_config[key].pin) == bsp_input_button_config[key].active_level;
+}
+
+static void bsp_input_button_isr(void* arg) {
+    const bsp_gesture_key_t key = (bsp_gesture_key_t)(uintptr_t)arg;
+
+    portENTER_CRITICAL_ISR(&bsp_input_lock);
+    bsp_input_irq.edges |= BSP_GESTURE_KEY_BIT(key);
+    portEXIT_CRITICAL_ISR(&bsp_input_lock);
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(bsp_input_task_handle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void bsp_input_encoder_isr(void* _) {
+    /* 下标为 上次状态 << 2 | 本次状态, 值为跳变方向; 无变化或同时跳变两相 (丢失了中间状态) 为0 */
+    static const int8_t transition[16] = {0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0};
+
+    const uint8_t state = (uint8_t)(gpio_get_level(BSP_BOARD_PIN(KNOB_ENCODER_A)) << 1 |
+                                    gpio_get_level(BSP_BOARD_PIN(KNOB_ENCODER_B)));
+    bool detent = false;
+
+    portENTER_CRITICAL_ISR(&bsp_input_lock);
+    bsp_input_irq.steps += transition[bsp_input_irq.encoder << 2 | state];
+    bsp_input_irq.encoder = state;
+    if (state == 0b00 || state == 0b11) {
+        if (bsp_input_irq.steps >= 2 || bsp_input_irq.steps <= -2) {
+            bsp_input_irq.detents += bsp_input_irq.steps > 0 ? 1 : -1;
+            detent = true;
+        }
+        bsp_input_irq.steps = 0;
+    }
+    portEXIT_CRITICAL_ISR(&bsp_input_lock);
 
+    if (detent) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(bsp_input_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static void bsp_input_task(void* _) {
+    TickType_t wait = portMAX_DELAY;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        portENTER_CRITICAL(&bsp_input_lock);
+        const uint8_t edges = bsp_input_irq.edges;
+        const int32_t detents = bsp_input_irq.detents;
+        bsp_input_irq.edges = 0;
+        bsp_input_irq.detents = 0;
+        portEXIT_CRITICAL(&bsp_input_lock);
+
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+        /* 新的边沿重新开始消抖窗口 */
+        for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+            if (edges & BSP_GESTURE_KEY_BIT(k)) {
+                bsp_input_debouncing[k] = true;
+                bsp_input_settle_ms[k] = now_ms + CONFIG_BSP_INPUT_DEBOUNCE_MS;
+            }
+        }
+
+        /* 消抖窗口结束, 电平稳定 */
+        for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+            if (!bsp_input_debouncing[k] || (int32_t)(now_ms - bsp_input_settle_ms[k]) < 0) { continue; }
+
+            bsp_input_debouncing[k] = false;
+            const bool pressed = bsp_input_button_level_active((bsp_gesture_key_t)k);
+            if (pressed != bsp_input_pressed[k]) {
+                bsp_input_pressed[k] = pressed;
+                now_ms = bsp_input_feed(pressed ? BSP_GESTURE_RAW_PRESS : BSP_GESTURE_RAW_RELEASE,
+                                        (bsp_gesture_key_t)k, 0);
+            }
+        }
+
+        for (int32_t i = 0; i < (detents > 0 ? detents : -detents); i++) {
+            now_ms = bsp_input_feed(BSP_GESTURE_RAW_DETENT, BSP_GESTURE_KEY_KNOB, detents > 0 ? 1 : -1);
+        }
+
+        /* 长按到期 */
+        uint32_t deadline_ms;
+        if (bsp_gesture_next_deadline(&bsp_gesture_engine, &deadline_ms) && (int32_t)(deadline_ms - now_ms) <= 0) {
+            now_ms = bsp_input_feed(BSP_GESTURE_RAW_TICK, BSP_GESTURE_KEY_KNOB, 0);
+        }
+
+        /* 等待到最近的消抖窗口结束或长按到期, 都没有时无限等待 */
+        bool armed = bsp_gesture_next_deadline(&bsp_gesture_engine, &deadline_ms);
+        for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+            if (!bsp_input_debouncing[k]) { continue; }
+            if (!armed || (int32_t)(bsp_input_settle_ms[k] - deadline_ms) < 0) { deadline_ms = bsp_input_settle_ms[k]; }
+            armed = true;
+        }
+
+        if (armed) {
+            const int32_t wait_ms = (int32_t)(deadline_ms - now_ms);
+            wait = pdMS_TO_TICKS(wait_ms > 0 ? wait_ms : 0) + 1; // 向上取整, 不会早于到期时刻唤醒
+        } else {
+            wait = portMAX_DELAY;
+        }
+    }
+}
+
+APP_TASK_STORAGE(bsp_input_task, BSP_INPUT_TASK_STACK_SIZE);
+
+static void bsp_input_frontend_init(void) {
+    const esp_err_t err = gpio_install_isr_service(0);
+    ESP_ERROR_CHECK(err == ESP_ERR_INVALID_STATE ? ESP_OK : err); // 已由其他驱动安装
+
+    /* 初始化旋钮编码器, 与 iot_knob 相同启用上拉 */
+    const gpio_config_t encoder_config = {
+        .intr_type = GPIO_INTR_ANYEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = 1ULL << BSP_BOARD_PIN(KNOB_ENCODER_A) | 1ULL << BSP_BOARD_PIN(KNOB_ENCODER_B),
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&encoder_config));
+    bsp_input_irq.encoder = (uint8_t)(gpio_get_level(BSP_BOARD_PIN(KNOB_ENCODER_A)) << 1 |
+                                      gpio_get_level(BSP_BOARD_PIN(KNOB_ENCODER_B)));
+
+    /* 初始化旋钮按钮与触摸按键, 没有触摸按键的版本跳过 */
+    for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+        const gpio_num_t pin = bsp_input_button_config[k].pin;
+        if (pin == GPIO_NUM_NC) { continue; }
+
+        const bool active_high = bsp_input_button_config[k].active_level;
+        const gpio_config_t button_config = {
+            .intr_type = GPIO_INTR_ANYEDGE,
+            .mode = GPIO_MODE_INPUT,
+            .pin_bit_mask = 1ULL << pin,
+            .pull_down_en = active_high ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE,
+            .pull_up_en = active_high ? GPIO_PULLUP_DISABLE : GPIO_PULLUP_ENABLE,
+        };
+        ESP_ERROR_CHECK(gpio_config(&button_config));
+        bsp_input_pressed[k] = bsp_input_button_level_active((bsp_gesture_key_t)k); // 启动时已按下的不上报
+    }
+
+    /* 中断需要唤醒输入任务, 先创建任务再挂接中断 */
+    APP_TASK_CREATE(bsp_input_task, bsp_input_task, "BspInput", NULL, BSP_INPUT_TASK_PRIORITY,
+                    &bsp_input_task_handle);
+
+    ESP_ERROR_CHECK(gpio_isr_handler_add(BSP_BOARD_PIN(KNOB_ENCODER_A), bsp_input_encoder_isr, NULL));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(BSP_BOARD_PIN(KNOB_ENCODER_B), bsp_input_encoder_isr, NULL));
+    for (int k = 0; k < BSP_GESTURE_KEY_NUM; k++) {
+        const gpio_num_t pin = bsp_input_button_config[k].pin;
+        if (pin == GPIO_NUM_NC) { continue; }
+        ESP_ERROR_CHECK(gpio_isr_handler_add(pin, bsp_input_button_isr, (void*)(uintptr_t)k));
+    }
+}
+
+#endif
+
+APP_QUEUE_STORAGE(input_event, 10, sizeof(bsp_input_event_t));
+
+void bsp_input_init(void) {
     /* 创建输入设备输入事件队列 */
-    bsp_input_queue = xQueueCreate(10, sizeof(bsp_input_event_t));
+    bsp_input_queue = APP_QUEUE_CREATE(input_event, 10, sizeof(bsp_input_event_t));
+
+    /* 初始化手势识别器, 再启动输入前端 */
+    bsp_gesture_init(&bsp_gesture_engine, bsp_gesture_table, bsp_gesture_table_len);
+    bsp_input_frontend_init();
 }
 
 QueueHandle_t bsp_input_get_queue(void) { return bsp_input_queue; }
@@ -180,6 +485,12 @@ char* bsp_input_event_to_string(const bsp_input_event_t event) {
             return "BSP_TOUCH_BUTTON_L_CLICK";
         case BSP_TOUCH_BUTTON_R_CLICK:
             return "BSP_TOUCH_BUTTON_R_CLICK";
+        case BSP_KNOB_HOLD_ENCODER_ACW:
+            return "BSP_KNOB_HOLD_ENCODER_ACW";
+        case BSP_KNOB_HOLD_ENCODER_CW:
+            return "BSP_KNOB_HOLD_ENCODER_CW";
+        case BSP_TOUCH_BUTTON_LR_CHORD:
+            return "BSP_TOUCH_BUTTON_LR_CHORD";
         default:
             return "BSP_UNKNOWN_INPUT_EVENT";
     }
@@ -193,11 +504,15 @@ static led_strip_handle_t led_strip = NULL;
 static int led_strip_brightness = 50;
 
 void bsp_led_strip_init(void) {
+    if (BSP_BOARD_LED_STRIP_NUM == 0) return; // 没有灯带的版本在编译期裁剪
+
     ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip));
     bsp_led_strip_write(BSP_STRIP_WHITE);
 }
 
 void bsp_led_strip_write(const bsp_led_strip_mode_t mode) {
+    if (BSP_BOARD_LED_STRIP_NUM == 0) return;
+
     int red, green, blue;
 
     if (mode == BSP_STRIP_OFF) {
@@ -226,6 +541,11 @@ void bsp_led_strip_write(const bsp_led_strip_mode_t mode) {
             green = 96 * led_strip_brightness / 100;
             blue = 230 * led_strip_brightness / 100;
             break;
+        case BSP_STRIP_RED:
+            red = 255 * led_strip_brightness / 100;
+            green = 0;
+            blue = 0;
+            break;
         default:
             red = 0;
             green = 0;
@@ -233,7 +553,7 @@ void bsp_led_strip_write(const bsp_led_strip_mode_t mode) {
             break;
     }
 
-    for (int i = 0; i < BSP_LED_STRIP_NUM; i++) {
+    for (int i = 0; i < BSP_BOARD_LED_STRIP_NUM; i++) {
         ESP_ERROR_CHECK(led_strip_set_pixel(led_strip, i, red, green, blue));
     }
 
@@ -245,38 +565,371 @@ void bsp_led_strip_write(const bsp_led_strip_mode_t mode) {
  **************************************************************************************************/
 
 static ntc_device_handle_t ntc_device = NULL;
+static adc_oneshot_unit_handle_t ntc_adc_handle = NULL;
+static adc_cali_handle_t ntc_cali_handle[BSP_HEATING_CHANNEL_NUM] = {0}; // ADC曲线拟合校准, 无eFuse校准数据时为空
+static SemaphoreHandle_t ntc_lock = NULL; // 安全监控与控制任务会并发读取NTC
+static int32_t ntc_cal_gain = BSP_NTC_CAL_GAIN_ONE; // 通道0单板两点校准增益 (Q16), 由 ntc_lock 保护
+static int32_t ntc_cal_offset = 0;                  // 通道0单板两点校准偏移 (m°C), 由 ntc_lock 保护
+static portMUX_TYPE heating_spinlock = portMUX_INITIALIZER_UNLOCKED; // 保证锁定与打开加热器互斥
+static bool heating_locked_out = false;
+
+/* 各通道加热器输出状态, 由 heating_spinlock 保护 */
+static struct {
+    bool enabled;
+    int64_t on_since_us;  // 本次打开加热器的时刻
+    uint64_t on_total_us; // 已结束的开启区间累计时长
+} heating_channels[BSP_HEATING_CHANNEL_NUM] = {0};
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+/* 静默窗口转换请求, 由 ntc_sync_lock 保护; 只有持有 ntc_lock 的读取者会发起请求 */
+static struct {
+    int channel;   // 待转换的通道, -1 为无请求
+    int remaining; // 剩余转换次数
+    int32_t sum;   // 已完成转换的原始值之和
+    esp_err_t err;
+} ntc_sync_request = {.channel = -1};
+static portMUX_TYPE ntc_sync_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t ntc_sync_done = NULL;     // 请求完成时由刷新中断释放
+static bsp_ntc_sync_stats_t ntc_sync_stats = {0}; // 由 ntc_lock 保护
+
+static bool ntc_quiet_window_cb(void* arg);
+#endif
+
+APP_MUTEX_STORAGE(ntc_lock);
 
 void bsp_heating_init(void) {
-    /* 初始化NTC */
-    adc_oneshot_unit_handle_t adc_handle = NULL;
-    ESP_ERROR_CHECK(ntc_dev_create(&ntc_config, &ntc_device, &adc_handle));
-    ESP_ERROR_CHECK(ntc_dev_get_adc_handle(ntc_device, &adc_handle));
+    /* 初始化NTC: 通道0经 ntc_driver 创建ADC单元, 其余通道在同一ADC单元上配置 */
+    ntc_config.channel = heating_channel_config[0].ntc_chan;
+    ESP_ERROR_CHECK(ntc_dev_create(&ntc_config, &ntc_device, &ntc_adc_handle));
+    ESP_ERROR_CHECK(ntc_dev_get_adc_handle(ntc_device, &ntc_adc_handle));
+
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        if (ch > 0) {
+            const adc_oneshot_chan_cfg_t chan_config = {
+                .atten = ADC_ATTEN_DB_12,
+                .bitwidth = ADC_BITWIDTH_DEFAULT,
+            };
+            ESP_ERROR_CHECK(
+                adc_oneshot_config_channel(ntc_adc_handle, heating_channel_config[ch].ntc_chan, &chan_config)
+            );
+        }
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+        const adc_cali_curve_fitting_config_t cali_config = {
+            .unit_id = (adc_unit_t)BSP_BOARD_NTC_ADC_UNIT,
+            .chan = heating_channel_config[ch].ntc_chan,
+            .atten = ADC_ATTEN_DB_12,
+            .bitwidth = ADC_BITWIDTH_DEFAULT,
+        };
+        if (adc_cali_create_scheme_curve_fitting(&cali_config, &ntc_cali_handle[ch]) != ESP_OK) {
+            ESP_LOGW(TAG, "ADC calibration unavailable on channel %d, using raw ratio", ch);
+            ntc_cali_handle[ch] = NULL;
+        }
+#endif
+    }
+    ntc_lock = APP_MUTEX_CREATE(ntc_lock);
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+    /* NTC转换移到数码管刷新中断的静默窗口, 需在数码管初始化之后 */
+#if CONFIG_USE_STATIC_ALLOCATION
+    static StaticSemaphore_t ntc_sync_done_buffer;
+    ntc_sync_done = xSemaphoreCreateBinaryStatic(&ntc_sync_done_buffer);
+#else
+    ntc_sync_done = xSemaphoreCreateBinary();
+#endif
+    display_set_quiet_hook(display_device, ntc_quiet_window_cb, NULL);
+#endif
 
     /* 初始化加热器控制 */
+    gpio_config_t heating_ctrl_config = {
+        .intr_type = GPIO_INTR_DISABLE,
+        .mode = GPIO_MODE_OUTPUT,
+        .pin_bit_mask = 0,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+    };
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        heating_ctrl_config.pin_bit_mask |= 1ULL << heating_channel_config[ch].heater_pin;
+    }
     gpio_config(&heating_ctrl_config);
-    gpio_set_level(BSP_P_HEATING_CTRL, 0);
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { gpio_set_level(heating_channel_config[ch].heater_pin, 0); }
+}
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+
+/* 等待静默窗口转换的超时余量: 数码管在等待期间关闭时刷新中断停止, 超时后改为直接读取 */
+#define NTC_SYNC_TIMEOUT_MS 3
+
+/**
+ * @brief 数码管静默窗口回调: 有待完成的请求时转换一次
+ *
+ * 刷新定时器中断在访问闪存期间被屏蔽, 可以调用不在IRAM中的ADC驱动
+ */
+static bool IRAM_ATTR ntc_quiet_window_cb(void* arg) {
+    BaseType_t woken = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&ntc_sync_lock);
+    if (ntc_sync_request.channel >= 0) {
+        int raw;
+        const esp_err_t ret =
+            adc_oneshot_read_isr(ntc_adc_handle, heating_channel_config[ntc_sync_request.channel].ntc_chan, &raw);
+        if (ret == ESP_OK) {
+            ntc_sync_request.sum += raw;
+            ntc_sync_request.remaining--;
+        } else {
+            ntc_sync_request.err = ret;
+            ntc_sync_request.remaining = 0;
+        }
+        if (ntc_sync_request.remaining == 0) {
+            ntc_sync_request.channel = -1;
+            xSemaphoreGiveFromISR(ntc_sync_done, &woken);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&ntc_sync_lock);
+
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief 在连续 samples 个静默窗口中各转换一次并取平均, 调用者需持有 ntc_lock
+ *
+ * @return ESP_OK; ESP_ERR_TIMEOUT 数码管未在扫描或等待期间关闭; 其他 ADC读取失败
+ */
+static esp_err_t ntc_read_raw_synced_locked(const int channel, const int samples, int* raw) {
+    if (!display_is_refreshing(display_device)) { return ESP_ERR_TIMEOUT; }
+
+    xSemaphoreTake(ntc_sync_done, 0); // 清除上次请求超时后迟到的完成信号
+
+    portENTER_CRITICAL(&ntc_sync_lock);
+    ntc_sync_request.sum = 0;
+    ntc_sync_request.remaining = samples;
+    ntc_sync_request.err = ESP_OK;
+    ntc_sync_request.channel = channel;
+    portEXIT_CRITICAL(&ntc_sync_lock);
+
+    /* 多等待两个节拍: 超时时间不足一个节拍的部分会被截断 */
+    xSemaphoreTake(ntc_sync_done, pdMS_TO_TICKS(samples + NTC_SYNC_TIMEOUT_MS) + 2);
+
+    portENTER_CRITICAL(&ntc_sync_lock);
+    const bool completed = ntc_sync_request.remaining == 0;
+    ntc_sync_request.channel = -1; // 超时则撤销请求
+    const int32_t sum = ntc_sync_request.sum;
+    const esp_err_t err = ntc_sync_request.err;
+    portEXIT_CRITICAL(&ntc_sync_lock);
+
+    if (!completed) {
+        ntc_sync_stats.timeouts++;
+        return ESP_ERR_TIMEOUT;
+    }
+    if (err != ESP_OK) { return err; }
+
+    ntc_sync_stats.synced++;
+    *raw = (int)((sum + samples / 2) / samples);
+    return ESP_OK;
+}
+
+#endif
+
+/**
+ * @brief 读取NTC分压点的ADC原始值, 调用者需持有 ntc_lock
+ *
+ * 启用 CONFIG_BSP_NTC_SYNC_DISPLAY 且数码管在扫描时, 在静默窗口中转换, 否则直接转换
+ */
+static esp_err_t ntc_read_raw_locked(const int channel, int* raw) {
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+    const esp_err_t ret = ntc_read_raw_synced_locked(channel, CONFIG_BSP_NTC_SYNC_SAMPLES, raw);
+    if (ret != ESP_ERR_TIMEOUT) { return ret; }
+    ntc_sync_stats.direct++;
+#endif
+    return adc_oneshot_read(ntc_adc_handle, heating_channel_config[channel].ntc_chan, raw);
+}
+
+/**
+ * @brief 读取NTC并按B值方程换算为温度, 调用者需持有 ntc_lock
+ *
+ * 分压点电压经ADC曲线拟合校准换算, 消除ADC自身的增益与非线性误差
+ */
+static esp_err_t ntc_read_temp_locked(const int channel, int32_t* milli_celsius) {
+    int raw;
+    const esp_err_t ret = ntc_read_raw_locked(channel, &raw);
+    if (ret != ESP_OK) { return ret; }
+
+    float ratio = (float)raw / BSP_NTC_ADC_RAW_MAX; // 分压比 R_ntc / (R_ntc + R_fixed)
+    int voltage_mv;
+    const adc_cali_handle_t cali = ntc_cali_handle[channel];
+    if (cali != NULL && adc_cali_raw_to_voltage(cali, raw, &voltage_mv) == ESP_OK) {
+        ratio = (float)voltage_mv / BSP_BOARD_NTC_VDD_MV;
+    }
+    if (ratio <= 0.0f || ratio >= 1.0f) { return ESP_ERR_INVALID_RESPONSE; }
+
+    const float r_ntc = (float)BSP_BOARD_NTC_FIXED_OHM * ratio / (1.0f - ratio);
+    const float temp =
+        1.0f / (1.0f / 298.15f + logf(r_ntc / (float)BSP_BOARD_NTC_R25_OHM) / (float)BSP_BOARD_NTC_B_VALUE) - 273.15f;
+    if (!isfinite(temp)) { return ESP_ERR_INVALID_RESPONSE; }
+
+    *milli_celsius = (int32_t)(temp * 1000);
+    return ESP_OK;
+}
+
+esp_err_t bsp_heating_channel_read_temp(const int channel, int32_t* milli_celsius) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return ESP_ERR_INVALID_ARG; }
+
+    int32_t temp;
+
+    xSemaphoreTake(ntc_lock, portMAX_DELAY);
+    const esp_err_t ret = ntc_read_temp_locked(channel, &temp);
+    if (ret == ESP_OK) {
+        *milli_celsius = channel == 0 ? (int32_t)(((int64_t)temp * ntc_cal_gain) >> 16) + ntc_cal_offset : temp;
+    }
+    xSemaphoreGive(ntc_lock);
+
+    return ret;
+}
+
+esp_err_t bsp_heating_read_temp_uncalibrated(int32_t* milli_celsius) {
+    xSemaphoreTake(ntc_lock, portMAX_DELAY);
+    const esp_err_t ret = ntc_read_temp_locked(0, milli_celsius);
+    xSemaphoreGive(ntc_lock);
+
+    return ret;
+}
+
+void bsp_heating_set_ntc_calibration(const int32_t gain_q16, const int32_t offset_mC) {
+    xSemaphoreTake(ntc_lock, portMAX_DELAY);
+    ntc_cal_gain = gain_q16;
+    ntc_cal_offset = offset_mC;
+    xSemaphoreGive(ntc_lock);
+}
+
+esp_err_t bsp_heating_channel_read_ntc_raw(const int channel, int* raw) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return ESP_ERR_INVALID_ARG; }
+
+    xSemaphoreTake(ntc_lock, portMAX_DELAY);
+    const esp_err_t ret = ntc_read_raw_locked(channel, raw);
+    xSemaphoreGive(ntc_lock);
+
+    return ret;
+}
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+esp_err_t bsp_heating_measure_ntc_noise(const int channel, const int samples, const bool synced,
+                                        bsp_ntc_noise_t* noise) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM || samples < 2) { return ESP_ERR_INVALID_ARG; }
+
+    double mean = 0.0;
+    double m2 = 0.0; // 与均值之差的平方和 (Welford)
+    noise->min = BSP_NTC_ADC_RAW_MAX;
+    noise->max = 0;
+
+    for (int i = 0; i < samples; i++) {
+        int raw;
+        esp_err_t ret;
+
+        if (synced) {
+            xSemaphoreTake(ntc_lock, portMAX_DELAY);
+            ret = ntc_read_raw_synced_locked(channel, 1, &raw);
+            xSemaphoreGive(ntc_lock);
+        } else {
+            /* 任务节拍是刷新周期的整数倍, 随机延时使转换时刻均匀分布在刷新周期内 */
+            esp_rom_delay_us(esp_random() % 1000);
+            xSemaphoreTake(ntc_lock, portMAX_DELAY);
+            ret = adc_oneshot_read(ntc_adc_handle, heating_channel_config[channel].ntc_chan, &raw);
+            xSemaphoreGive(ntc_lock);
+        }
+        if (ret != ESP_OK) { return ret; }
+
+        const double delta = raw - mean;
+        mean += delta / (i + 1);
+        m2 += delta * (raw - mean);
+        if (raw < noise->min) { noise->min = raw; }
+        if (raw > noise->max) { noise->max = raw; }
+    }
+
+    noise->samples = samples;
+    noise->mean = (float)mean;
+    noise->variance = (float)(m2 / (samples - 1));
+    return ESP_OK;
+}
+
+void bsp_heating_get_ntc_sync_stats(bsp_ntc_sync_stats_t* stats) {
+    xSemaphoreTake(ntc_lock, portMAX_DELAY);
+    *stats = ntc_sync_stats;
+    xSemaphoreGive(ntc_lock);
 }
+#endif
 
 int bsp_heating_get_temp(void) {
-    float temp;
+    int32_t milli_celsius;
 
-    if (ntc_dev_get_temperature(ntc_device, &temp) == ESP_OK) {
-        return (int)temp;
+    if (bsp_heating_read_temp(&milli_celsius) == ESP_OK) {
+        return milli_celsius / 1000;
     }
 
     ESP_LOGE(TAG, "Failed to get temperature");
     return 100;
 }
 
-void bsp_heating_enable(void) { gpio_set_level(BSP_P_HEATING_CTRL, 1); }
+/**
+ * @brief 设置加热器输出并累计开启时间, 调用者需持有 heating_spinlock
+ */
+static void heating_set_output_locked(const int channel, const bool on) {
+    const int64_t now_us = esp_timer_get_time();
+
+    if (on && !heating_channels[channel].enabled) { heating_channels[channel].on_since_us = now_us; }
+    if (!on && heating_channels[channel].enabled) {
+        heating_channels[channel].on_total_us += now_us - heating_channels[channel].on_since_us;
+    }
 
-void bsp_heating_disable(void) { gpio_set_level(BSP_P_HEATING_CTRL, 0); }
+    gpio_set_level(heating_channel_config[channel].heater_pin, on);
+    heating_channels[channel].enabled = on;
+}
+
+void bsp_heating_channel_enable(const int channel) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return; }
+
+    portENTER_CRITICAL(&heating_spinlock);
+    if (!heating_locked_out) { heating_set_output_locked(channel, true); }
+    portEXIT_CRITICAL(&heating_spinlock);
+}
+
+void bsp_heating_channel_disable(const int channel) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return; }
+
+    portENTER_CRITICAL(&heating_spinlock);
+    heating_set_output_locked(channel, false);
+    portEXIT_CRITICAL(&heating_spinlock);
+}
+
+bool bsp_heating_channel_is_enabled(const int channel) {
+    return channel >= 0 && channel < BSP_HEATING_CHANNEL_NUM && heating_channels[channel].enabled;
+}
+
+void bsp_heating_lockout(void) {
+    portENTER_CRITICAL(&heating_spinlock);
+    heating_locked_out = true;
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { heating_set_output_locked(ch, false); }
+    portEXIT_CRITICAL(&heating_spinlock);
+}
+
+uint64_t bsp_heating_get_on_time_us(void) {
+    uint64_t total_us = 0;
+
+    portENTER_CRITICAL(&heating_spinlock);
+    const int64_t now_us = esp_timer_get_time();
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        total_us += heating_channels[ch].on_total_us;
+        if (heating_channels[ch].enabled) { total_us += now_us - heating_channels[ch].on_since_us; }
+    }
+    portEXIT_CRITICAL(&heating_spinlock);
+    return total_us;
+}
 
 
 /**************************************************************************************************
  * Implementation // Initialize All Peripherals
  **************************************************************************************************/
 void bsp_init_all(void) {
+    ESP_LOGI(TAG, "Board: %s", BSP_BOARD_NAME);
+
     bsp_display_init();
     bsp_led_strip_init();
     bsp_heating_init();
@@ -0,0 +1,939 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+#include "driver/gpio.h"
+#include "ic_74hc595_driver.h"
+
+#include "app_memory.h"
+#include "bsp/input_gesture.h"
+#include "bsp/seg_display_driver.h"
+#include "bsp/towelrack_controller_a1.h"
+#include "bsp/towelrack_sim.h"
+
+static const char* TAG = "towelrack-sim";
+
+/**************************************************************************************************
+ * Config // Simulation Board
+ **************************************************************************************************/
+
+#define SIM_DISPLAY_MAX_LENS  BSP_BOARD_DISPLAY_DIGITS
+#define SIM_PLANT_STEP_MS     1000    // 热模型积分步长(虚拟时间)
+#define SIM_WATER_LATENT_HEAT 2260.0f // 水的汽化潜热 (J/g)
+#define SIM_TOWEL_CRITICAL    0.2f    // 含水量低于该比例后进入降速干燥阶段
+
+static const display_config_t bsp_display_config = {
+    .ds = BSP_BOARD_PIN(74HC595_DS),
+    .shcp = BSP_BOARD_PIN(74HC595_SHCP),
+    .stcp = BSP_BOARD_PIN(74HC595_STCP),
+    .u1_ctrl = BSP_BOARD_PIN(DISP_S1_SW),
+    .u2_ctrl = BSP_BOARD_PIN(DISP_S2_SW),
+    .max_lens = SIM_DISPLAY_MAX_LENS,
+};
+
+static const struct {
+    float ambient_temp;     // 环境温度 (°C)
+    float heater_power;     // 加热功率 (W)
+    float heat_capacity;    // 毛巾架热容 (J/K)
+    float loss_conductance; // 毛巾架散热系数 (W/K)
+    float ntc_lag;          // NTC热滞后时间常数 (s)
+    float towel_water;      // 湿毛巾含水量 (g)
+    float evap_conductance; // 湿毛巾蒸发散热系数 (W/K)
+} sim_plant_config = {
+    .ambient_temp = CONFIG_SIM_AMBIENT_TEMP,
+    .heater_power = CONFIG_SIM_HEATER_POWER_W,
+    .heat_capacity = CONFIG_SIM_RACK_HEAT_CAPACITY,
+    .loss_conductance = CONFIG_SIM_RACK_LOSS_CONDUCTANCE / 1000.0f,
+    .ntc_lag = CONFIG_SIM_NTC_LAG_S,
+    .towel_water = CONFIG_SIM_TOWEL_WATER_G,
+    .evap_conductance = CONFIG_SIM_TOWEL_EVAP_CONDUCTANCE / 1000.0f,
+};
+
+/**************************************************************************************************
+ * Implementation // Virtual Timebase
+ **************************************************************************************************/
+
+static SemaphoreHandle_t sim_lock = NULL;
+
+uint64_t bsp_sim_get_time_ms(void) { return BSP_TICKS_TO_MS(xTaskGetTickCount()); }
+
+/**
+ * @brief 阻塞直到虚拟时间到达目标时刻
+ */
+static void sim_delay_until_ms(const uint64_t target_ms) {
+    const uint64_t now_ms = bsp_sim_get_time_ms();
+    if (target_ms > now_ms) { vTaskDelay(BSP_MS_TO_TICKS(target_ms - now_ms)); }
+}
+
+/**************************************************************************************************
+ * Implementation // 74HC595 IC & 7-Segment Display
+ *
+ * 仿真板复用真实的数码管驱动, 其 GPIO/定时器/74HC595 由 sim/ 下的替身实现
+ **************************************************************************************************/
+
+static display_device_handle_t display_device = NULL;
+static QueueHandle_t bsp_input_queue = NULL;
+
+static struct {
+    char content[SIM_DISPLAY_MAX_LENS + 1];   // 显示内容
+    bool c_flag;                              // 是否显示C标志
+    bool h_flag;                              // 是否显示H标志
+    uint8_t visible[SIM_DISPLAY_MAX_LENS];    // 各位数码管当前点亮的段码
+} sim_display = {0};
+
+static void sim_latency_on_display_change(void);
+
+/**
+ * @brief 观测数码管位选信号, 位选使能时存储寄存器中的段码即为该位的可见画面
+ */
+static void sim_display_gpio_cb(const gpio_num_t gpio_num, const uint32_t level) {
+    int digit;
+
+    if (level != 0) { return; }
+    if (gpio_num == bsp_display_config.u1_ctrl) {
+        digit = 0;
+    } else if (gpio_num == bsp_display_config.u2_ctrl) {
+        digit = 1;
+    } else {
+        return;
+    }
+
+    const uint8_t segments = sim_74hc595_get_output();
+    if (sim_display.visible[digit] != segments) {
+        sim_display.visible[digit] = segments;
+        sim_latency_on_display_change();
+    }
+}
+
+/**
+ * @brief 输出虚拟数码管当前画面
+ */
+static void sim_display_log(void) {
+    ESP_LOGI(TAG, "[Display] %-2s %c%c", sim_display.content,
+             sim_display.c_flag ? 'C' : ' ', sim_display.h_flag ? 'H' : ' ');
+}
+
+void bsp_display_init(void) {
+    sim_gpio_register_output_cb(sim_display_gpio_cb);
+#if CONFIG_USE_STATIC_ALLOCATION
+    static display_storage_t display_storage;
+    display_init_static(&bsp_display_config, &display_storage, &display_device);
+#else
+    display_init(&bsp_display_config, &display_device);
+#endif
+    display_enable_all(display_device);
+}
+
+void bsp_display_write_str(const char* str) {
+    display_write_str(display_device, str);
+
+    if (str == NULL || strlen(str) == 0) {
+        memset(&sim_display, 0, sizeof(sim_display));
+        sim_latency_on_display_change(); // 熄灭时位选立即关闭, 无需等待刷新
+    } else {
+        strncpy(sim_display.content, str, SIM_DISPLAY_MAX_LENS);
+        sim_display.content[SIM_DISPLAY_MAX_LENS] = '\0';
+    }
+
+    sim_display_log();
+}
+
+void bsp_display_write_int(const int num) {
+    char str[SIM_DISPLAY_MAX_LENS + 1];
+
+    snprintf(str, sizeof(str), "%d", num);
+
+    bsp_display_write_str(str);
+}
+
+void bsp_display_set_c_flag(const bool flag) {
+    sim_display.c_flag = flag;
+    display_set_c_flag(display_device, flag);
+}
+
+void bsp_display_set_h_flag(const bool flag) {
+    sim_display.h_flag = flag;
+    display_set_h_flag(display_device, flag);
+}
+
+void bsp_display_refresh(void) { display_refresh(display_device); }
+
+void bsp_display_hold_refresh(const bool hold) { display_hold_refresh(display_device, hold); }
+
+const char* bsp_sim_get_display_content(void) { return sim_display.content; }
+
+/**************************************************************************************************
+ * Implementation // Input Latency Benchmark
+ *
+ * 记录每个注入事件的时间戳, 在数码管可见画面发生变化时结算延迟.
+ * 注入端只有脚本任务一个生产者, 无需加锁; 结算端(刷新定时器与熄屏路径)由互斥锁串行化.
+ **************************************************************************************************/
+
+#define SIM_LATENCY_PENDING_NUM 64
+#define SIM_LATENCY_SAMPLE_NUM  4096
+
+static struct {
+    int64_t pending[SIM_LATENCY_PENDING_NUM]; // 等待结算的注入时间戳(us)
+    uint32_t head;                            // 生产者写入位置
+    uint32_t tail;                            // 消费者读取位置
+    uint32_t samples[SIM_LATENCY_SAMPLE_NUM]; // 已结算的延迟(us)
+    uint32_t sample_count;                    // 已结算的事件数
+    uint32_t injected;                        // 注入的事件数
+    uint32_t queue_full;                      // 因输入队列已满被丢弃的事件数
+    uint32_t overflow;                        // 待结算队列已满而无法跟踪的事件数
+    uint32_t unanswered;                      // 超时未引起显示变化的事件数
+    SemaphoreHandle_t lock;                   // 结算端互斥锁
+} sim_latency = {0};
+
+/**
+ * @brief 获取单调时钟(us), 延迟以真实时间计量, 与仿真倍率无关
+ */
+static int64_t sim_latency_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 登记一个输入事件, 对应硬件上的 bsp_input_event_cb
+ *
+ * @return 事件是否成功进入输入队列
+ */
+static bool sim_latency_on_input(const bsp_input_event_t event) {
+    const int64_t now_us = sim_latency_now_us();
+    const uint32_t head = __atomic_load_n(&sim_latency.head, __ATOMIC_RELAXED);
+    const uint32_t tail = __atomic_load_n(&sim_latency.tail, __ATOMIC_ACQUIRE);
+
+    sim_latency.injected++;
+
+    if (xQueueSend(bsp_input_queue, &event, 0) != pdTRUE) {
+        sim_latency.queue_full++;
+        return false;
+    }
+
+    if (head - tail < SIM_LATENCY_PENDING_NUM) {
+        sim_latency.pending[head % SIM_LATENCY_PENDING_NUM] = now_us;
+        __atomic_store_n(&sim_latency.head, head + 1, __ATOMIC_RELEASE);
+    } else {
+        sim_latency.overflow++;
+    }
+    return true;
+}
+
+/**
+ * @brief 显示画面变化时结算所有待定事件, 超时的事件计为未响应
+ */
+static void sim_latency_on_display_change(void) {
+    const int64_t now_us = sim_latency_now_us();
+
+    xSemaphoreTake(sim_latency.lock, portMAX_DELAY);
+
+    const uint32_t head = __atomic_load_n(&sim_latency.head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&sim_latency.tail, __ATOMIC_RELAXED);
+
+    for (; tail != head; tail++) {
+        const int64_t latency_us = now_us - sim_latency.pending[tail % SIM_LATENCY_PENDING_NUM];
+
+#if CONFIG_SIM_LATENCY_BENCH
+        if (latency_us > CONFIG_SIM_LATENCY_TIMEOUT_MS * 1000LL) {
+            sim_latency.unanswered++;
+            continue;
+        }
+#endif
+        if (sim_latency.sample_count < SIM_LATENCY_SAMPLE_NUM) {
+            sim_latency.samples[sim_latency.sample_count++] = (uint32_t)latency_us;
+        }
+    }
+
+    __atomic_store_n(&sim_latency.tail, tail, __ATOMIC_RELEASE);
+
+    xSemaphoreGive(sim_latency.lock);
+}
+
+#if CONFIG_SIM_LATENCY_BENCH
+static int sim_latency_compare(const void* a, const void* b) {
+    const uint32_t lhs = *(const uint32_t*)a;
+    const uint32_t rhs = *(const uint32_t*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/**
+ * @brief 输出延迟统计, 并依据 p99 门限决定进程退出码
+ *
+ * 报告格式: LATENCY,<注入数>,<已结算数>,<队列满丢弃数>,<未响应数>,<p50 us>,<p99 us>,<max us>
+ */
+static void sim_latency_report_and_exit(void) {
+    const uint32_t head = __atomic_load_n(&sim_latency.head, __ATOMIC_ACQUIRE);
+    const uint32_t count = sim_latency.sample_count;
+    uint32_t p50 = 0, p99 = 0, max = 0;
+
+    sim_latency.unanswered += head - __atomic_load_n(&sim_latency.tail, __ATOMIC_ACQUIRE) + sim_latency.overflow;
+
+    if (count > 0) {
+        qsort(sim_latency.samples, count, sizeof(uint32_t), sim_latency_compare);
+        p50 = sim_latency.samples[(count - 1) * 50 / 100];
+        p99 = sim_latency.samples[(count - 1) * 99 / 100];
+        max = sim_latency.samples[count - 1];
+    }
+
+    printf("LATENCY,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n",
+           sim_latency.injected, count, sim_latency.queue_full, sim_latency.unanswered, p50, p99, max);
+    ESP_LOGI(TAG, "Input latency: p50 %" PRIu32 " us, p99 %" PRIu32 " us, max %" PRIu32 " us, "
+                  "dropped %" PRIu32 " (queue full) + %" PRIu32 " (no display response)",
+             p50, p99, max, sim_latency.queue_full, sim_latency.unanswered);
+    fflush(stdout);
+
+    const bool gate_failed = CONFIG_SIM_LATENCY_P99_LIMIT_US > 0 && p99 > CONFIG_SIM_LATENCY_P99_LIMIT_US;
+    if (gate_failed) { ESP_LOGE(TAG, "p99 latency exceeds %d us", CONFIG_SIM_LATENCY_P99_LIMIT_US); }
+    exit(gate_failed ? 1 : 0);
+}
+#endif
+
+/**************************************************************************************************
+ * Implementation // Input Devices
+ **************************************************************************************************/
+
+/**
+ * @brief 根据事件名查找输入事件
+ *
+ * @return 找到时返回事件, 否则返回 BSP_INPUT_EVENT_MAX
+ */
+static bsp_input_event_t sim_input_event_from_string(const char* name) {
+    for (int i = 0; i < BSP_INPUT_EVENT_MAX; i++) {
+        if (strcmp(name, bsp_input_event_to_string(i)) == 0) { return i; }
+    }
+    return BSP_INPUT_EVENT_MAX;
+}
+
+/* 原始输入事件的脚本名, 经手势识别后送入输入队列 */
+static const struct {
+    const char* name;
+    bsp_gesture_raw_type_t type;
+    bsp_gesture_key_t key;
+    int8_t direction;
+} sim_raw_inputs[] = {
+    {"RAW_PRESS_KNOB", BSP_GESTURE_RAW_PRESS, BSP_GESTURE_KEY_KNOB, 0},
+    {"RAW_RELEASE_KNOB", BSP_GESTURE_RAW_RELEASE, BSP_GESTURE_KEY_KNOB, 0},
+    {"RAW_PRESS_TOUCH_L", BSP_GESTURE_RAW_PRESS, BSP_GESTURE_KEY_TOUCH_L, 0},
+    {"RAW_RELEASE_TOUCH_L", BSP_GESTURE_RAW_RELEASE, BSP_GESTURE_KEY_TOUCH_L, 0},
+    {"RAW_PRESS_TOUCH_R", BSP_GESTURE_RAW_PRESS, BSP_GESTURE_KEY_TOUCH_R, 0},
+    {"RAW_RELEASE_TOUCH_R", BSP_GESTURE_RAW_RELEASE, BSP_GESTURE_KEY_TOUCH_R, 0},
+    {"RAW_DETENT_CW", BSP_GESTURE_RAW_DETENT, BSP_GESTURE_KEY_KNOB, 1},
+    {"RAW_DETENT_ACW", BSP_GESTURE_RAW_DETENT, BSP_GESTURE_KEY_KNOB, -1},
+};
+
+static bsp_gesture_engine_t sim_gesture_engine;
+static SemaphoreHandle_t sim_gesture_lock = NULL; // 脚本任务与定时器任务都会输入原始事件
+static TimerHandle_t sim_gesture_timer = NULL;     // 长按到期定时器
+
+/**
+ * @brief 把原始事件交给手势识别器, 对应硬件上的 bsp_input_feed
+ */
+static void sim_gesture_feed(const bsp_gesture_raw_type_t type, const bsp_gesture_key_t key, const int8_t direction) {
+    xSemaphoreTake(sim_gesture_lock, portMAX_DELAY);
+    const bsp_gesture_raw_t raw = {
+        .type = type,
+        .key = key,
+        .direction = direction,
+        .time_ms = (uint32_t)BSP_TICKS_TO_MS(xTaskGetTickCount()),
+    };
+    bsp_input_event_t events[BSP_GESTURE_OUT_MAX];
+    const int count = bsp_gesture_feed(&sim_gesture_engine, &raw, events, BSP_GESTURE_OUT_MAX);
+
+    uint32_t deadline_ms;
+    if (bsp_gesture_next_deadline(&sim_gesture_engine, &deadline_ms)) {
+        const int32_t wait_ms = (int32_t)(deadline_ms - raw.time_ms);
+        xTimerChangePeriod(sim_gesture_timer, BSP_MS_TO_TICKS(wait_ms > 0 ? wait_ms : 1), 0);
+    } else {
+        xTimerStop(sim_gesture_timer, 0);
+    }
+    xSemaphoreGive(sim_gesture_lock);
+
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "Gesture: %s", bsp_input_event_to_string(events[i]));
+        sim_latency_on_input(events[i]);
+    }
+}
+
+static void sim_gesture_timer_cb(__attribute__((unused)) TimerHandle_t timer) {
+    sim_gesture_feed(BSP_GESTURE_RAW_TICK, BSP_GESTURE_KEY_KNOB, 0);
+}
+
+/**
+ * @brief 根据脚本名查找原始输入事件
+ *
+ * @return 找到时返回下标, 否则返回 -1
+ */
+static int sim_raw_input_from_string(const char* name) {
+    for (int i = 0; i < sizeof(sim_raw_inputs) / sizeof(sim_raw_inputs[0]); i++) {
+        if (strcmp(name, sim_raw_inputs[i].name) == 0) { return i; }
+    }
+    return -1;
+}
+
+static bool sim_fault_inject(const char* name, uint64_t deadline_ms);
+static bool sim_fault_deadline_missed(void);
+static void sim_towel_hang(void);
+
+/**
+ * @brief [仿真任务]按脚本在指定虚拟时刻注入输入事件, 原始输入事件, NTC故障或输出内存报告
+ */
+static void sim_input_script_task(void* pvParameters) {
+    FILE* script = pvParameters;
+    char line[128];
+    int line_no = 0;
+
+    while (fgets(line, sizeof(line), script) != NULL) {
+        unsigned long long at_ms;
+        unsigned long long deadline_ms = 0;
+        char name[64];
+
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n') { continue; }
+        if (sscanf(line, "%llu %63s %llu", &at_ms, name, &deadline_ms) < 2) {
+            ESP_LOGW(TAG, "Input script line %d malformed", line_no);
+            continue;
+        }
+
+        const bsp_input_event_t event = sim_input_event_from_string(name);
+        const int raw = sim_raw_input_from_string(name);
+        const bool towel = strcmp(name, "TOWEL_WET") == 0;
+        const bool mem = strcmp(name, "MEM_REPORT") == 0;
+        if (event == BSP_INPUT_EVENT_MAX && raw < 0 && !towel && !mem && strncmp(name, "FAULT_", 6) != 0) {
+            ESP_LOGW(TAG, "Input script line %d: unknown event %s", line_no, name);
+            continue;
+        }
+
+        sim_delay_until_ms(at_ms);
+        if (event != BSP_INPUT_EVENT_MAX) {
+            sim_latency_on_input(event);
+        } else if (raw >= 0) {
+            sim_gesture_feed(sim_raw_inputs[raw].type, sim_raw_inputs[raw].key, sim_raw_inputs[raw].direction);
+        } else if (towel) {
+            sim_towel_hang();
+        } else if (mem) {
+            app_memory_report(); // 对应芯片命令行的 mem
+        } else if (!sim_fault_inject(name, deadline_ms)) {
+            ESP_LOGW(TAG, "Input script line %d: unknown fault %s", line_no, name);
+        }
+    }
+
+    ESP_LOGI(TAG, "Input script finished");
+    fclose(script);
+
+    /* 注入的故障带切断时限时, 时限到达仍未锁定加热器即判定失败 */
+    if (sim_fault_deadline_missed()) {
+        fflush(stdout);
+        exit(1);
+    }
+
+#if CONFIG_SIM_LATENCY_BENCH
+    /* 等待最后的事件结算完毕 */
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_SIM_LATENCY_TIMEOUT_MS));
+    sim_latency_report_and_exit();
+#endif
+
+    vTaskDelete(NULL);
+}
+
+APP_QUEUE_STORAGE(input_event, 10, sizeof(bsp_input_event_t));
+
+void bsp_input_init(void) {
+    /* 创建输入设备输入事件队列 */
+    bsp_input_queue = APP_QUEUE_CREATE(input_event, 10, sizeof(bsp_input_event_t));
+
+    /* 初始化手势识别器, 脚本中的原始输入事件经识别后送入输入队列 */
+    bsp_gesture_init(&sim_gesture_engine, bsp_gesture_table, bsp_gesture_table_len);
+    sim_gesture_lock = xSemaphoreCreateMutex();
+    sim_gesture_timer = xTimerCreate("SimGesture", 1, pdFALSE, NULL, sim_gesture_timer_cb);
+
+    /* 加载输入脚本, 环境变量优先于配置项 */
+    const char* path = getenv("TRC_SIM_INPUT");
+    if (path == NULL) { path = CONFIG_SIM_INPUT_SCRIPT; }
+    if (strlen(path) == 0) { return; }
+
+    FILE* script = fopen(path, "r");
+    if (script == NULL) {
+        ESP_LOGE(TAG, "Can't open input script %s", path);
+        return;
+    }
+    xTaskCreate(sim_input_script_task, "SimInputScript", 4096, script, 10, NULL);
+}
+
+QueueHandle_t bsp_input_get_queue(void) { return bsp_input_queue; }
+
+char* bsp_input_event_to_string(const bsp_input_event_t event) {
+    switch (event) {
+        case BSP_KNOB_ENCODER_ACW:
+            return "BSP_KNOB_ENCODER_ACW";
+        case BSP_KNOB_ENCODER_CW:
+            return "BSP_KNOB_ENCODER_CW";
+        case BSP_KNOB_LONG_PRESS:
+            return "BSP_KNOB_LONG_PRESS";
+        case BSP_KNOB_MT8_CLICK:
+            return "BSP_KNOB_MT8_CLICK";
+        case BSP_TOUCH_BUTTON_L_CLICK:
+            return "BSP_TOUCH_BUTTON_L_CLICK";
+        case BSP_TOUCH_BUTTON_R_CLICK:
+            return "BSP_TOUCH_BUTTON_R_CLICK";
+        case BSP_KNOB_HOLD_ENCODER_ACW:
+            return "BSP_KNOB_HOLD_ENCODER_ACW";
+        case BSP_KNOB_HOLD_ENCODER_CW:
+            return "BSP_KNOB_HOLD_ENCODER_CW";
+        case BSP_TOUCH_BUTTON_LR_CHORD:
+            return "BSP_TOUCH_BUTTON_LR_CHORD";
+        default:
+            return "BSP_UNKNOWN_INPUT_EVENT";
+    }
+}
+
+/**************************************************************************************************
+ * Implementation // LED Strip
+ **************************************************************************************************/
+
+static bsp_led_strip_mode_t sim_led_strip_mode = BSP_STRIP_OFF;
+
+void bsp_led_strip_init(void) { bsp_led_strip_write(BSP_STRIP_WHITE); }
+
+void bsp_led_strip_write(const bsp_led_strip_mode_t mode) {
+    static const char* const mode_names[] = {
+        [BSP_STRIP_OFF] = "OFF",       [BSP_STRIP_WHITE] = "WHITE", [BSP_STRIP_ORANGE] = "ORANGE",
+        [BSP_STRIP_GREEN] = "GREEN",   [BSP_STRIP_BLUE] = "BLUE",   [BSP_STRIP_RED] = "RED",
+    };
+
+    if (mode == sim_led_strip_mode) { return; }
+
+    sim_led_strip_mode = mode;
+    ESP_LOGI(TAG, "[LED Strip] %s", mode_names[mode]);
+}
+
+bsp_led_strip_mode_t bsp_sim_get_led_strip_mode(void) { return sim_led_strip_mode; }
+
+/**************************************************************************************************
+ * Implementation // Thermal Plant + Heating Control
+ *
+ * 毛巾架本体与NTC构成两节点热模型:
+ *   C * dTr/dt = P * u - G * (Tr - Ta) - E
+ *   tau * dTn/dt = Tr - Tn
+ * 其中 E 为湿毛巾的蒸发吸热, 恒速干燥阶段 E = Ge * (Tr - Ta), 含水量低于临界值后按比例下降.
+ * 每个加热通道是一台独立的毛巾架, 参数相同; 故障注入与挂毛巾只作用于通道0.
+ **************************************************************************************************/
+
+/* NTC故障注入类型 */
+typedef enum {
+    SIM_FAULT_NONE,
+    SIM_FAULT_READ_ERROR, // 读取失败
+    SIM_FAULT_OPEN,       // NTC开路
+    SIM_FAULT_SHORT,      // NTC短路
+    SIM_FAULT_DETACHED,   // NTC脱落, 读数停留在环境温度
+    SIM_FAULT_STUCK,      // 读数冻结在注入时刻的值
+    SIM_FAULT_MAX,
+} sim_fault_t;
+
+static const char* const sim_fault_names[SIM_FAULT_MAX] = {
+    [SIM_FAULT_NONE] = "FAULT_NONE",         [SIM_FAULT_READ_ERROR] = "FAULT_READ_ERROR",
+    [SIM_FAULT_OPEN] = "FAULT_OPEN",         [SIM_FAULT_SHORT] = "FAULT_SHORT",
+    [SIM_FAULT_DETACHED] = "FAULT_DETACHED", [SIM_FAULT_STUCK] = "FAULT_STUCK",
+};
+
+typedef struct {
+    float rack_temp;     // 毛巾架本体温度 Tr
+    float ntc_temp;      // NTC温度 Tn
+    bool heater_on;      // 加热器状态 u
+    uint64_t on_time_us; // 加热器累计开启时间
+    float towel_water;   // 毛巾剩余含水量 (g)
+} sim_channel_t;
+
+static struct {
+    uint64_t updated_ms;                             // 模型状态对应的虚拟时刻
+    sim_channel_t channels[BSP_HEATING_CHANNEL_NUM]; // 各通道的热模型
+    bool locked_out;                                 // 加热器是否被锁定
+    double energy_wh;                                // 所有加热器累计耗电量
+    uint64_t last_switch_on_ms;                      // 最近一次打开加热器的时刻
+    int last_switch_on_channel;                      // 最近一次打开的通道
+    uint64_t min_switch_on_gap_ms;                   // 不同通道先后打开的最短间隔 (浪涌叠加观测)
+    sim_fault_t fault;                               // 当前注入的故障 (通道0)
+    float fault_temp;                                // 故障状态下NTC的读数
+    uint64_t fault_onset_ms;                         // 故障注入时刻
+    uint64_t fault_deadline_ms;                      // 允许的最长切断延迟, 0 表示不检查
+} sim_plant = {0};
+
+/**
+ * @brief 将热模型推进到当前虚拟时刻, 调用者需持有 sim_lock
+ */
+static void sim_plant_advance(void) {
+    const uint64_t now_ms = bsp_sim_get_time_ms();
+
+    while (sim_plant.updated_ms < now_ms) {
+        uint64_t step_ms = now_ms - sim_plant.updated_ms;
+        if (step_ms > SIM_PLANT_STEP_MS) { step_ms = SIM_PLANT_STEP_MS; }
+
+        const float dt = (float)step_ms / 1000.0f;
+        for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+            sim_channel_t* c = &sim_plant.channels[ch];
+            const float power = c->heater_on ? sim_plant_config.heater_power : 0.0f;
+            const float loss = sim_plant_config.loss_conductance * (c->rack_temp - sim_plant_config.ambient_temp);
+
+            float evap = 0;
+            if (c->towel_water > 0 && c->rack_temp > sim_plant_config.ambient_temp) {
+                const float wetness = c->towel_water / (SIM_TOWEL_CRITICAL * sim_plant_config.towel_water);
+                evap = sim_plant_config.evap_conductance * (c->rack_temp - sim_plant_config.ambient_temp) *
+                       (wetness < 1.0f ? wetness : 1.0f);
+                c->towel_water -= evap * dt / SIM_WATER_LATENT_HEAT;
+                if (c->towel_water < 0) { c->towel_water = 0; }
+            }
+
+            c->rack_temp += (power - loss - evap) * dt / sim_plant_config.heat_capacity;
+            c->ntc_temp += (c->rack_temp - c->ntc_temp) * dt / sim_plant_config.ntc_lag;
+            sim_plant.energy_wh += power * dt / 3600.0;
+            if (c->heater_on) { c->on_time_us += step_ms * 1000; }
+        }
+        sim_plant.updated_ms += step_ms;
+    }
+}
+
+/**
+ * @brief 切换虚拟加热器状态, 并记录不同通道先后打开的最短间隔
+ */
+static void sim_plant_set_heater(const int channel, const bool on) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return; }
+
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_plant_advance();
+    sim_channel_t* c = &sim_plant.channels[channel];
+    const bool switch_on = on && !sim_plant.locked_out && !c->heater_on;
+    if (switch_on) {
+        const uint64_t gap_ms = sim_plant.updated_ms - sim_plant.last_switch_on_ms;
+        if (sim_plant.last_switch_on_channel != channel && gap_ms < sim_plant.min_switch_on_gap_ms) {
+            sim_plant.min_switch_on_gap_ms = gap_ms;
+        }
+        sim_plant.last_switch_on_ms = sim_plant.updated_ms;
+        sim_plant.last_switch_on_channel = channel;
+    }
+    c->heater_on = on && !sim_plant.locked_out;
+    xSemaphoreGive(sim_lock);
+}
+
+/**
+ * @brief 推进热模型并读取一个模型量
+ */
+static float sim_plant_read(const float* field) {
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_plant_advance();
+    const float value = *field;
+    xSemaphoreGive(sim_lock);
+    return value;
+}
+
+/**
+ * @brief 注入NTC故障, 故障一直持续到仿真结束
+ *
+ * @param name 故障名
+ * @param deadline_ms 允许的最长切断延迟 (虚拟ms), 0 表示只报告不检查
+ * @return 是否为有效的故障名
+ */
+static bool sim_fault_inject(const char* name, const uint64_t deadline_ms) {
+    for (int i = 0; i < SIM_FAULT_MAX; i++) {
+        if (strcmp(name, sim_fault_names[i]) != 0) { continue; }
+
+        xSemaphoreTake(sim_lock, portMAX_DELAY);
+        sim_plant_advance();
+        sim_plant.fault = i;
+        sim_plant.fault_temp = i == SIM_FAULT_DETACHED ? sim_plant_config.ambient_temp : sim_plant.channels[0].ntc_temp;
+        sim_plant.fault_onset_ms = sim_plant.updated_ms;
+        sim_plant.fault_deadline_ms = deadline_ms;
+        xSemaphoreGive(sim_lock);
+
+        ESP_LOGW(TAG, "[Fault] %s injected", name);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 等待注入故障的切断时限到达, 检查加热器是否已被锁定
+ *
+ * 未注入带时限的故障时立即返回. 锁定发生时 bsp_heating_lockout 已结束进程, 因此返回时必定未锁定.
+ *
+ * @return 是否超过时限仍未锁定加热器
+ */
+static bool sim_fault_deadline_missed(void) {
+    if (sim_plant.fault == SIM_FAULT_NONE || sim_plant.fault_deadline_ms == 0) { return false; }
+
+    sim_delay_until_ms(sim_plant.fault_onset_ms + sim_plant.fault_deadline_ms + 1);
+    if (sim_plant.locked_out) { return false; }
+
+    printf("FAULT,%s,none\n", sim_fault_names[sim_plant.fault]);
+    ESP_LOGE(TAG, "[Fault] heaters still on %llu ms after %s", (unsigned long long)sim_plant.fault_deadline_ms,
+             sim_fault_names[sim_plant.fault]);
+    return true;
+}
+
+/**
+ * @brief 在毛巾架上挂一条湿毛巾
+ */
+static void sim_towel_hang(void) {
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_plant_advance();
+    sim_plant.channels[0].towel_water = sim_plant_config.towel_water;
+    xSemaphoreGive(sim_lock);
+
+    ESP_LOGI(TAG, "[Towel] %d g of water hung", CONFIG_SIM_TOWEL_WATER_G);
+}
+
+/**
+ * @brief 根据NTC温度计算分压点ADC原始值 (NTC接地, 与固定电阻串联)
+ */
+static int sim_ntc_temp_to_raw(const float temp) {
+    const float r_ntc =
+        (float)BSP_BOARD_NTC_R25_OHM * expf((float)BSP_BOARD_NTC_B_VALUE * (1.0f / (temp + 273.15f) - 1.0f / 298.15f));
+    return (int)(BSP_NTC_ADC_RAW_MAX * r_ntc / (r_ntc + (float)BSP_BOARD_NTC_FIXED_OHM));
+}
+
+void bsp_heating_init(void) {
+    sim_plant.updated_ms = bsp_sim_get_time_ms();
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+        sim_plant.channels[ch] = (sim_channel_t){
+            .rack_temp = sim_plant_config.ambient_temp,
+            .ntc_temp = sim_plant_config.ambient_temp,
+        };
+    }
+    sim_plant.locked_out = false;
+    sim_plant.energy_wh = 0;
+    sim_plant.last_switch_on_channel = -1;
+    sim_plant.min_switch_on_gap_ms = UINT64_MAX;
+    sim_plant.fault = SIM_FAULT_NONE;
+}
+
+static int32_t sim_ntc_cal_gain = BSP_NTC_CAL_GAIN_ONE; // 单板两点校准增益 (Q16)
+static int32_t sim_ntc_cal_offset = 0;                  // 单板两点校准偏移 (m°C)
+
+esp_err_t bsp_heating_read_temp_uncalibrated(int32_t* milli_celsius) {
+    /* 模拟元件公差造成的读数误差 */
+    float temp = sim_plant_read(&sim_plant.channels[0].ntc_temp);
+    temp = temp * (1.0f + CONFIG_SIM_NTC_GAIN_ERROR_PERMILLE / 1000.0f) + CONFIG_SIM_NTC_OFFSET_ERROR / 1000.0f;
+
+    switch (sim_plant.fault) {
+        case SIM_FAULT_READ_ERROR:
+            return ESP_FAIL;
+        case SIM_FAULT_OPEN:
+            temp = -55.0f;
+            break;
+        case SIM_FAULT_SHORT:
+            temp = 200.0f;
+            break;
+        case SIM_FAULT_DETACHED:
+        case SIM_FAULT_STUCK:
+            temp = sim_plant.fault_temp;
+            break;
+        default:
+            break;
+    }
+
+    *milli_celsius = (int32_t)(temp * 1000);
+    return ESP_OK;
+}
+
+esp_err_t bsp_heating_channel_read_temp(const int channel, int32_t* milli_celsius) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return ESP_ERR_INVALID_ARG; }
+    if (channel > 0) {
+        *milli_celsius = (int32_t)(sim_plant_read(&sim_plant.channels[channel].ntc_temp) * 1000);
+        return ESP_OK;
+    }
+
+    int32_t temp;
+    const esp_err_t ret = bsp_heating_read_temp_uncalibrated(&temp);
+    if (ret != ESP_OK) { return ret; }
+
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    *milli_celsius = (int32_t)(((int64_t)temp * sim_ntc_cal_gain) >> 16) + sim_ntc_cal_offset;
+    xSemaphoreGive(sim_lock);
+    return ESP_OK;
+}
+
+void bsp_heating_set_ntc_calibration(const int32_t gain_q16, const int32_t offset_mC) {
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_ntc_cal_gain = gain_q16;
+    sim_ntc_cal_offset = offset_mC;
+    xSemaphoreGive(sim_lock);
+}
+
+esp_err_t bsp_heating_channel_read_ntc_raw(const int channel, int* raw) {
+    if (channel < 0 || channel >= BSP_HEATING_CHANNEL_NUM) { return ESP_ERR_INVALID_ARG; }
+    if (channel > 0) {
+        *raw = sim_ntc_temp_to_raw(sim_plant_read(&sim_plant.channels[channel].ntc_temp));
+        return ESP_OK;
+    }
+
+    switch (sim_plant.fault) {
+        case SIM_FAULT_READ_ERROR:
+            return ESP_FAIL;
+        case SIM_FAULT_OPEN:
+            *raw = BSP_NTC_ADC_RAW_MAX;
+            break;
+        case SIM_FAULT_SHORT:
+            *raw = 0;
+            break;
+        case SIM_FAULT_DETACHED:
+        case SIM_FAULT_STUCK:
+            *raw = sim_ntc_temp_to_raw(sim_plant.fault_temp);
+            break;
+        default:
+            *raw = sim_ntc_temp_to_raw(sim_plant_read(&sim_plant.channels[0].ntc_temp));
+            break;
+    }
+    return ESP_OK;
+}
+
+int bsp_heating_get_temp(void) {
+    int32_t milli_celsius;
+
+    if (bsp_heating_read_temp(&milli_celsius) == ESP_OK) {
+        return milli_celsius / 1000;
+    }
+
+    ESP_LOGE(TAG, "Failed to get temperature");
+    return 100;
+}
+
+void bsp_heating_channel_enable(const int channel) { sim_plant_set_heater(channel, true); }
+
+void bsp_heating_channel_disable(const int channel) { sim_plant_set_heater(channel, false); }
+
+bool bsp_heating_channel_is_enabled(const int channel) {
+    return channel >= 0 && channel < BSP_HEATING_CHANNEL_NUM && sim_plant.channels[channel].heater_on;
+}
+
+/**
+ * @brief 锁定加热器, 并报告从故障注入到切断加热器的虚拟时间
+ *
+ * 报告格式: FAULT,<故障名>,<切断延迟ms>
+ * 故障带切断时限时报告后结束进程, 延迟超过时限时退出码为1
+ */
+void bsp_heating_lockout(void) {
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_plant_advance();
+    const bool first = !sim_plant.locked_out;
+    sim_plant.locked_out = true;
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { sim_plant.channels[ch].heater_on = false; }
+    xSemaphoreGive(sim_lock);
+
+    if (first && sim_plant.fault != SIM_FAULT_NONE) {
+        const uint64_t latency_ms = sim_plant.updated_ms - sim_plant.fault_onset_ms;
+        printf("FAULT,%s,%llu\n", sim_fault_names[sim_plant.fault], (unsigned long long)latency_ms);
+        if (sim_plant.fault_deadline_ms > 0) {
+            const bool late = latency_ms > sim_plant.fault_deadline_ms;
+            if (late) {
+                ESP_LOGE(TAG, "[Fault] lockout latency %llu ms exceeds %llu ms", (unsigned long long)latency_ms,
+                         (unsigned long long)sim_plant.fault_deadline_ms);
+            }
+            fflush(stdout);
+            exit(late ? 1 : 0);
+        }
+    }
+}
+
+uint64_t bsp_heating_get_on_time_us(void) {
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_plant_advance();
+    uint64_t on_time_us = 0;
+    for (int ch = 0; ch < BSP_HEATING_CHANNEL_NUM; ch++) { on_time_us += sim_plant.channels[ch].on_time_us; }
+    xSemaphoreGive(sim_lock);
+    return on_time_us;
+}
+
+float bsp_sim_get_rack_temp(const int channel) { return sim_plant_read(&sim_plant.channels[channel].rack_temp); }
+
+float bsp_sim_get_ntc_temp(const int channel) { return sim_plant_read(&sim_plant.channels[channel].ntc_temp); }
+
+bool bsp_sim_get_heater_state(const int channel) { return sim_plant.channels[channel].heater_on; }
+
+float bsp_sim_get_towel_water(void) { return sim_plant_read(&sim_plant.channels[0].towel_water); }
+
+double bsp_sim_get_heater_energy_wh(void) {
+    xSemaphoreTake(sim_lock, portMAX_DELAY);
+    sim_plant_advance();
+    const double energy_wh = sim_plant.energy_wh;
+    xSemaphoreGive(sim_lock);
+    return energy_wh;
+}
+
+/**************************************************************************************************
+ * Implementation // Simulation Report
+ **************************************************************************************************/
+
+/**
+ * @brief [仿真任务]周期输出CSV状态报告, 并在仿真时长到达后结束进程
+ *
+ * 报告格式: SIM,<虚拟时间s>,<本体温度>,<NTC温度>,<加热器>,<耗电量Wh>,<显示内容>,<灯带模式>,<毛巾含水量g>
+ * 温度与加热器为通道0; 多通道时每个其余通道再追加 ,<本体温度>,<NTC温度>,<加热器>
+ */
+static void sim_report_task(__attribute__((unused)) void* pvParameters) {
+    const uint64_t interval_ms = CONFIG_SIM_REPORT_INTERVAL_S > 0 ? CONFIG_SIM_REPORT_INTERVAL_S * 1000ULL : 1000ULL;
+    const uint64_t duration_ms = CONFIG_SIM_DURATION_S * 1000ULL;
+    uint64_t next_ms = 0;
+
+    while (1) {
+        sim_delay_until_ms(next_ms);
+        next_ms += interval_ms;
+
+        const uint64_t now_ms = bsp_sim_get_time_ms();
+        if (CONFIG_SIM_REPORT_INTERVAL_S > 0) {
+            printf("SIM,%llu,%.2f,%.2f,%d,%.3f,%s,%d,%.1f", (unsigned long long)(now_ms / 1000),
+                   bsp_sim_get_rack_temp(0), bsp_sim_get_ntc_temp(0), bsp_sim_get_heater_state(0),
+                   bsp_sim_get_heater_energy_wh(), bsp_sim_get_display_content(), bsp_sim_get_led_strip_mode(),
+                   bsp_sim_get_towel_water());
+            for (int ch = 1; ch < BSP_HEATING_CHANNEL_NUM; ch++) {
+                printf(",%.2f,%.2f,%d", bsp_sim_get_rack_temp(ch), bsp_sim_get_ntc_temp(ch),
+                       bsp_sim_get_heater_state(ch));
+            }
+            printf("\n");
+        }
+
+        if (duration_ms > 0 && now_ms >= duration_ms) {
+            ESP_LOGI(TAG, "Simulation finished after %llu s, energy %.3f Wh", (unsigned long long)(now_ms / 1000),
+                     bsp_sim_get_heater_energy_wh());
+            bool staggered = true;
+            if (BSP_HEATING_CHANNEL_NUM > 1 && sim_plant.min_switch_on_gap_ms != UINT64_MAX) {
+                ESP_LOGI(TAG, "Shortest gap between switch-ons of different channels: %llu ms",
+                         (unsigned long long)sim_plant.min_switch_on_gap_ms);
+                staggered = sim_plant.min_switch_on_gap_ms >= CONFIG_APP_ZONE_STAGGER_MS;
+                if (!staggered) { ESP_LOGE(TAG, "Switch-ons closer than %d ms", CONFIG_APP_ZONE_STAGGER_MS); }
+            }
+            fflush(stdout);
+            exit(staggered ? 0 : 1);
+        }
+    }
+}
+
+/**************************************************************************************************
+ * Implementation // Initialize All Peripherals
+ **************************************************************************************************/
+void bsp_init_all(void) {
+    ESP_LOGI(TAG, "Board: %s", BSP_BOARD_NAME);
+
+    sim_lock = xSemaphoreCreateMutex();
+    sim_latency.lock = xSemaphoreCreateMutex();
+
+    ESP_LOGI(TAG, "Simulation board running at %dx real time", CONFIG_SIM_TIME_SCALE);
+
+    bsp_display_init();
+    bsp_led_strip_init();
+    bsp_heating_init();
+    bsp_input_init();
+
+    xTaskCreate(sim_report_task, "SimReport", 4096, NULL, 5, NULL);
+
+    vTaskDelay(BSP_MS_TO_TICKS(2000));   // 等待2s (自检)
+    bsp_display_write_str(NULL);         // 熄灭数码管
+    bsp_led_strip_write(BSP_STRIP_OFF);  // 熄灭LED灯带
+}
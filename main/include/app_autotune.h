@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 继电反馈 (Åström–Hägglund) PID自整定
+ *
+ * 自整定期间加热器以带回差的继电器方式围绕目标温度振荡, 由振幅与周期得到临界增益 Ku 与临界周期 Tu,
+ * 再按 Tyreus–Luyben 规则计算PID增益并写入NVS.
+ */
+typedef enum {
+    APP_AUTOTUNE_IDLE,    // 未运行
+    APP_AUTOTUNE_RUNNING, // 实验进行中
+    APP_AUTOTUNE_DONE,    // 已完成并保存增益
+    APP_AUTOTUNE_FAILED,  // 超时或振荡不可用
+} app_autotune_state_t;
+
+/**
+ * @brief 开始自整定, 由加热控制任务在后续周期中执行
+ *
+ * @param setpoint 目标温度 (°C)
+ */
+void app_autotune_start(int setpoint);
+
+void app_autotune_cancel(void);
+
+app_autotune_state_t app_autotune_get_state(void);
+
+/**
+ * @brief 执行一个控制周期的继电实验
+ *
+ * @param temp 当前温度 (m°C)
+ * @param dt_ms 距上一次调用的时间 (ms)
+ * @return 本周期加热器是否打开
+ */
+bool app_autotune_step(int32_t temp, uint32_t dt_ms);
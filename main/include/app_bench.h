@@ -0,0 +1,21 @@
+#pragma once
+
+/**
+ * @brief BSP与应用基础函数的微基准测试
+ *
+ * 基准测试构建 (CONFIG_APP_BENCH_ENABLE) 中 app_main 初始化外设后只运行本测试, 不启动应用任务.
+ * 每个被测函数在新建的任务中循环调用 CONFIG_APP_BENCH_ITERATIONS 次, 逐次计时, 输出:
+ *
+ *   BENCH_INFO,<目标>,<计时单位>,<CPU频率MHz>
+ *   BENCH,<名称>,<计时单位>,<次数>,<min>,<p50>,<p99>,<max>,<栈用量B>,<堆增量B>
+ *   BENCH_END
+ *
+ * 计时单位在芯片 (含QEMU) 上为CPU周期, 在linux目标上为ns. 第一行 overhead 为空函数的开销,
+ * 其余各行未扣除. 栈用量为测试任务栈的高水位, 含测试循环自身约为 overhead 一行的值,
+ * linux目标的任务运行在宿主线程栈上, 输出 -1. 堆增量为测试前后已分配堆内存之差, 含首次调用.
+ */
+
+/**
+ * @brief 依次运行全部基准测试并输出结果, linux目标上结束后退出进程
+ */
+void app_bench_run(void);
@@ -0,0 +1,6 @@
+#pragma once
+
+/**
+ * @brief 启动串口命令行并注册应用命令
+ */
+void app_console_init(void);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 共享线路上多台控制器的峰值功率协调
+ *
+ * 同一局域网内的控制器周期性地在UDP组播上公告自己的加热需求 (W). 各节点看到相同的节点集合,
+ * 用相同的确定性算法计算分时计划:
+ *   - 总需求不超过功率上限 (各节点 CONFIG_APP_COORD_CAP_W 的最小值) 时不做限制;
+ *   - 超过时每个节点只在窗口中属于自己的时段加热. 时段按节点号排序依次错开, 长度按
+ *     "上限内可同时加热的最大节点数" 折算, 需求相同的节点同时加热的总功率不超过上限.
+ * 窗口相位跟随节点号最小的节点, 不依赖时钟同步.
+ *
+ * 需求从无到有时先等待两个公告周期, 使其他节点的公告到达后再加热, 避免同时开机的控制器一起打开加热器.
+ * 网络不可用或收不到其他节点时退化为独立运行, 不限制加热.
+ */
+
+typedef struct {
+    uint32_t node_id;        // 本节点号
+    int peers;               // 在线的其他节点数
+    uint32_t total_demand_w; // 所有节点的总需求
+    uint32_t cap_w;          // 生效的功率上限
+    bool limited;            // 是否正在分时
+    uint32_t share_permille; // 本节点在每个窗口中可加热的比例
+    uint32_t window_ms;      // 窗口长度
+    uint32_t offset_ms;      // 本节点时段在窗口中的起点
+    bool online;             // 组播套接字是否可用
+} app_coord_status_t;
+
+/**
+ * @brief 启动协调任务
+ */
+void app_coord_init(void);
+
+/**
+ * @brief 更新本节点的加热需求, 需求变化时立即公告
+ *
+ * @param demand_w 开启的加热通道的额定功率之和, 关机时为0
+ */
+void app_coord_set_demand(uint32_t demand_w);
+
+/**
+ * @brief 当前时刻本节点是否允许加热
+ */
+bool app_coord_may_heat(void);
+
+void app_coord_get_status(app_coord_status_t* status);
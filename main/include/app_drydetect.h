@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 毛巾干燥检测
+ *
+ * 湿毛巾蒸发吸热, 维持目标温度所需的加热占空比明显偏高; 毛巾干燥后占空比回落并稳定在
+ * 干燥基线附近. 检测器在到达目标温度后按窗口统计占空比, 相邻窗口的占空比接近时认为已经平稳,
+ * 再与按 (目标温度 - 环境温度) 归一化的学习基线比较.
+ * 尚未学到基线时, 以占空比相对本次开机峰值的回落幅度判断.
+ */
+
+/**
+ * @brief 开始新的加热过程, 清除检测状态
+ */
+void app_drydetect_reset(void);
+
+/**
+ * @brief 输入一个控制周期的加热器状态
+ *
+ * @param heater_on 本周期加热器是否打开
+ * @param temp 当前温度 (m°C)
+ * @param target 目标温度 (°C)
+ * @param dt_ms 控制周期 (ms)
+ * @return 本次加热过程中首次判定毛巾已干燥时返回 true
+ */
+bool app_drydetect_update(bool heater_on, int32_t temp, int target, uint32_t dt_ms);
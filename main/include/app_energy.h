@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief 加热器电能计量
+ *
+ * 按加热器累计开启时间 × 额定功率 (板级描述表 HEATER_RATED_W, 可由 CONFIG_APP_ENERGY_RATED_POWER_W 覆盖) 积分电能,
+ * 统计本次开机与累计两个计数器, 累计值定期写入NVS.
+ */
+typedef struct {
+    uint32_t session_wh;   // 本次开机耗电量 (Wh)
+    uint64_t lifetime_wh;  // 累计耗电量 (Wh)
+    uint32_t session_on_s; // 本次开机加热器开启时间 (s)
+} app_energy_snapshot_t;
+
+/**
+ * @brief 载入累计耗电量并启动计量任务
+ */
+void app_energy_init(void);
+
+/**
+ * @brief 开始新的开机计量
+ */
+void app_energy_session_start(void);
+
+/**
+ * @brief 结束本次开机计量并尽快保存累计值
+ */
+void app_energy_session_end(void);
+
+/**
+ * @brief 获取当前计量结果, 可供显示/命令行/遥测使用
+ */
+void app_energy_get_snapshot(app_energy_snapshot_t* snapshot);
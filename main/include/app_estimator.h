@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief 毛巾架温度估计器
+ *
+ * 两节点一阶热模型 (毛巾架本体 Tr, NTC Tn), 以稳态卡尔曼增益融合NTC读数:
+ *   Tr' = Tr + dt * (heat_rate * u - (Tr - Ta) / loss_tau)
+ *   Tn' = Tn + dt * (Tr - Tn) / ntc_tau
+ *   e = y - Tn', Tr' += Kr * e, Tn' += Kn * e
+ * 全部运算为定点数: 温度单位 m°C, 增益为 Q15. 控制周期随温度状态在 1-16s 间变化,
+ * 增益按 √(dt / CONFIG_APP_ESTIMATOR_GAIN_DT_MS) 折算到实际周期.
+ */
+typedef struct {
+    int32_t rack_temp;   // 估计的毛巾架本体温度 (m°C)
+    int32_t ntc_temp;    // 估计的NTC温度 (m°C)
+    int32_t innovation;  // 最近一次的测量残差 (m°C)
+} app_estimator_t;
+
+/**
+ * @brief 用一次NTC读数初始化估计器, 假设此时系统处于热平衡
+ */
+void app_estimator_init(app_estimator_t* est, int32_t ntc_temp);
+
+/**
+ * @brief 推进一个控制周期并融合新的NTC读数
+ *
+ * @param est 估计器
+ * @param ntc_temp NTC读数 (m°C)
+ * @param duty_permille 上一周期加热器占空比 (‰)
+ * @param dt_ms 周期长度 (ms)
+ * @return 估计的毛巾架本体温度 (m°C)
+ */
+int32_t app_estimator_update(app_estimator_t* est, int32_t ntc_temp, uint32_t duty_permille, uint32_t dt_ms);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief 温度历史记录
+ *
+ * 周期采样写入专用数据分区 (partitions.csv 中的 history 分区) 构成的环形日志.
+ * 分区按擦除扇区划分为定长页, 页头保存该页首个采样的完整值, 其后的采样以
+ * "状态字节 + 时间/温度/占空比差分的 zigzag varint" 编码. 编码后的数据先在RAM中攒批再写入,
+ * 只有写满一页时才擦除下一页, 各页循环使用实现磨损均衡. 启动时在最后一页的末尾续写, 先写入一条
+ * 带启动序号与完整采样的启动记录, 频繁重启也不会每次擦除一页.
+ */
+
+/* 采样状态位 */
+#define APP_HISTORY_STATE_ON          (1 << 0) // 系统开启
+#define APP_HISTORY_STATE_HEATER      (1 << 1) // 采样时加热器开启
+#define APP_HISTORY_STATE_READ_ERROR  (1 << 2) // NTC读取失败, 温度沿用上一个采样
+#define APP_HISTORY_STATE_FAULT_SHIFT 3        // 安全故障码 (3位)
+#define APP_HISTORY_STATE_FAULT_MASK  (0x7 << APP_HISTORY_STATE_FAULT_SHIFT)
+
+typedef struct {
+    uint16_t boot;   // 启动序号
+    uint32_t time_s; // 启动后经过的时间 (s)
+    int32_t temp_dc; // NTC温度 (0.1°C)
+    uint16_t duty;   // 上一个采样周期的加热占空比 (‰)
+    uint8_t state;   // APP_HISTORY_STATE_*
+} app_history_sample_t;
+
+/**
+ * @brief 流式读取器, 按时间顺序逐个解码采样, 只缓存一小块flash数据
+ */
+typedef struct {
+    uint32_t page;             // 当前页
+    uint32_t seq;              // 当前页序号
+    uint32_t offset;           // 当前页内读取位置
+    bool header_pending;       // 下一个采样为页头中的首个采样
+    bool done;                 // 是否已读完
+    app_history_sample_t last; // 上一个采样 (差分基准)
+    uint8_t chunk[64];         // flash读取缓存
+    uint32_t chunk_offset;     // 缓存对应的页内偏移
+    uint32_t chunk_len;        // 缓存有效长度
+} app_history_reader_t;
+
+typedef struct {
+    uint32_t page_count; // 分区总页数
+    uint32_t page_size;  // 页大小 (B)
+    uint16_t boot;       // 本次启动序号
+    uint32_t head_seq;   // 当前写入页序号
+} app_history_info_t;
+
+/**
+ * @brief 挂载历史分区并启动采样任务
+ */
+esp_err_t app_history_init(void);
+
+/**
+ * @brief 将攒批缓存立即写入flash
+ */
+esp_err_t app_history_flush(void);
+
+/**
+ * @brief 从最早的页开始读取, 打开前会先写入攒批缓存
+ */
+esp_err_t app_history_reader_open(app_history_reader_t* reader);
+
+/**
+ * @brief 读取下一个采样
+ *
+ * @return 读到采样时返回 true, 读完时返回 false
+ */
+bool app_history_reader_next(app_history_reader_t* reader, app_history_sample_t* sample);
+
+void app_history_get_info(app_history_info_t* info);
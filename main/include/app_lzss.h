@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 流式LZSS解压 (heatshrink 格式)
+ *
+ * 码流按位从高到低读取, 每个记号以1位标志开头:
+ *   1 + 8位字面量
+ *   0 + W位 (距离-1) + L位 (长度-1), 从已输出数据中距离当前位置 "距离" 字节处复制 "长度" 字节
+ * 与 heatshrink -w APP_LZSS_WINDOW_BITS -l APP_LZSS_LOOKAHEAD_BITS 的输出兼容.
+ * 解压只需要一个 2^W 字节的窗口, 输入可以任意切分.
+ */
+#define APP_LZSS_WINDOW_BITS    10
+#define APP_LZSS_LOOKAHEAD_BITS 5
+#define APP_LZSS_WINDOW_SIZE    (1 << APP_LZSS_WINDOW_BITS)
+
+typedef struct {
+    uint8_t window[APP_LZSS_WINDOW_SIZE]; // 最近输出的数据
+    uint16_t head;                        // 窗口中下一个写入位置
+    uint32_t bits;                        // 未消费的输入位, 低 bit_count 位有效
+    uint8_t bit_count;                    // bits 中的有效位数
+    uint16_t copy_distance;               // 进行中的回溯复制的距离
+    uint16_t copy_remaining;              // 进行中的回溯复制剩余的字节数
+} app_lzss_decoder_t;
+
+void app_lzss_init(app_lzss_decoder_t* dec);
+
+/**
+ * @brief 解压一段输入
+ *
+ * 输出缓冲区写满或输入耗尽时返回, 未消费的输入通过 in/in_len 留给下一次调用.
+ * 码流末尾不足一个记号的填充位会留在解压器中, 由调用者按原始长度判断结束.
+ *
+ * @param dec 解压器
+ * @param[in,out] in 输入数据, 返回时指向第一个未消费的字节
+ * @param[in,out] in_len 输入长度, 返回时为剩余长度
+ * @param out 输出缓冲区
+ * @param out_cap 输出缓冲区容量
+ * @return 写入 out 的字节数
+ */
+size_t app_lzss_decode(app_lzss_decoder_t* dec, const uint8_t** in, size_t* in_len, uint8_t* out, size_t out_cap);
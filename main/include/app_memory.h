@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/**************************************************************************************************
+ * 任务/队列/互斥锁的创建辅助宏
+ *
+ * CONFIG_USE_STATIC_ALLOCATION 打开时使用 APP_*_STORAGE 定义的静态存储创建, 运行期不占用堆;
+ * 关闭时退化为堆分配. 创建的任务都会登记到内存报告中.
+ * 注意 ESP-IDF 中任务栈大小以字节为单位.
+ **************************************************************************************************/
+
+#if CONFIG_USE_STATIC_ALLOCATION
+
+#define APP_TASK_STORAGE(name, stack_size)                                                              \
+    static StackType_t name##_stack[(stack_size) / sizeof(StackType_t)];                                \
+    static StaticTask_t name##_tcb
+
+#define APP_TASK_CREATE(name, fn, label, param, priority, handle)                                       \
+    app_memory_track_task(                                                                              \
+        xTaskCreateStatic(fn, label, sizeof(name##_stack) / sizeof(StackType_t), param, priority,       \
+                          name##_stack, &name##_tcb),                                                   \
+        sizeof(name##_stack), true, handle                                                              \
+    )
+
+#define APP_QUEUE_STORAGE(name, length, item_size)                                                      \
+    static uint8_t name##_queue_buffer[(length) * (item_size)];                                         \
+    static StaticQueue_t name##_queue
+
+#define APP_QUEUE_CREATE(name, length, item_size)                                                       \
+    xQueueCreateStatic(length, item_size, name##_queue_buffer, &name##_queue)
+
+#define APP_MUTEX_STORAGE(name) static StaticSemaphore_t name##_mutex
+
+#define APP_MUTEX_CREATE(name) xSemaphoreCreateMutexStatic(&name##_mutex)
+
+#else
+
+#define APP_TASK_STORAGE(name, stack_size) static const uint32_t name##_stack_size = (stack_size)
+
+#define APP_TASK_CREATE(name, fn, label, param, priority, handle)                                       \
+    do {                                                                                                \
+        TaskHandle_t handle_ = NULL;                                                                    \
+        xTaskCreate(fn, label, name##_stack_size, param, priority, &handle_);                           \
+        app_memory_track_task(handle_, name##_stack_size, false, handle);                               \
+    } while (0)
+
+#define APP_QUEUE_STORAGE(name, length, item_size)
+
+#define APP_QUEUE_CREATE(name, length, item_size) xQueueCreate(length, item_size)
+
+#define APP_MUTEX_STORAGE(name)
+
+#define APP_MUTEX_CREATE(name) xSemaphoreCreateMutex()
+
+#endif
+
+/**
+ * @brief 登记任务, 用于内存报告
+ *
+ * @param task 任务句柄
+ * @param stack_size 栈大小 (B)
+ * @param is_static 栈是否为静态存储
+ * @param[out] handle 可选, 输出任务句柄
+ */
+void app_memory_track_task(TaskHandle_t task, uint32_t stack_size, bool is_static, TaskHandle_t* handle);
+
+/**
+ * @brief 输出内存占用报告: 静态存储, 堆使用情况与各任务栈高水位
+ */
+void app_memory_report(void);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief NTC两点校准
+ *
+ * 在两个参考温度下 (例如室温与热水浴, 以参考温度计读数为准) 各采集一次未校准读数, 拟合出
+ * 校准后温度 = 增益 × 未校准温度 + 偏移, 保存到NVS并交由BSP在每次采样时应用.
+ */
+typedef struct {
+    bool calibrated;         // 是否已校准
+    int32_t gain_q16;        // 增益 (Q16)
+    int32_t offset_mC;       // 偏移 (m°C)
+    bool captured[2];        // 两个校准点是否已采集
+    int32_t measured_mC[2];  // 校准点的未校准读数 (m°C)
+    int32_t reference_mC[2]; // 校准点的参考温度 (m°C)
+} app_ntc_cal_status_t;
+
+/**
+ * @brief 将NVS中保存的校准系数交给BSP, 应在 bsp_init_all 之后调用
+ */
+void app_ntc_cal_init(void);
+
+/**
+ * @brief 丢弃已采集的校准点, 开始新一次校准
+ */
+void app_ntc_cal_begin(void);
+
+/**
+ * @brief 采集一个校准点: 对未校准读数取 CONFIG_APP_NTC_CAL_SAMPLES 次平均
+ *
+ * @param point 校准点序号, 0 或 1
+ * @param reference_mC 参考温度计读数 (m°C)
+ * @return ESP_OK 成功; ESP_ERR_INVALID_ARG 序号无效; 其他 NTC读取失败
+ */
+esp_err_t app_ntc_cal_capture(int point, int32_t reference_mC);
+
+/**
+ * @brief 由两个校准点计算校准系数, 检查合理性后保存并立即生效
+ *
+ * @return ESP_OK 成功; ESP_ERR_INVALID_STATE 校准点未采集齐; ESP_ERR_INVALID_ARG 两点间距过小或系数超出范围
+ */
+esp_err_t app_ntc_cal_commit(void);
+
+/**
+ * @brief 清除校准系数, 恢复标称NTC参数
+ */
+esp_err_t app_ntc_cal_reset(void);
+
+/**
+ * @brief 获取当前校准系数与校准点
+ */
+void app_ntc_cal_get_status(app_ntc_cal_status_t* status);
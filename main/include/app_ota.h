@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief 压缩固件OTA升级
+ *
+ * 升级包由 tools/ota_pack.py 生成 (包头 + LZSS压缩镜像), 在低优先级任务中通过HTTP流式下载,
+ * 边下载边解压写入空闲的OTA分区, 不缓存整个镜像, 也不影响加热控制任务.
+ * 写入完成后校验镜像SHA-256与应用镜像格式, 通过后切换启动分区, 重启生效.
+ *
+ * 新镜像首次启动时处于待验证状态, 运行 CONFIG_APP_OTA_HEALTH_CHECK_S 后通过健康检查才确认有效;
+ * 健康检查失败或在此之前复位, bootloader 会回滚到上一个镜像.
+ */
+typedef enum {
+    APP_OTA_IDLE,        // 未进行升级
+    APP_OTA_DOWNLOADING, // 正在下载并写入
+    APP_OTA_READY,       // 已写入并切换启动分区, 等待重启
+    APP_OTA_FAILED,      // 下载, 校验或写入失败
+    APP_OTA_CANCELLED,   // 被取消
+} app_ota_state_t;
+
+typedef struct {
+    app_ota_state_t state;
+    uint32_t image_size;    // 解压后镜像大小, 收到包头前为0
+    uint32_t written;       // 已写入OTA分区的字节数
+    uint32_t received;      // 已下载的升级包字节数
+    esp_err_t last_error;   // 最近一次失败的原因
+} app_ota_status_t;
+
+/**
+ * @brief 启动OTA任务; 当前镜像待验证时在任务中执行启动健康检查
+ */
+void app_ota_init(void);
+
+/**
+ * @brief 开始异步升级, 立即返回
+ *
+ * @param url 升级包地址 (http:// 或 https://)
+ * @return ESP_OK 已开始; ESP_ERR_INVALID_STATE 升级正在进行; ESP_ERR_INVALID_ARG 地址过长
+ */
+esp_err_t app_ota_start(const char* url);
+
+/**
+ * @brief 取消进行中的升级, 已写入的数据被丢弃, 启动分区保持不变
+ */
+void app_ota_cancel(void);
+
+void app_ota_get_status(app_ota_status_t* status);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 加热PID控制器, 输出为加热器占空比 (‰)
+ *
+ * 微分项作用于测量值以避免设定值突变引起冲击, 积分项在输出饱和时停止累积 (条件积分抗饱和).
+ */
+typedef struct {
+    float kp;         // 比例增益 (‰/°C)
+    float ki;         // 积分增益 (‰/(°C·s))
+    float kd;         // 微分增益 (‰·s/°C)
+    float integral;   // 积分项 (‰)
+    float last_input; // 上一次测量值 (°C)
+    bool primed;      // 是否已有上一次测量值
+} app_pid_t;
+
+void app_pid_init(app_pid_t* pid, float kp, float ki, float kd);
+
+/**
+ * @brief 计算一个控制周期的输出
+ *
+ * @param pid 控制器
+ * @param setpoint 目标温度 (°C)
+ * @param input 当前温度 (°C)
+ * @param dt_s 周期长度 (s)
+ * @return 加热器占空比 (‰), 范围 [0, 1000]
+ */
+uint32_t app_pid_update(app_pid_t* pid, float setpoint, float input, float dt_s);
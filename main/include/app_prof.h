@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief 统计采样CPU剖析器
+ *
+ * 使用一个独立的GPTimer以高优先级中断周期采样, 记录被中断的指令地址 (mepc) 与当前任务,
+ * 累计到固定大小的直方图中, 采样期间不分配内存也不输出日志. 被中断的代码本身在中断中时
+ * (如数码管刷新定时器回调), 任务记为 ISR. 只记录叶子函数, 不展开调用栈.
+ *
+ * 结果通过串口按行输出, 由 tools/profile_fold.py 对照ELF符号化后生成折叠栈 (flamegraph.pl, speedscope):
+ *
+ *   PROF_INFO,<采样频率Hz>,<采样数>,<丢弃数>,<采样时长ms>
+ *   PROF_TASK,<任务序号>,<任务名>
+ *   PROF,<指令地址hex>,<任务序号>,<次数>
+ *   PROF_END
+ *
+ * 直方图槽位用尽时新的地址计入丢弃数, 可增大 CONFIG_APP_PROF_SLOTS 或缩短采样时间.
+ */
+
+typedef struct {
+    bool running;
+    uint32_t rate_hz;     // 采样频率
+    uint32_t samples;     // 已记录的采样数
+    uint32_t dropped;     // 直方图已满而丢弃的采样数
+    uint32_t slots_used;  // 已使用的直方图槽位
+    uint32_t duration_ms; // 累计采样时长
+} app_prof_status_t;
+
+/**
+ * @brief 清空直方图并开始采样
+ *
+ * @param rate_hz 采样频率, 0 为 CONFIG_APP_PROF_RATE_HZ
+ * @return ESP_OK; ESP_ERR_INVALID_STATE 正在采样; ESP_ERR_INVALID_ARG 频率超出范围; 其他为定时器创建失败
+ */
+esp_err_t app_prof_start(uint32_t rate_hz);
+
+/**
+ * @brief 停止采样, 直方图保留到下次开始
+ */
+void app_prof_stop(void);
+
+/**
+ * @brief 输出直方图, 正在采样时先停止
+ */
+void app_prof_dump(void);
+
+void app_prof_get_status(app_prof_status_t* status);
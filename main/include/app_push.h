@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief WebSocket 状态推送
+ *
+ * 在 CONFIG_APP_PUSH_PORT 上监听 WebSocket 连接 (任意路径), 系统状态变化时向每个客户端推送
+ * 只含变化字段的 JSON 文本帧, 客户端无需轮询. 连接建立后先推送一次完整状态:
+ *
+ *   {"setpoint":50,"temp":45.3,"mode":"on","remaining":170}
+ *
+ *   setpoint  目标温度 (°C), 关机时为0
+ *   temp      通道0参与控制的温度 (°C, 0.1分辨率), 在加热控制周期中更新
+ *   mode      "off" | "on" | "autotune" | "fault"
+ *   remaining 定时关机剩余时间 (min), 0 为未定时
+ *
+ * 每个客户端有独立的发送缓冲区, 上一帧未完全写入套接字前不生成新帧, 期间的变化只记入待发送字段,
+ * 缓冲区排空后合并为一帧发送当前值; 同一客户端两帧的间隔不小于 CONFIG_APP_PUSH_MIN_INTERVAL_MS.
+ * 慢速客户端因此只会少收中间值, 不会积压内存. 发送停滞超过 CONFIG_APP_PUSH_STALL_TIMEOUT_S 的连接被关闭.
+ *
+ * 仿真板上可用 tools/push_watch.py 连接测试, 见 sdkconfig.sim.push.
+ */
+
+typedef enum {
+    APP_PUSH_MODE_OFF,
+    APP_PUSH_MODE_ON,
+    APP_PUSH_MODE_AUTOTUNE,
+    APP_PUSH_MODE_FAULT,
+} app_push_mode_t;
+
+typedef struct {
+    int setpoint;         // 目标温度 (°C)
+    int32_t temperature;  // 通道0参与控制的温度 (m°C)
+    app_push_mode_t mode; // 运行模式
+    int remaining_min;    // 定时关机剩余时间 (min)
+} app_push_state_t;
+
+typedef struct {
+    bool listening;   // 监听套接字是否可用
+    int clients;      // 已建立的 WebSocket 连接数
+    uint32_t updates; // 有字段变化的状态发布次数
+    uint32_t frames;  // 已发送的状态帧数, 所有客户端之和
+    uint32_t merged;  // 因客户端未就绪而合并到后续帧中的更新次数, 所有客户端之和
+    uint32_t dropped; // 因发送停滞被关闭的连接数
+} app_push_status_t;
+
+/**
+ * @brief 启动推送任务, 需在网络初始化之后调用
+ */
+void app_push_init(void);
+
+/**
+ * @brief 发布当前系统状态, 与上次发布的状态比较, 有变化的字段推送给所有客户端
+ *
+ * 只复制状态并标记待发送字段, 不访问网络, 可在启动推送任务之前调用.
+ */
+void app_push_update(const app_push_state_t* state);
+
+void app_push_get_status(app_push_status_t* status);
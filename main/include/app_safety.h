@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * @brief 安全监控故障码, 数值即数码管上显示的 "E<n>"
+ */
+typedef enum {
+    APP_SAFETY_FAULT_NONE = 0,
+    APP_SAFETY_FAULT_SENSOR_READ = 1,  // NTC连续读取失败
+    APP_SAFETY_FAULT_SENSOR_OPEN = 2,  // NTC开路
+    APP_SAFETY_FAULT_SENSOR_SHORT = 3, // NTC短路
+    APP_SAFETY_FAULT_IMPLAUSIBLE = 4,  // 温度超出合理范围
+    APP_SAFETY_FAULT_RATE_OF_RISE = 5, // 升温速率过快
+    APP_SAFETY_FAULT_NO_RISE = 6,      // 持续加热但温度不上升
+} app_safety_fault_t;
+
+/**
+ * @brief 启动安全监控任务
+ */
+void app_safety_init(void);
+
+/**
+ * @brief 获取锁存的故障码, 故障一旦发生保持到重启
+ */
+app_safety_fault_t app_safety_get_fault(void);
@@ -1,12 +1,26 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "esp_err.h"
 
 typedef struct {
     uint8_t magic;
     bool dev_adopted;
+    bool pid_tuned;              // 是否已完成PID自整定
+    float pid_kp;                // 比例增益 (‰/°C)
+    float pid_ki;                // 积分增益 (‰/(°C·s))
+    float pid_kd;                // 微分增益 (‰·s/°C)
+    float dry_baseline;          // 干燥时维持温度所需占空比 (‰/°C, 按目标与环境温差归一化), 0为未学习
+    uint64_t energy_lifetime_mj; // 累计耗电量 (mJ)
+    int32_t ntc_cal_gain;        // NTC两点校准增益 (Q16, 65536为1), 0为未校准
+    int32_t ntc_cal_offset;      // NTC两点校准偏移 (m°C)
+    bool comfort_set;            // 是否设置过电价规划的舒适时段
+    int16_t comfort_start_min;   // 舒适时段开始 (本地时间, 分钟)
+    int16_t comfort_end_min;     // 舒适时段结束, 与开始相同表示全天
+    int64_t time_saved_utc_s;    // 最近保存的UTC时间 (s), 0为未保存
+    int32_t time_drift_ppb;      // 本地时钟频率偏差估计 (ppb, 正为偏快)
 } sys_param_t;
 
 esp_err_t settings_read_parameter_from_nvs(void);
@@ -16,3 +30,27 @@ esp_err_t settings_write_parameter_to_nvs(void);
 bool settings_get_dev_adopted(void);
 
 void settings_set_dev_adopted(void);
+
+bool settings_get_pid_gains(float* kp, float* ki, float* kd);
+
+void settings_set_pid_gains(float kp, float ki, float kd);
+
+float settings_get_dry_baseline(void);
+
+void settings_set_dry_baseline(float baseline);
+
+uint64_t settings_get_energy_lifetime_mj(void);
+
+void settings_set_energy_lifetime_mj(uint64_t energy_mj);
+
+bool settings_get_ntc_calibration(int32_t* gain_q16, int32_t* offset_mC);
+
+void settings_set_ntc_calibration(int32_t gain_q16, int32_t offset_mC);
+
+bool settings_get_tariff_comfort(int* start_min, int* end_min);
+
+void settings_set_tariff_comfort(int start_min, int end_min);
+
+bool settings_get_time(int64_t* utc_s, int32_t* drift_ppb);
+
+void settings_set_time(int64_t utc_s, int32_t drift_ppb);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "app_tariff_plan.h"
+
+/**
+ * @brief 分时电价加热规划
+ *
+ * 电价表以JSON推送到设备 (芯片上周期性地从 CONFIG_APP_TARIFF_URL 下载, 模拟板从文件读取):
+ *   {"now": 1767225600, "utc_offset_s": 3600, "start": 1767225600, "slot_s": 1800, "prices": [215, 198, ...]}
+ * now/start 为Unix时间 (s), prices 为各时段电价 (0.001货币单位/kWh). now 用于设定设备时钟,
+ * 设备在两次下载之间按系统节拍推算当前时间; 启用时间服务 (app_time.h) 且时间可信时以时间服务为准.
+ *
+ * 开机期间按用户设定的舒适时段调用 app_tariff_plan 规划加热 (见 app_tariff_plan.h), 在时段切换,
+ * 目标温度/舒适时段变化或电价表更新时重新规划. 每个舒适时段结束时输出一行结构化日志
+ *   TARIFF,<舒适时段开始(本地时间s)>,<预期电费>,<不规划时的电费>,<实际电费>   (0.001货币单位)
+ * 实际电费按加热器开启时间 × 额定功率 × 当时电价累计.
+ *
+ * 未载入电价表, 时钟未知或电价表不覆盖当前时刻时规划器不生效, 按目标温度正常加热.
+ */
+
+typedef struct {
+    bool schedule_loaded;      // 是否已载入电价表
+    int64_t now_s;             // 当前本地时间 (s), 时钟未知时为0
+    uint32_t price;            // 当前电价 (0.001货币单位/kWh), 不在电价表范围内时为0
+    bool active;               // 规划是否生效
+    int8_t offset;             // 当前目标温度偏移 (°C) 或 APP_TARIFF_OFF
+    int comfort_start_min;     // 舒适时段 (本地时间, 分钟), 起止相同表示全天
+    int comfort_end_min;
+    int64_t preheat_s;         // 本次规划的预热开始时刻
+    int64_t cycle_start_s;     // 当前舒适时段的开始时刻
+    bool feasible;             // 规划能否保证舒适时段的温度
+    uint64_t expected_ucost;   // 当前舒适时段的预期电费 (0.000001货币单位)
+    uint64_t baseline_ucost;   // 不做规划时的电费
+    uint64_t actual_ucost;     // 已产生的实际电费
+} app_tariff_status_t;
+
+/**
+ * @brief 启动电价下载与规划任务
+ */
+void app_tariff_init(void);
+
+/**
+ * @brief 载入JSON格式的电价表
+ *
+ * @return ESP_OK; ESP_ERR_INVALID_ARG 格式错误; ESP_ERR_INVALID_SIZE 时段数超过 CONFIG_APP_TARIFF_MAX_SLOTS
+ */
+esp_err_t app_tariff_load_json(const char* json, size_t len);
+
+/**
+ * @brief 尽快重新下载电价表
+ */
+void app_tariff_refresh(void);
+
+/**
+ * @brief 设置舒适时段并保存, 起止相同表示全天
+ *
+ * @param start_min 开始时刻 (本地时间, 0 ~ 1439 分钟)
+ * @param end_min 结束时刻, 小于开始时刻表示跨越午夜
+ */
+esp_err_t app_tariff_set_comfort(int start_min, int end_min);
+
+/**
+ * @brief 获取当前时刻的目标温度偏移, 由加热控制任务每周期调用
+ *
+ * @param[out] offset 目标温度偏移 (°C), 或 APP_TARIFF_OFF 表示不加热
+ * @return 规划是否生效, 不生效时 offset 为0
+ */
+bool app_tariff_get_offset(int8_t* offset);
+
+void app_tariff_get_status(app_tariff_status_t* status);
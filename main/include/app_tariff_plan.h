@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 分时电价加热规划器
+ *
+ * 电价表由等长时段组成. 规划器为舒适时段 (用户希望毛巾架保持目标温度的时段) 及之前的预热时段
+ * 给每个电价时段分配一个目标温度偏移:
+ *   - 昂贵时段: 降低 CONFIG_APP_TARIFF_COAST_C, 依靠毛巾架的热容滑行;
+ *   - 下一时段昂贵的便宜时段: 提高 CONFIG_APP_TARIFF_BOOST_C, 提前蓄热;
+ *   - 其他时段: 维持目标温度;
+ *   - 预热开始前: 不加热.
+ * 昂贵指价格不低于规划范围内最低价的 (100 + CONFIG_APP_TARIFF_EXPENSIVE_PCT)%.
+ * 回差控制在温度降到 设定温度 - 回差 以下才重新加热, 因此各偏移再加上回差, 使回差下沿落在上述温度上.
+ *
+ * 预热开始时刻在舒适时段开始前 CONFIG_APP_TARIFF_PREHEAT_MAX_H 内的各时段起点中选择:
+ * 用与温度估计器相同的一阶热模型模拟每个候选方案, 在舒适时段内温度始终不低于
+ * (目标温度 - CONFIG_APP_TARIFF_COAST_C) 的方案中取电费最低者; 都不满足时取最接近满足的方案.
+ *
+ * 规划器不依赖 FreeRTOS, 可以在主机上单独测试.
+ */
+
+#define APP_TARIFF_OFF INT8_MIN // 目标温度偏移: 不加热
+
+/* 电价表 */
+typedef struct {
+    int64_t start_s;                               // 第一个时段的起始时刻 (本地时间, s)
+    uint32_t slot_s;                               // 时段长度 (s)
+    int count;                                     // 时段数
+    uint32_t price[CONFIG_APP_TARIFF_MAX_SLOTS];   // 各时段电价 (0.001货币单位/kWh)
+} app_tariff_schedule_t;
+
+/* 规划输入 */
+typedef struct {
+    int64_t now_s;           // 当前本地时间 (s)
+    int64_t comfort_start_s; // 本次 (或下一次) 舒适时段的起止时刻
+    int64_t comfort_end_s;
+    int32_t rack_temp;       // 当前毛巾架温度 (m°C)
+    int target;              // 目标温度 (°C)
+    uint32_t power_w;        // 所有加热器的额定功率之和
+    int band;                // 控制的开关回差 (°C), 见 app_zone_status_t.switching_band
+} app_tariff_plan_input_t;
+
+/* 规划结果 */
+typedef struct {
+    bool valid;                                   // 电价表覆盖当前时刻时有效
+    int64_t end_s;                                // 规划范围的结束时刻, 之后需要重新规划
+    int64_t preheat_s;                            // 预热开始时刻
+    bool feasible;                                // 模拟中舒适时段温度是否始终达标
+    int8_t offset[CONFIG_APP_TARIFF_MAX_SLOTS];   // 各时段的目标温度偏移 (°C) 或 APP_TARIFF_OFF
+    uint64_t expected_ucost;                      // 按规划执行的预期电费 (0.000001货币单位)
+    uint64_t baseline_ucost;                      // 从现在起一直维持目标温度的电费, 用于评估节省
+    uint32_t expected_wh;                         // 按规划执行的预期耗电量
+} app_tariff_plan_t;
+
+/**
+ * @brief 返回时刻所在的时段号, 不在电价表范围内时返回 -1
+ */
+int app_tariff_slot_at(const app_tariff_schedule_t* schedule, int64_t time_s);
+
+/**
+ * @brief 计算从当前时刻到舒适时段结束的加热规划
+ */
+void app_tariff_plan(const app_tariff_schedule_t* schedule, const app_tariff_plan_input_t* input,
+                     app_tariff_plan_t* plan);
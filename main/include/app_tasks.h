@@ -1,3 +1,68 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
 void app_tasks_init(void);
+
+/**
+ * @brief 输出各UI状态转移的触发次数
+ */
+void app_ui_log_transition_counters(void);
+
+/**
+ * @brief 以当前目标温度开始PID自整定, 系统关机时返回 ESP_ERR_INVALID_STATE
+ */
+esp_err_t app_tasks_start_autotune(void);
+
+/**
+ * @brief 系统是否处于开启状态
+ */
+bool app_tasks_is_on(void);
+
+typedef struct {
+    int target_temperature; // 目标温度 (°C), 关机时为0
+    int32_t temperature;    // 最近一次参与控制的温度 (m°C)
+    bool heater_on;         // 加热器当前输出
+    int switching_band;     // 温度降到 目标温度 - 该值 以下才重新加热 (°C), 回差控制为回差, PID为0
+} app_zone_status_t;
+
+/**
+ * @brief 单独设置一个加热通道的目标温度, 直到下次在界面上调节温度或开关机
+ *
+ * @return ESP_OK; ESP_ERR_INVALID_ARG 通道号或温度超出范围; ESP_ERR_INVALID_STATE 系统关机
+ */
+esp_err_t app_tasks_set_zone_target(int channel, int temperature);
+
+/**
+ * @brief 获取加热通道状态
+ *
+ * @param channel 通道号, 范围 [0, BSP_HEATING_CHANNEL_NUM)
+ */
+void app_tasks_get_zone_status(int channel, app_zone_status_t* status);
+
+/**
+ * @brief 向状态推送 (app_push.h) 发布当前状态, 未启用 CONFIG_APP_PUSH_ENABLE 时无操作
+ *
+ * 应用任务在状态变化时自动发布, 推送启动后调用一次以发布启动前的状态
+ */
+void app_tasks_publish_state(void);
+
+/**
+ * @brief 立即唤醒加热控制任务, 使开关机, 目标温度与安全故障的变化不必等到下一个控制周期
+ */
+void app_tasks_wake_heating(void);
+
+typedef struct {
+    uint32_t wakeups;           // 启动以来的唤醒次数
+    uint32_t wakeups_this_hour; // 本小时内的唤醒次数
+    uint32_t wakeups_last_hour; // 上一小时的唤醒次数
+    uint32_t period_ms;         // 当前控制周期 (ms), 0 表示关机或故障锁定后等待通知
+} app_heating_loop_status_t;
+
+/**
+ * @brief 获取加热控制任务的唤醒统计, 整小时按任务启动时刻计
+ */
+void app_tasks_get_heating_loop_status(app_heating_loop_status_t* status);
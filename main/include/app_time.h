@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief 时间服务
+ *
+ * 提供两种时钟:
+ *   - 单调时钟: 开机后经过的时间 (us), 不受同步影响, 用于测量时间间隔;
+ *   - UTC时间: 由单调时钟与频率偏差修正推算, 每 CONFIG_APP_TIME_SYNC_INTERVAL_MIN 分钟通过SNTP
+ *     向 CONFIG_APP_TIME_NTP_SERVER 同步一次.
+ *
+ * 相邻两次同步之间本地时钟相对服务器的累计误差即为晶振的频率偏差, 服务将其滤波后用于修正
+ * 两次同步之间的推算, 并与最近的UTC时间一起保存到NVS. 启动时按以下顺序恢复时间:
+ *   - 芯片软件复位后, 系统时间由RTC保持, 直接沿用;
+ *   - 断电重启后只有NVS中保存的时间, 它早于实际时间, 只作为下限, 不能用于按日历的功能.
+ *
+ * 本地时间按 CONFIG_APP_TIME_TZ 给出的POSIX时区规则 (含夏令时) 换算.
+ */
+
+/* 当前UTC时间的来源, 按可信程度递增 */
+typedef enum {
+    APP_TIME_SOURCE_NONE = 0, // 时间未知
+    APP_TIME_SOURCE_SAVED,    // 断电前保存的时间, 不含断电时长
+    APP_TIME_SOURCE_RETAINED, // 软件复位后由RTC保持的时间
+    APP_TIME_SOURCE_SYNCED,   // 已通过SNTP同步
+} app_time_source_t;
+
+typedef struct {
+    app_time_source_t source;
+    int64_t utc_us;           // 当前UTC时间, 来源为 NONE 时为0
+    int32_t drift_ppb;        // 本地时钟频率偏差估计 (ppb, 正为偏快)
+    bool drift_valid;         // 是否已估计频率偏差
+    uint32_t sync_count;      // 本次开机的成功同步次数
+    uint32_t sync_failures;   // 本次开机的同步失败次数
+    int64_t last_sync_age_us; // 距最近一次同步的时间, 未同步时为 -1
+    int64_t last_offset_us;   // 最近一次同步时推算时间与服务器时间之差 (本地 - 服务器)
+    uint32_t last_delay_us;   // 最近一次同步的网络往返时延
+} app_time_status_t;
+
+/**
+ * @brief 恢复保存的时间并启动SNTP同步任务
+ */
+void app_time_init(void);
+
+/**
+ * @brief 单调时钟, 开机后经过的时间 (us)
+ */
+int64_t app_time_monotonic_us(void);
+
+/**
+ * @brief 获取当前UTC时间 (us)
+ *
+ * @return 时间是否可信 (来源为 RETAINED 或 SYNCED); 来源为 SAVED 时仍输出时间, 但返回 false
+ */
+bool app_time_get_utc(int64_t* utc_us);
+
+/**
+ * @brief 按时区规则把UTC时间换算为本地时间
+ *
+ * @param[out] local 本地日历时间
+ * @return 本地时间相对UTC的偏移 (s)
+ */
+int32_t app_time_to_local(int64_t utc_s, struct tm* local);
+
+/**
+ * @brief 立即发起一次SNTP同步
+ */
+void app_time_sync_now(void);
+
+void app_time_get_status(app_time_status_t* status);
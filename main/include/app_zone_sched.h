@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "bsp/towelrack_controller_a1.h"
+
+/**
+ * @brief 加热通道开关调度器
+ *
+ * 各通道的控制器只给出加热器期望状态, 由调度器统一驱动输出:
+ *   - 关断立即生效;
+ *   - 打开按轮转顺序逐个执行, 不同通道的两次打开之间至少间隔 CONFIG_APP_ZONE_STAGGER_MS,
+ *     避免多台毛巾架同时打开时浪涌电流叠加. 轮转起点每次后移, 各通道等待的机会均等.
+ *
+ * 调度器只在加热控制任务中调用, 不需要加锁.
+ */
+
+/**
+ * @brief 按期望状态驱动所有通道的加热器, 需要错开时在调用中阻塞等待
+ *
+ * @param request 各通道加热器期望状态
+ */
+void app_zone_sched_apply(const bool request[BSP_HEATING_CHANNEL_NUM]);
+
+/**
+ * @brief 立即关闭所有通道的加热器
+ */
+void app_zone_sched_all_off(void);
@@ -0,0 +1,57 @@
+#pragma once
+
+/**************************************************************************************************
+ *
+ * Board Descriptor
+ *
+ * 每个硬件版本在 boards/ 下提供一张描述表 BSP_BOARD_TABLE(X), 每行 X(字段, 值) 描述一项板级参数.
+ * 描述表在编译期展开为枚举常量 BSP_BOARD_<字段>, 可用于静态初始化与 _Static_assert,
+ * 驱动中以其为条件的分支会被编译器直接裁剪, 运行期没有任何开销.
+ *
+ * 描述表必须提供以下字段:
+ *   PIN_74HC595_DS / PIN_74HC595_SHCP / PIN_74HC595_STCP   74HC595 串行数据/移位时钟/锁存时钟
+ *   PIN_DISP_S1_SW / PIN_DISP_S2_SW                         数码管位选
+ *   PIN_TOUCH_BUTTON_L / PIN_TOUCH_BUTTON_R                 触摸按键, 没有该按键时为 GPIO_NUM_NC
+ *   PIN_KNOB_ENCODER_A / PIN_KNOB_ENCODER_B / PIN_KNOB_BUTTON 旋钮
+ *   PIN_LED_STRIP                                           LED灯带数据线
+ *   NTC_ADC_UNIT                                            NTC分压点所接的ADC单元
+ *   NTC_B_VALUE / NTC_R25_OHM / NTC_FIXED_OHM / NTC_VDD_MV   NTC参数与分压电路
+ *   DISPLAY_DIGITS                                          数码管位数
+ *   LED_STRIP_NUM                                           LED灯珠数量, 没有灯带时为 0
+ *   HEATER_RATED_W                                          每个加热器的额定功率 (W)
+ *
+ * 另外提供加热通道表 BSP_BOARD_HEATING_CHANNELS(X), 每行 X(加热器控制引脚, NTC的ADC通道) 描述一对
+ * 传感器/加热器. 一个控制器驱动多台毛巾架时每台占一行, 通道号即行号 (从0开始).
+ *
+ * 新增硬件版本: 在 boards/ 下添加描述表, 在 Kconfig 中添加对应选项, 并在下方选择处加入一行.
+ **************************************************************************************************/
+
+#if CONFIG_IDF_TARGET_LINUX
+#include "bsp/boards/trc_sim.h"
+#elif defined(CONFIG_HW_VERSION_A_1)
+#include "bsp/boards/trc_wifi_a1.h"
+#elif defined(CONFIG_HW_VERSION_A_2)
+#include "bsp/boards/trc_wifi_a2.h"
+#else
+#error "No board descriptor for the selected hardware version"
+#endif
+
+#define BSP_BOARD_ENUM_ENTRY(field, value) BSP_BOARD_##field = (value),
+
+enum { BSP_BOARD_TABLE(BSP_BOARD_ENUM_ENTRY) };
+
+/* 以 gpio_num_t 类型取用引脚字段, 例如 BSP_BOARD_PIN(LED_STRIP) */
+#define BSP_BOARD_PIN(name) ((gpio_num_t)BSP_BOARD_PIN_##name)
+
+#define BSP_BOARD_CHANNEL_COUNT_ENTRY(heater_pin, ntc_channel) +1
+
+#define BSP_HEATING_CHANNEL_MAX 4 // 加热通道数上限
+
+/* 加热通道数 */
+enum { BSP_HEATING_CHANNEL_NUM = 0 BSP_BOARD_HEATING_CHANNELS(BSP_BOARD_CHANNEL_COUNT_ENTRY) };
+
+_Static_assert(BSP_HEATING_CHANNEL_NUM >= 1 && BSP_HEATING_CHANNEL_NUM <= BSP_HEATING_CHANNEL_MAX,
+               "Board must describe 1 to BSP_HEATING_CHANNEL_MAX heating channels");
+_Static_assert(BSP_BOARD_DISPLAY_DIGITS == 2, "Display driver multiplexes exactly two digits");
+_Static_assert(BSP_BOARD_LED_STRIP_NUM >= 0, "LED_STRIP_NUM must not be negative");
+_Static_assert(BSP_BOARD_HEATER_RATED_W > 0, "HEATER_RATED_W must be positive");
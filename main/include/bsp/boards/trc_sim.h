@@ -0,0 +1,53 @@
+#pragma once
+
+#include "driver/gpio.h"
+
+/**************************************************************************************************
+ * TowelRack-Controller-WiFi Simulation Board (linux target)
+ *
+ * 引脚编号只用于区分替身GPIO, 输入由脚本注入, 加热器与NTC由热模型模拟
+ **************************************************************************************************/
+
+#define BSP_BOARD_NAME "TowelRack-Controller-WiFi-Sim"
+
+#define BSP_BOARD_TABLE(X)                            \
+    X(PIN_74HC595_DS, GPIO_NUM_0)                     \
+    X(PIN_74HC595_SHCP, GPIO_NUM_1)                   \
+    X(PIN_74HC595_STCP, GPIO_NUM_2)                   \
+    X(PIN_DISP_S1_SW, GPIO_NUM_3)                     \
+    X(PIN_DISP_S2_SW, GPIO_NUM_4)                     \
+    X(PIN_TOUCH_BUTTON_L, GPIO_NUM_NC)                \
+    X(PIN_TOUCH_BUTTON_R, GPIO_NUM_NC)                \
+    X(PIN_KNOB_ENCODER_A, GPIO_NUM_NC)                \
+    X(PIN_KNOB_ENCODER_B, GPIO_NUM_NC)                \
+    X(PIN_KNOB_BUTTON, GPIO_NUM_NC)                   \
+    X(PIN_LED_STRIP, GPIO_NUM_NC)                     \
+    X(NTC_ADC_UNIT, 0)                                \
+    X(NTC_B_VALUE, 3950)                              \
+    X(NTC_R25_OHM, 10000)                             \
+    X(NTC_FIXED_OHM, 10000)                           \
+    X(NTC_VDD_MV, 3300)                               \
+    X(DISPLAY_DIGITS, 2)                              \
+    X(LED_STRIP_NUM, 4)                               \
+    X(HEATER_RATED_W, CONFIG_SIM_HEATER_POWER_W)
+
+/* 加热通道: X(加热器控制引脚, NTC分压点所接ADC通道), 每个通道对应一个独立的热模型 */
+#if CONFIG_SIM_HEATING_CHANNELS >= 4
+#define BSP_BOARD_HEATING_CHANNELS(X)                 \
+    X(GPIO_NUM_NC, 0)                                 \
+    X(GPIO_NUM_NC, 1)                                 \
+    X(GPIO_NUM_NC, 2)                                 \
+    X(GPIO_NUM_NC, 3)
+#elif CONFIG_SIM_HEATING_CHANNELS == 3
+#define BSP_BOARD_HEATING_CHANNELS(X)                 \
+    X(GPIO_NUM_NC, 0)                                 \
+    X(GPIO_NUM_NC, 1)                                 \
+    X(GPIO_NUM_NC, 2)
+#elif CONFIG_SIM_HEATING_CHANNELS == 2
+#define BSP_BOARD_HEATING_CHANNELS(X)                 \
+    X(GPIO_NUM_NC, 0)                                 \
+    X(GPIO_NUM_NC, 1)
+#else
+#define BSP_BOARD_HEATING_CHANNELS(X)                 \
+    X(GPIO_NUM_NC, 0)
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "hal/adc_types.h"
+
+/**************************************************************************************************
+ * TowelRack-Controller-WiFi-A2
+ **************************************************************************************************/
+
+#define BSP_BOARD_NAME "TowelRack-Controller-WiFi-A2"
+
+#define BSP_BOARD_TABLE(X)                  \
+    X(PIN_74HC595_DS, GPIO_NUM_10)          \
+    X(PIN_74HC595_SHCP, GPIO_NUM_18)        \
+    X(PIN_74HC595_STCP, GPIO_NUM_19)        \
+    X(PIN_DISP_S1_SW, GPIO_NUM_7)           \
+    X(PIN_DISP_S2_SW, GPIO_NUM_1)           \
+    X(PIN_TOUCH_BUTTON_L, GPIO_NUM_3)       \
+    X(PIN_TOUCH_BUTTON_R, GPIO_NUM_2)       \
+    X(PIN_KNOB_ENCODER_A, GPIO_NUM_5)       \
+    X(PIN_KNOB_ENCODER_B, GPIO_NUM_4)       \
+    X(PIN_KNOB_BUTTON, GPIO_NUM_9)          \
+    X(PIN_LED_STRIP, GPIO_NUM_8)            \
+    X(NTC_ADC_UNIT, ADC_UNIT_1)             \
+    X(NTC_B_VALUE, 3950)                    \
+    X(NTC_R25_OHM, 10000)                   \
+    X(NTC_FIXED_OHM, 10000)                 \
+    X(NTC_VDD_MV, 3300)                     \
+    X(DISPLAY_DIGITS, 2)                    \
+    X(LED_STRIP_NUM, 4)                     \
+    X(HEATER_RATED_W, 100)
+
+/* 加热通道: X(加热器控制引脚, NTC分压点所接ADC通道) */
+#define BSP_BOARD_HEATING_CHANNELS(X)       \
+    X(GPIO_NUM_6, ADC_CHANNEL_0)
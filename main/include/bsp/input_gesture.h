@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bsp/towelrack_controller_a1.h"
+
+/**
+ * @brief 输入手势识别
+ *
+ * 输入驱动只上报带时间戳的原始事件: 按键按下/松开与旋钮每转动一格. 识别器按声明式的手势表
+ * 逐个匹配, 输出 bsp_input_event_t. 每个原始事件只遍历一次手势表与按键表, 开销有上界.
+ *
+ * 手势种类:
+ *   - CLICK:  单个按键连续点击 clicks 次, 最后一次松开时触发; 两次点击间隔不超过
+ *             CONFIG_BSP_GESTURE_CLICK_GAP_MS, 按下超过 CONFIG_BSP_GESTURE_HOLD_MS 不计为点击;
+ *   - HOLD:   keys 全部按下并保持 time_ms 时触发, 从最后一个按键按下开始计时;
+ *   - CHORD:  keys 在 time_ms 内先后全部按下时触发;
+ *   - ROTATE: 按下的按键正好为 keys (0 表示没有按键按下) 时旋钮向 direction 转动一格触发.
+ * 参与过 HOLD, CHORD 或带按键的 ROTATE 的按键在松开前不再触发其他手势, 例如按住旋钮旋转后
+ * 松开不算点击, 也不会触发长按.
+ *
+ * 长按需要在没有新的原始事件时按时触发: 驱动在每次输入后通过 bsp_gesture_next_deadline
+ * 取得下一个到期时刻, 到期时输入 BSP_GESTURE_RAW_TICK.
+ *
+ * 识别器不依赖 FreeRTOS, 也不加锁, 调用者需保证同一识别器的调用不并发.
+ */
+
+typedef enum {
+    BSP_GESTURE_KEY_KNOB = 0, // 旋钮按钮
+    BSP_GESTURE_KEY_TOUCH_L,  // 左触摸按键
+    BSP_GESTURE_KEY_TOUCH_R,  // 右触摸按键
+    BSP_GESTURE_KEY_NUM,
+} bsp_gesture_key_t;
+
+#define BSP_GESTURE_KEY_BIT(key) ((uint8_t)(1U << (key)))
+#define BSP_GESTURE_OUT_MAX      4 // 单个原始事件最多同时触发的手势数, 本板手势表中不超过该值
+
+typedef enum {
+    BSP_GESTURE_RAW_PRESS,   // 按键按下
+    BSP_GESTURE_RAW_RELEASE, // 按键松开
+    BSP_GESTURE_RAW_DETENT,  // 旋钮转动一格
+    BSP_GESTURE_RAW_TICK,    // 只推进时间
+} bsp_gesture_raw_type_t;
+
+typedef struct {
+    bsp_gesture_raw_type_t type;
+    bsp_gesture_key_t key; // PRESS/RELEASE
+    int8_t direction;      // DETENT: 1 顺时针, -1 逆时针
+    uint32_t time_ms;      // 事件时刻, 允许回绕
+} bsp_gesture_raw_t;
+
+typedef enum {
+    BSP_GESTURE_CLICK,
+    BSP_GESTURE_HOLD,
+    BSP_GESTURE_CHORD,
+    BSP_GESTURE_ROTATE,
+} bsp_gesture_kind_t;
+
+/* 手势表项 */
+typedef struct {
+    bsp_gesture_kind_t kind;
+    uint8_t keys;            // BSP_GESTURE_KEY_BIT 的组合, CLICK 只能有一个按键
+    uint8_t clicks;          // CLICK: 点击次数
+    int8_t direction;        // ROTATE: 1 顺时针, -1 逆时针
+    uint16_t time_ms;        // HOLD: 保持时长; CHORD: 按下时间窗
+    bsp_input_event_t event; // 输出事件
+} bsp_gesture_t;
+
+typedef struct {
+    const bsp_gesture_t* table;
+    int table_len;
+    uint8_t held;                            // 当前按下的按键
+    uint8_t consumed;                        // 已参与组合手势, 松开前不再触发其他手势的按键
+    uint8_t clicks[BSP_GESTURE_KEY_NUM];     // 连续点击计数
+    uint32_t press_ms[BSP_GESTURE_KEY_NUM];  // 最近一次按下的时刻
+    uint32_t release_ms[BSP_GESTURE_KEY_NUM];
+} bsp_gesture_engine_t;
+
+/* 本板的手势表, 旋钮与触摸按键的全部手势在此声明 */
+extern const bsp_gesture_t bsp_gesture_table[];
+extern const int bsp_gesture_table_len;
+
+void bsp_gesture_init(bsp_gesture_engine_t* engine, const bsp_gesture_t* table, int table_len);
+
+/**
+ * @brief 输入一个原始事件
+ *
+ * @param[out] out 识别出的事件, 按手势表顺序
+ * @param out_max out 的容量, 超出的事件被丢弃
+ * @return 识别出的事件数
+ */
+int bsp_gesture_feed(bsp_gesture_engine_t* engine, const bsp_gesture_raw_t* raw, bsp_input_event_t* out,
+                     int out_max);
+
+/**
+ * @brief 获取下一个长按到期时刻
+ *
+ * @return 是否有等待到期的长按
+ */
+bool bsp_gesture_next_deadline(const bsp_gesture_engine_t* engine, uint32_t* deadline_ms);
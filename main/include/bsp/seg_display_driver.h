@@ -16,6 +16,17 @@ typedef struct {
 
 typedef void* display_device_handle_t;
 
+#define DISPLAY_STATIC_MAX_LENS 4 // 静态存储支持的最大显示字符数
+
+/**
+ * @brief 数码管驱动的静态存储, 供 display_init_static 使用, 内容对调用方不透明
+ */
+typedef struct {
+    void* dev[12];
+    char content[DISPLAY_STATIC_MAX_LENS + 1];
+    uint8_t buffer[DISPLAY_STATIC_MAX_LENS];
+} display_storage_t;
+
 void display_write_str(display_device_handle_t handle, const char* str);
 
 void display_write_int(display_device_handle_t handle, int num);
@@ -26,4 +37,47 @@ void display_set_h_flag(display_device_handle_t handle, bool flag);
 
 void display_enable_all(display_device_handle_t handle);
 
+/**
+ * @brief 静默窗口回调, 在刷新定时器中断中调用
+ *
+ * @return 是否唤醒了更高优先级的任务, 作为中断的返回值
+ */
+typedef bool (*display_quiet_hook_t)(void* arg);
+
+/**
+ * @brief 设置静默窗口回调
+ *
+ * 每次刷新时新的段码锁存后、打开位选之前两位数码管都处于熄灭状态, 74HC595输出与LED电流不变,
+ * 是板上数字噪声最小的时刻. 回调在此时于中断中执行, 执行期间数码管保持熄灭, 应尽量短.
+ * 显示关闭时刷新定时器停止, 回调不会被调用.
+ *
+ * @param hook 回调, NULL 取消
+ */
+void display_set_quiet_hook(display_device_handle_t handle, display_quiet_hook_t hook, void* arg);
+
+/**
+ * @brief 刷新定时器是否在运行, 即数码管是否在多路扫描
+ */
+bool display_is_refreshing(display_device_handle_t handle);
+
+/**
+ * @brief 刷新一位数码管, 与刷新定时器中断的处理相同, 用于基准测试测量中断的开销
+ *
+ * 在任务中执行, 不调用静默窗口回调. 调用前应以 display_hold_refresh 暂停刷新定时器,
+ * 否则与刷新中断同时写74HC595.
+ */
+void display_refresh(display_device_handle_t handle);
+
+/**
+ * @brief 暂停/恢复刷新定时器, 暂停期间显示内容照常更新, 恢复后继续扫描
+ */
+void display_hold_refresh(display_device_handle_t handle, bool hold);
+
 void display_init(const display_config_t* config, display_device_handle_t* handle);
+
+/**
+ * @brief 使用调用方提供的静态存储初始化数码管, 不进行堆分配
+ *
+ * @note config->max_lens 不能超过 DISPLAY_STATIC_MAX_LENS, 否则 handle 输出 NULL
+ */
+void display_init_static(const display_config_t* config, display_storage_t* storage, display_device_handle_t* handle);
@@ -1,44 +1,44 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
-#include <driver/gpio.h>
+#include "esp_err.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+/* linux 目标 (仿真板) 使用 glibc, 没有 newlib 的 __unused 宏 */
+#ifndef __unused
+#define __unused __attribute__((unused))
+#endif
+#else
+#include <driver/gpio.h>
+#endif
 
 /**************************************************************************************************
- * TowelRack-Controller-WiFi-A1 Pinout
+ * TowelRack-Controller-WiFi-A1 Board Descriptor
+ *
+ * 引脚与板级参数见 bsp/board.h 选中的描述表 (BSP_BOARD_*)
  **************************************************************************************************/
 
-#if defined(CONFIG_HW_VERSION_A_1)
-#define BSP_P_74HC595_DS               GPIO_NUM_10
-#define BSP_P_74HC595_SHCP             GPIO_NUM_18
-#define BSP_P_74HC595_STCP             GPIO_NUM_19
-#define BSP_P_DISP_S1_SW               GPIO_NUM_7
-#define BSP_P_DISP_S2_SW               GPIO_NUM_6
-#define BSP_P_TOUCH_BUTTON_L           GPIO_NUM_4
-#define BSP_P_TOUCH_BUTTON_R           GPIO_NUM_5
-#define BSP_P_KNOB_ENCODER_A           GPIO_NUM_2
-#define BSP_P_KNOB_ENCODER_B           GPIO_NUM_3
-#define BSP_P_KNOB_BUTTON              GPIO_NUM_9
-#define BSP_P_LED_STRIP                GPIO_NUM_8
-#define BSP_P_NTC_ADC_CHANNEL          ADC_CHANNEL_0
-#define BSP_P_NTC_ADC_UNIT             ADC_UNIT_1
-#define BSP_P_HEATING_CTRL             GPIO_NUM_1
-#elif defined(CONFIG_HW_VERSION_A_2)
-#define BSP_P_74HC595_DS               GPIO_NUM_10
-#define BSP_P_74HC595_SHCP             GPIO_NUM_18
-#define BSP_P_74HC595_STCP             GPIO_NUM_19
-#define BSP_P_DISP_S1_SW               GPIO_NUM_7
-#define BSP_P_DISP_S2_SW               GPIO_NUM_1
-#define BSP_P_TOUCH_BUTTON_L           GPIO_NUM_3
-#define BSP_P_TOUCH_BUTTON_R           GPIO_NUM_2
-#define BSP_P_KNOB_ENCODER_A           GPIO_NUM_5
-#define BSP_P_KNOB_ENCODER_B           GPIO_NUM_4
-#define BSP_P_KNOB_BUTTON              GPIO_NUM_9
-#define BSP_P_LED_STRIP                GPIO_NUM_8
-#define BSP_P_NTC_ADC_CHANNEL          ADC_CHANNEL_0
-#define BSP_P_NTC_ADC_UNIT             ADC_UNIT_1
-#define BSP_P_HEATING_CTRL             GPIO_NUM_6
+#include "bsp/board.h"
+
+
+/**************************************************************************************************
+ *
+ * Board Timebase
+ *
+ * 仿真板 (linux 目标) 可以比实时更快地运行, 应用层的所有延时都应通过该宏换算为系统节拍
+ **************************************************************************************************/
+
+#if CONFIG_IDF_TARGET_LINUX
+#define BSP_MS_TO_TICKS(ms) \
+    (pdMS_TO_TICKS((ms) / CONFIG_SIM_TIME_SCALE) > 0 ? pdMS_TO_TICKS((ms) / CONFIG_SIM_TIME_SCALE) : 1)
+#define BSP_TICKS_TO_MS(ticks) ((uint64_t)(ticks) * portTICK_PERIOD_MS * CONFIG_SIM_TIME_SCALE)
+#else
+#define BSP_MS_TO_TICKS(ms) pdMS_TO_TICKS(ms)
+#define BSP_TICKS_TO_MS(ticks) ((uint64_t)(ticks) * portTICK_PERIOD_MS)
 #endif
 
 
@@ -78,6 +78,18 @@ void bsp_display_set_c_flag(bool flag);
  */
 void bsp_display_set_h_flag(bool flag);
 
+/**
+ * @brief 执行一次数码管刷新定时器中断的处理, 供基准测试 (app_bench.h) 使用
+ *
+ * 不调用静默窗口回调 (NTC采样), 调用期间应以 bsp_display_hold_refresh 暂停刷新定时器
+ */
+void bsp_display_refresh(void);
+
+/**
+ * @brief 暂停/恢复数码管刷新定时器, 供基准测试使用
+ */
+void bsp_display_hold_refresh(bool hold);
+
 
 /**************************************************************************************************
  *
@@ -87,14 +99,21 @@ void bsp_display_set_h_flag(bool flag);
  **************************************************************************************************/
 
 typedef enum {
-    BSP_KNOB_ENCODER_ACW,     // 旋钮逆时针旋转
-    BSP_KNOB_ENCODER_CW,      // 旋钮顺时针旋转
-    BSP_KNOB_LONG_PRESS,      // 旋钮长按
-    BSP_KNOB_MT8_CLICK,       // 旋钮连续点击 8 次
-    BSP_TOUCH_BUTTON_L_CLICK, // 左触摸按键点击
-    BSP_TOUCH_BUTTON_R_CLICK, // 右触摸按键点击
+    BSP_KNOB_ENCODER_ACW,      // 旋钮逆时针旋转
+    BSP_KNOB_ENCODER_CW,       // 旋钮顺时针旋转
+    BSP_KNOB_LONG_PRESS,       // 旋钮长按
+    BSP_KNOB_MT8_CLICK,        // 旋钮连续点击 8 次
+    BSP_TOUCH_BUTTON_L_CLICK,  // 左触摸按键点击
+    BSP_TOUCH_BUTTON_R_CLICK,  // 右触摸按键点击
+    BSP_KNOB_HOLD_ENCODER_ACW, // 按住旋钮逆时针旋转
+    BSP_KNOB_HOLD_ENCODER_CW,  // 按住旋钮顺时针旋转
+    BSP_TOUCH_BUTTON_LR_CHORD, // 左右触摸按键同时按下
+    BSP_INPUT_EVENT_MAX,
 } bsp_input_event_t;
 
+/**
+ * @brief 初始化输入设备, 按键与旋钮的原始事件经手势识别 (bsp/input_gesture.h) 后送入输入队列
+ */
 void bsp_input_init(void);
 
 QueueHandle_t bsp_input_get_queue(void);
@@ -127,16 +146,130 @@ void bsp_led_strip_write(bsp_led_strip_mode_t mode);
  *
  * NTC Temperature Sensor + Heating Control
  *
- * TowelRack-Controller-WiFi-A1 使用NTC热敏电阻传感器测量温度, 并使用可控硅控制加热
+ * TowelRack-Controller-WiFi-A1 使用NTC热敏电阻传感器测量温度, 并使用可控硅控制加热.
+ * 每个加热通道由一个NTC和一个加热器组成, 通道数 BSP_HEATING_CHANNEL_NUM 由板级描述表决定.
+ * 不带通道参数的接口操作通道0.
  **************************************************************************************************/
 
+#define BSP_NTC_ADC_RAW_MAX 4095 // 12位ADC满量程
+
 void bsp_heating_init(void);
 
+/**
+ * @brief 读取指定通道的NTC温度
+ *
+ * @param channel 通道号, 范围 [0, BSP_HEATING_CHANNEL_NUM)
+ * @param[out] milli_celsius 温度 (m°C)
+ * @return ESP_OK 成功; ESP_ERR_INVALID_ARG 通道号无效; 其他 NTC读取失败
+ */
+esp_err_t bsp_heating_channel_read_temp(int channel, int32_t* milli_celsius);
+
+/**
+ * @brief 读取指定通道NTC分压点的ADC原始值, 用于判断NTC开路/短路
+ *
+ * @param channel 通道号
+ * @param[out] raw ADC原始值, 范围 [0, BSP_NTC_ADC_RAW_MAX]
+ */
+esp_err_t bsp_heating_channel_read_ntc_raw(int channel, int* raw);
+
+#if CONFIG_BSP_NTC_SYNC_DISPLAY
+/**
+ * NTC转换在数码管刷新中断的静默窗口 (两位均熄灭) 中进行, 避开位选切换时LED电流的跳变.
+ * 数码管关闭时没有扫描噪声, 直接转换.
+ */
+
+typedef struct {
+    int samples;
+    float mean;     // 均值 (ADC原始值)
+    float variance; // 样本方差 (LSB²)
+    int min;
+    int max;
+} bsp_ntc_noise_t;
+
+typedef struct {
+    uint32_t synced;   // 在静默窗口中完成的读取次数
+    uint32_t direct;   // 数码管关闭或等待超时而直接转换的读取次数
+    uint32_t timeouts; // 等待静默窗口超时的次数
+} bsp_ntc_sync_stats_t;
+
+/**
+ * @brief 连续单次转换指定通道NTC, 统计原始值的分布, 用于比较两种采样时刻的噪声
+ *
+ * 每次统计一次转换, 不做平均. synced 为 false 时在刷新周期内的随机时刻转换.
+ *
+ * @param samples 转换次数, 不小于2
+ * @param synced 是否在静默窗口中转换
+ * @return ESP_OK; ESP_ERR_INVALID_ARG 参数无效; ESP_ERR_TIMEOUT synced 时数码管未在扫描; 其他 ADC读取失败
+ */
+esp_err_t bsp_heating_measure_ntc_noise(int channel, int samples, bool synced, bsp_ntc_noise_t* noise);
+
+void bsp_heating_get_ntc_sync_stats(bsp_ntc_sync_stats_t* stats);
+#endif
+
+/**
+ * @brief 打开指定通道的加热器, 加热器被锁定时无效
+ *
+ * 本接口不限制开启时序, 多通道同时开启的浪涌电流由调用者错开 (见 app_zone_sched.h)
+ */
+void bsp_heating_channel_enable(int channel);
+
+void bsp_heating_channel_disable(int channel);
+
+/**
+ * @brief 获取指定通道加热器当前输出状态
+ */
+bool bsp_heating_channel_is_enabled(int channel);
+
+/**
+ * @brief 读取未经单板校准的NTC温度 (通道0), 用于采集两点校准的测量值
+ *
+ * @param[out] milli_celsius 温度 (m°C)
+ */
+esp_err_t bsp_heating_read_temp_uncalibrated(int32_t* milli_celsius);
+
+#define BSP_NTC_CAL_GAIN_ONE (1 << 16) // 校准增益的定点表示 (Q16) 中的 1.0
+
+/**
+ * @brief 设置单板NTC校准系数 (通道0)
+ *
+ * 此后通道0的温度读数为 T × gain_q16 / 65536 + offset_mC, T 为未校准温度
+ *
+ * @param gain_q16 增益 (Q16), BSP_NTC_CAL_GAIN_ONE 表示不校准
+ * @param offset_mC 偏移 (m°C)
+ */
+void bsp_heating_set_ntc_calibration(int32_t gain_q16, int32_t offset_mC);
+
+/**
+ * @brief 读取NTC温度 (°C, 通道0)
+ *
+ * @return 温度; NTC读取失败时返回高于任何目标温度的值, 使调用者停止加热
+ */
 int bsp_heating_get_temp(void);
 
-void bsp_heating_enable(void);
+/**
+ * @brief 关闭并锁定所有通道的加热器, 此后直到重启 bsp_heating_channel_enable 都不再生效
+ */
+void bsp_heating_lockout(void);
+
+/**
+ * @brief 获取自启动以来所有通道加热器输出为开启状态的累计时间之和
+ *
+ * @return 累计开启时间 (us), 包括当前仍在进行的开启区间
+ */
+uint64_t bsp_heating_get_on_time_us(void);
+
+/* 通道0的便捷接口 */
+static inline esp_err_t bsp_heating_read_temp(int32_t* milli_celsius) {
+    return bsp_heating_channel_read_temp(0, milli_celsius);
+}
+
+static inline esp_err_t bsp_heating_read_ntc_raw(int* raw) { return bsp_heating_channel_read_ntc_raw(0, raw); }
+
+static inline void bsp_heating_enable(void) { bsp_heating_channel_enable(0); }
+
+static inline void bsp_heating_disable(void) { bsp_heating_channel_disable(0); }
 
-void bsp_heating_disable(void);
+static inline bool bsp_heating_is_enabled(void) { return bsp_heating_channel_is_enabled(0); }
 
 
 /**************************************************************************************************
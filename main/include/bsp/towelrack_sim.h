@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bsp/towelrack_controller_a1.h"
+
+/**************************************************************************************************
+ *
+ * TowelRack-Controller-WiFi Simulation Board (linux target)
+ *
+ * 仿真板实现了 towelrack_controller_a1.h 中的全部接口, 以下为仿真板额外提供的观测接口
+ **************************************************************************************************/
+
+/**
+ * @brief 获取仿真板虚拟时间
+ *
+ * @return 自仿真开始经过的虚拟时间(ms)
+ */
+uint64_t bsp_sim_get_time_ms(void);
+
+/**
+ * @brief 获取热模型中指定通道毛巾架本体温度
+ */
+float bsp_sim_get_rack_temp(int channel);
+
+/**
+ * @brief 获取热模型中指定通道NTC所在位置的温度
+ */
+float bsp_sim_get_ntc_temp(int channel);
+
+/**
+ * @brief 获取指定通道虚拟加热器状态
+ */
+bool bsp_sim_get_heater_state(int channel);
+
+/**
+ * @brief 获取通道0毛巾剩余含水量(g)
+ */
+float bsp_sim_get_towel_water(void);
+
+/**
+ * @brief 获取所有虚拟加热器累计耗电量(Wh)
+ */
+double bsp_sim_get_heater_energy_wh(void);
+
+/**
+ * @brief 获取虚拟数码管当前显示内容, 熄灭时为空字符串
+ */
+const char* bsp_sim_get_display_content(void);
+
+/**
+ * @brief 获取虚拟灯带当前模式
+ */
+bsp_led_strip_mode_t bsp_sim_get_led_strip_mode(void);
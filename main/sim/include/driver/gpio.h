@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_attr.h"
+#include "esp_err.h"
+
+/**************************************************************************************************
+ *
+ * Simulation Mock // GPIO
+ *
+ * 仿真板使用的 driver/gpio.h 替身, 仅实现本工程用到的接口
+ **************************************************************************************************/
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_1,
+    GPIO_NUM_2,
+    GPIO_NUM_3,
+    GPIO_NUM_4,
+    GPIO_NUM_5,
+    GPIO_NUM_6,
+    GPIO_NUM_7,
+    GPIO_NUM_8,
+    GPIO_NUM_9,
+    GPIO_NUM_10,
+    GPIO_NUM_MAX,
+} gpio_num_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+} gpio_int_type_t;
+
+typedef enum {
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+esp_err_t gpio_config(const gpio_config_t* config);
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+
+int gpio_get_level(gpio_num_t gpio_num);
+
+/**
+ * @brief 输出电平变化回调, 用于观测被驱动的虚拟外设
+ */
+typedef void (*sim_gpio_output_cb_t)(gpio_num_t gpio_num, uint32_t level);
+
+void sim_gpio_register_output_cb(sim_gpio_output_cb_t cb);
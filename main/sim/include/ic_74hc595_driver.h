@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+/**************************************************************************************************
+ *
+ * Simulation Mock // 74HC595 Shift Register
+ *
+ * 仿真板使用的 ic_74hc595_driver 替身, 移位寄存器与存储寄存器均为内存变量
+ **************************************************************************************************/
+
+typedef struct {
+    gpio_num_t ds;
+    gpio_num_t shcp;
+    gpio_num_t stcp;
+    gpio_num_t oe_;
+    gpio_num_t mr_;
+} ic_74hc595_config_t;
+
+typedef void* ic_74hc595_handle_t;
+
+esp_err_t ic_74hc595_init(const ic_74hc595_config_t* config, ic_74hc595_handle_t* handle);
+
+void ic_74hc595_write(ic_74hc595_handle_t handle, uint8_t data);
+
+void ic_74hc595_latch(ic_74hc595_handle_t handle);
+
+void ic_74hc595_reset(ic_74hc595_handle_t handle);
+
+/**
+ * @brief 获取最近一次锁存到存储寄存器(并行输出)的值
+ */
+uint8_t sim_74hc595_get_output(void);
@@ -0,0 +1,157 @@
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "ic_74hc595_driver.h"
+
+/**************************************************************************************************
+ * Implementation // GPIO
+ **************************************************************************************************/
+
+static uint32_t sim_gpio_levels[GPIO_NUM_MAX] = {0};
+static sim_gpio_output_cb_t sim_gpio_output_cb = NULL;
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+    return config->pin_bit_mask >> GPIO_NUM_MAX ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_set_level(const gpio_num_t gpio_num, const uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) { return ESP_ERR_INVALID_ARG; }
+
+    sim_gpio_levels[gpio_num] = level;
+    if (sim_gpio_output_cb != NULL) { sim_gpio_output_cb(gpio_num, level); }
+
+    return ESP_OK;
+}
+
+int gpio_get_level(const gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) { return 0; }
+    return (int)sim_gpio_levels[gpio_num];
+}
+
+void sim_gpio_register_output_cb(const sim_gpio_output_cb_t cb) { sim_gpio_output_cb = cb; }
+
+/**************************************************************************************************
+ * Implementation // General Purpose Timer
+ **************************************************************************************************/
+
+struct sim_gptimer_t {
+    uint32_t resolution_hz;
+    gptimer_alarm_config_t alarm;
+    gptimer_alarm_cb_t on_alarm;
+    void* user_data;
+    volatile bool running;
+    TaskHandle_t task;
+};
+
+/**
+ * @brief [仿真任务]定时器报警, 以最高优先级运行以模拟中断上下文
+ */
+static void sim_gptimer_task(void* pvParameters) {
+    gptimer_handle_t timer = pvParameters;
+
+    while (1) {
+        if (!timer->running) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        const uint64_t period_us = timer->alarm.alarm_count * 1000000ULL / timer->resolution_hz;
+        const TickType_t period_ticks = pdMS_TO_TICKS(period_us / 1000) > 0 ? pdMS_TO_TICKS(period_us / 1000) : 1;
+        vTaskDelay(period_ticks);
+
+        if (timer->running && timer->on_alarm != NULL) {
+            const gptimer_alarm_event_data_t edata = {
+                .count_value = timer->alarm.alarm_count,
+                .alarm_value = timer->alarm.alarm_count,
+            };
+            timer->on_alarm(timer, &edata, timer->user_data);
+        }
+        if (!timer->alarm.flags.auto_reload_on_alarm) { timer->running = false; }
+    }
+}
+
+esp_err_t gptimer_new_timer(const gptimer_config_t* config, gptimer_handle_t* ret_timer) {
+    gptimer_handle_t timer = calloc(1, sizeof(struct sim_gptimer_t));
+    if (timer == NULL) { return ESP_ERR_NO_MEM; }
+
+    timer->resolution_hz = config->resolution_hz;
+
+    *ret_timer = timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t* cbs, void* user_data) {
+    timer->on_alarm = cbs->on_alarm;
+    timer->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t* config) {
+    timer->alarm = *config;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer) {
+    if (timer->task != NULL) { return ESP_ERR_INVALID_STATE; }
+
+    const BaseType_t ret = xTaskCreate(sim_gptimer_task, "SimGPTimer", 4096, timer, configMAX_PRIORITIES - 1, &timer->task);
+    return ret == pdPASS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer) {
+    if (timer->task == NULL || timer->running) { return ESP_ERR_INVALID_STATE; }
+
+    timer->running = true;
+    xTaskNotifyGive(timer->task);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer) {
+    if (!timer->running) { return ESP_ERR_INVALID_STATE; }
+
+    timer->running = false;
+    return ESP_OK;
+}
+
+/**************************************************************************************************
+ * Implementation // 74HC595 Shift Register
+ **************************************************************************************************/
+
+typedef struct {
+    uint8_t shift_reg;   // 移位寄存器
+    uint8_t storage_reg; // 存储寄存器
+} sim_74hc595_dev_t;
+
+static uint8_t sim_74hc595_output = 0;
+
+esp_err_t ic_74hc595_init(const ic_74hc595_config_t* config, ic_74hc595_handle_t* handle) {
+    sim_74hc595_dev_t* dev = calloc(1, sizeof(sim_74hc595_dev_t));
+    if (dev == NULL) { return ESP_ERR_NO_MEM; }
+
+    *handle = dev;
+    return ESP_OK;
+}
+
+void ic_74hc595_write(ic_74hc595_handle_t handle, const uint8_t data) {
+    sim_74hc595_dev_t* dev = handle;
+    dev->shift_reg = data;
+}
+
+void ic_74hc595_latch(ic_74hc595_handle_t handle) {
+    sim_74hc595_dev_t* dev = handle;
+    dev->storage_reg = dev->shift_reg;
+    sim_74hc595_output = dev->storage_reg;
+}
+
+void ic_74hc595_reset(ic_74hc595_handle_t handle) {
+    sim_74hc595_dev_t* dev = handle;
+    dev->shift_reg = 0;
+    dev->storage_reg = 0;
+    sim_74hc595_output = 0;
+}
+
+uint8_t sim_74hc595_get_output(void) { return sim_74hc595_output; }
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+从运行日志辨识毛巾架温度估计器 (app_estimator.c) 的模型参数, 并计算稳态卡尔曼增益.
+
+日志来自开启 CONFIG_APP_ESTIMATOR_LOG 的设备或仿真板, 每个控制周期一行:
+    EST,<时间ms>,<占空比‰>,<NTC读数m°C>,<估计温度m°C>
+
+用法:
+    python tools/identify_thermal_model.py monitor.log [--q-rack 50] [--q-ntc 5] [--r 250]
+
+输出可直接粘贴到 sdkconfig 的 CONFIG_APP_ESTIMATOR_* 配置项.
+"""
+
+import argparse
+import re
+import sys
+
+EST_LINE = re.compile(r"EST,(\d+),(\d+),(-?\d+),(-?\d+)")
+
+
+def load_samples(path):
+    samples = []
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            m = EST_LINE.search(line)
+            if m:
+                t_ms, duty, ntc, _ = (int(v) for v in m.groups())
+                samples.append((t_ms, duty / 1000.0, ntc / 1000.0))
+    return samples
+
+
+def simulate(samples, heat_rate, loss_tau, ntc_tau, ambient):
+    """开环仿真模型, 返回NTC温度的预测序列"""
+    rack = ntc = samples[0][2]
+    predicted = [ntc]
+    for (t0, duty, _), (t1, _, _) in zip(samples, samples[1:]):
+        dt = (t1 - t0) / 1000.0
+        rack, ntc = (rack + dt * (heat_rate * duty - (rack - ambient) / loss_tau),
+                     ntc + dt * (rack - ntc) / ntc_tau)
+        predicted.append(ntc)
+    return predicted
+
+
+def cost(samples, params):
+    heat_rate, loss_tau, ntc_tau, _ = params
+    if heat_rate <= 0 or loss_tau <= 1 or ntc_tau <= 1:
+        return float("inf")
+    predicted = simulate(samples, *params)
+    return sum((p - s[2]) ** 2 for p, s in zip(predicted, samples))
+
+
+def nelder_mead(f, x0, steps, iterations=2000, tol=1e-9):
+    """无依赖的 Nelder-Mead 单纯形优化"""
+    simplex = [list(x0)]
+    for i, step in enumerate(steps):
+        x = list(x0)
+        x[i] += step
+        simplex.append(x)
+    values = [f(x) for x in simplex]
+
+    for _ in range(iterations):
+        order = sorted(range(len(simplex)), key=values.__getitem__)
+        simplex = [simplex[i] for i in order]
+        values = [values[i] for i in order]
+        if abs(values[-1] - values[0]) < tol:
+            break
+
+        centroid = [sum(x[i] for x in simplex[:-1]) / (len(simplex) - 1) for i in range(len(x0))]
+        worst = simplex[-1]
+        reflected = [c + (c - w) for c, w in zip(centroid, worst)]
+        fr = f(reflected)
+        if fr < values[0]:
+            expanded = [c + 2 * (c - w) for c, w in zip(centroid, worst)]
+            fe = f(expanded)
+            simplex[-1], values[-1] = (expanded, fe) if fe < fr else (reflected, fr)
+        elif fr < values[-2]:
+            simplex[-1], values[-1] = reflected, fr
+        else:
+            contracted = [c + 0.5 * (w - c) for c, w in zip(centroid, worst)]
+            fc = f(contracted)
+            if fc < values[-1]:
+                simplex[-1], values[-1] = contracted, fc
+            else:
+                best = simplex[0]
+                simplex = [best] + [[b + 0.5 * (x - b) for b, x in zip(best, s)] for s in simplex[1:]]
+                values = [values[0]] + [f(x) for x in simplex[1:]]
+    return simplex[0], values[0]
+
+
+def steady_state_gain(dt, loss_tau, ntc_tau, q_rack, q_ntc, r):
+    """迭代离散 Riccati 方程, 返回稳态卡尔曼增益 (Kr, Kn)"""
+    a = [[1 - dt / loss_tau, 0.0], [dt / ntc_tau, 1 - dt / ntc_tau]]
+    p = [[1.0, 0.0], [0.0, 1.0]]
+    k = (0.0, 0.0)
+    for _ in range(100000):
+        # 预测协方差 P = A P A^T + Q
+        ap = [[sum(a[i][m] * p[m][j] for m in range(2)) for j in range(2)] for i in range(2)]
+        p = [[sum(ap[i][m] * a[j][m] for m in range(2)) for j in range(2)] for i in range(2)]
+        p[0][0] += q_rack
+        p[1][1] += q_ntc
+        # 观测 y = Tn
+        s = p[1][1] + r
+        k_new = (p[0][1] / s, p[1][1] / s)
+        p = [[p[0][0] - k_new[0] * p[1][0], p[0][1] - k_new[0] * p[1][1]],
+             [p[1][0] - k_new[1] * p[1][0], p[1][1] - k_new[1] * p[1][1]]]
+        if abs(k_new[0] - k[0]) < 1e-12 and abs(k_new[1] - k[1]) < 1e-12:
+            break
+        k = k_new
+    return k
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="包含 EST 行的运行日志")
+    parser.add_argument("--q-rack", type=float, default=50e-6, help="本体温度过程噪声方差 (°C^2/周期)")
+    parser.add_argument("--q-ntc", type=float, default=5e-6, help="NTC温度过程噪声方差 (°C^2/周期)")
+    parser.add_argument("--r", type=float, default=0.25, help="NTC测量噪声方差 (°C^2)")
+    args = parser.parse_args()
+
+    samples = load_samples(args.log)
+    if len(samples) < 100:
+        sys.exit("需要至少 100 个 EST 采样, 请记录一次包含升温与保温过程的完整运行")
+
+    x0 = [0.02, 2000.0, 60.0, samples[0][2]]
+    params, sse = nelder_mead(lambda x: cost(samples, x), x0, [0.01, 500.0, 20.0, 2.0])
+    heat_rate, loss_tau, ntc_tau, ambient = params
+    rmse = (sse / len(samples)) ** 0.5
+
+    dt = (samples[-1][0] - samples[0][0]) / 1000.0 / (len(samples) - 1)
+    k_rack, k_ntc = steady_state_gain(dt, loss_tau, ntc_tau, args.q_rack, args.q_ntc, args.r)
+
+    print(f"# {len(samples)} samples, dt {dt:.2f} s, fit RMSE {rmse:.3f} °C")
+    print(f"CONFIG_APP_ESTIMATOR_HEAT_RATE={round(heat_rate * 1000)}")
+    print(f"CONFIG_APP_ESTIMATOR_LOSS_TAU_S={round(loss_tau)}")
+    print(f"CONFIG_APP_ESTIMATOR_NTC_TAU_S={round(ntc_tau)}")
+    print(f"CONFIG_APP_ESTIMATOR_AMBIENT_TEMP={round(ambient)}")
+    print(f"CONFIG_APP_ESTIMATOR_GAIN_RACK_Q15={round(k_rack * 32768)}")
+    print(f"CONFIG_APP_ESTIMATOR_GAIN_NTC_Q15={round(k_ntc * 32768)}")
+    print(f"CONFIG_APP_ESTIMATOR_GAIN_DT_MS={round(dt * 1000)}")
+
+
+if __name__ == "__main__":
+    main()
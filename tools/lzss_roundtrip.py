@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+在主机上检查OTA升级包的压缩与解压: tools/ota_pack.py 打包, 设备端的C解压器 (main/app_lzss.c) 解压, 结果与原始数据
+不一致时以非零状态退出.
+
+C解压器用主机编译器编译为共享库后经 ctypes 调用. 每个输入按随机的输入/输出分块多次解压, 覆盖记号与回溯复制
+跨越调用边界的情况, 与 app_ota.c 按网络分块喂入, 按flash写入缓冲区取出的用法一致.
+
+用法:
+    python tools/lzss_roundtrip.py                         内置样本 (随机数据, 全零, 重复文本, 短输入)
+    python tools/lzss_roundtrip.py build/TowelRack-Controller-WiFi.bin --splits 50
+"""
+
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import ota_pack  # noqa: E402
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DECODER_SIZE = 4096  # 不小于 sizeof(app_lzss_decoder_t)
+
+
+def build_decoder(cc, directory):
+    library = os.path.join(directory, "liblzss.so")
+    subprocess.run([cc, "-O2", "-shared", "-fPIC", "-I", os.path.join(REPO, "main", "include"),
+                    os.path.join(REPO, "main", "app_lzss.c"), "-o", library], check=True)
+    lib = ctypes.CDLL(library)
+    lib.app_lzss_init.argtypes = [ctypes.c_void_p]
+    lib.app_lzss_decode.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t),
+                                    ctypes.c_void_p, ctypes.c_size_t]
+    lib.app_lzss_decode.restype = ctypes.c_size_t
+    return lib
+
+
+def decode(lib, payload, size, rng):
+    """按随机分块解压 payload, 返回解压结果"""
+    dec = ctypes.create_string_buffer(DECODER_SIZE)
+    lib.app_lzss_init(dec)
+    src = ctypes.create_string_buffer(payload, len(payload))
+    out = bytearray()
+
+    def drain(position, length):
+        pointer = ctypes.c_void_p(ctypes.addressof(src) + position)
+        remaining = ctypes.c_size_t(length)
+        while len(out) < size:
+            cap = min(rng.choice((1, 7, 64, 512, 4096)), size - len(out))
+            buf = ctypes.create_string_buffer(cap)
+            n = lib.app_lzss_decode(dec, ctypes.byref(pointer), ctypes.byref(remaining), buf, cap)
+            out.extend(buf.raw[:n])
+            if n < cap:
+                break
+        return length - remaining.value
+
+    position = 0
+    while position < len(payload):
+        length = min(rng.randint(1, 300), len(payload) - position)
+        consumed = drain(position, length)
+        if consumed != length and len(out) < size:
+            raise AssertionError(f"decoder left {length - consumed} B of input with output pending")
+        position += length
+    drain(position, 0)
+    return bytes(out)
+
+
+def samples(paths, rng):
+    for path in paths:
+        with open(path, "rb") as f:
+            yield os.path.basename(path), f.read()
+    if paths:
+        return
+    yield "random", bytes(rng.getrandbits(8) for _ in range(20000))
+    yield "zeros", bytes(30000)
+    yield "text", b"".join(b"heating_task period %d ms, duty %d permille\n" % (i % 97, i % 1000) for i in range(2000))
+    yield "short", b"a"
+    yield "empty", b""
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Round-trip OTA packages through the C LZSS decoder")
+    parser.add_argument("inputs", nargs="*", help="images to pack, default built-in samples")
+    parser.add_argument("--splits", type=int, default=20, help="random input/output splits per image")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    args = parser.parse_args()
+    rng = random.Random(args.seed)
+
+    failed = 0
+    with tempfile.TemporaryDirectory() as directory:
+        lib = build_decoder(args.cc, directory)
+        for name, image in samples(args.inputs, rng):
+            package = ota_pack.pack(image)
+            header = ota_pack.HEADER.unpack_from(package)
+            payload = package[ota_pack.HEADER.size:ota_pack.HEADER.size + header[6]]
+            bad = 0
+            for _ in range(args.splits):
+                try:
+                    bad += decode(lib, payload, len(image), rng) != image
+                except AssertionError as e:
+                    print(f"{name}: {e}")
+                    bad += 1
+            print(f"{name}: {len(image)} -> {len(payload)} B, {args.splits - bad}/{args.splits} splits ok")
+            failed += bad > 0
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
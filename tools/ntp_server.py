@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""
+本地SNTP服务, 代替真实的NTP服务器测试 app_time.c.
+
+服务的时间可以按倍率加速并叠加频率偏差与跳变, 用于验证设备的频率偏差估计:
+    服务时间 = 启动时刻 + 经过的时间 × rate × (1 + drift_ppm / 10^6) + offset
+
+用法:
+    python tools/ntp_server.py --port 1123
+    设备配置: CONFIG_APP_TIME_NTP_SERVER="<主机IP>", CONFIG_APP_TIME_NTP_PORT=1123, 命令行 time sync 立即同步
+
+    仿真板按虚拟时间计时, rate 需与 CONFIG_SIM_TIME_SCALE 相同 (见 sdkconfig.sim.time):
+    python tools/ntp_server.py --port 1123 --rate 100 --drift-ppm 50
+    设备估计的频率偏差应收敛到约 -50 ppm (相对服务器偏慢)
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+NTP_UNIX_OFFSET_S = 2208988800
+
+
+def to_ntp(t):
+    sec = int(t)
+    frac = int((t - sec) * (1 << 32)) & 0xFFFFFFFF
+    return ((sec + NTP_UNIX_OFFSET_S) & 0xFFFFFFFF) << 32 | frac
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve SNTP time for testing")
+    parser.add_argument("--port", type=int, default=123)
+    parser.add_argument("--rate", type=float, default=1.0, help="time scale, match CONFIG_SIM_TIME_SCALE")
+    parser.add_argument("--drift-ppm", type=float, default=0.0, help="frequency error added to the served clock")
+    parser.add_argument("--offset", type=float, default=0.0, help="constant offset added to the served time (s)")
+    parser.add_argument("--step-after", type=float, default=0.0, help="step the served time after N real seconds")
+    parser.add_argument("--step", type=float, default=0.0, help="size of the step (s)")
+    parser.add_argument("--stratum", type=int, default=2, help="0 makes the server look unsynchronized")
+    args = parser.parse_args()
+
+    start_real = time.monotonic()
+    start_wall = time.time()
+
+    def served_time():
+        elapsed = time.monotonic() - start_real
+        t = start_wall + elapsed * args.rate * (1 + args.drift_ppm * 1e-6) + args.offset
+        if args.step_after > 0 and elapsed >= args.step_after:
+            t += args.step
+        return t
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", args.port))
+    print(f"Serving SNTP on port {args.port}, rate {args.rate}, drift {args.drift_ppm} ppm")
+
+    while True:
+        request, addr = sock.recvfrom(512)
+        receive = served_time()
+        if len(request) < 48 or request[0] & 0x07 != 3:
+            continue
+
+        version = request[0] >> 3 & 0x07
+        originate = request[40:48]
+        header = struct.pack("!BBbb", version << 3 | 4, args.stratum, 6, -20)
+        body = struct.pack("!II4sQ", 0, 0, b"LOCL", to_ntp(receive))
+        reply = header + body + originate + struct.pack("!QQ", to_ntp(receive), to_ntp(served_time()))
+        sock.sendto(reply, addr)
+        print(f"{addr[0]}:{addr[1]} served {time.strftime('%Y-%m-%d %H:%M:%S', time.gmtime(receive))} UTC")
+
+
+if __name__ == "__main__":
+    main()
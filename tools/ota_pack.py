@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+把固件镜像压缩打包为OTA升级包 (app_ota.c 的下载格式).
+
+升级包 = 48字节包头 + LZSS压缩数据 (heatshrink 格式, 见 main/include/app_lzss.h):
+    magic "TRCZ" | version u8 | window_bits u8 | lookahead_bits u8 | reserved u8 |
+    image_size u32 | payload_size u32 | sha256(原始镜像) 32字节        (小端)
+
+用法:
+    python tools/ota_pack.py build/TowelRack-Controller-WiFi.bin -o fw.trcz
+    python tools/ota_pack.py --unpack fw.trcz -o check.bin
+
+在主机上测试OTA:
+    python tools/lzss_roundtrip.py build/TowelRack-Controller-WiFi.bin    本脚本打包, 设备端C解压器按随机分块解压
+    cd <升级包所在目录> && python -m http.server 8000
+    设备命令行: ota start http://<主机IP>:8000/fw.trcz
+    仿真板 (linux) 没有OTA分区, 下载与写入只能在芯片上运行; 主机只检查升级包格式与解压.
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+
+MAGIC = b"TRCZ"
+VERSION = 1
+HEADER = struct.Struct("<4sBBBBII32s")
+WINDOW_BITS = 10   # 必须与 APP_LZSS_WINDOW_BITS 一致
+LOOKAHEAD_BITS = 5  # 必须与 APP_LZSS_LOOKAHEAD_BITS 一致
+MIN_MATCH = 2       # 回溯记号 16 位, 两个字面量 18 位, 长度2起即可获益
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.count = 0
+
+    def write(self, value, bits):
+        self.acc = (self.acc << bits) | value
+        self.count += bits
+        while self.count >= 8:
+            self.count -= 8
+            self.out.append((self.acc >> self.count) & 0xFF)
+        self.acc &= (1 << self.count) - 1
+
+    def flush(self):
+        if self.count:
+            self.out.append((self.acc << (8 - self.count)) & 0xFF)
+            self.acc = self.count = 0
+        return bytes(self.out)
+
+
+def longest_match(data, pos, window, max_len):
+    """在窗口内查找最长匹配, 匹配长度单调, 用二分查找减少搜索次数"""
+    start = max(0, pos - window)
+    limit = min(max_len, len(data) - pos)
+    if limit < MIN_MATCH:
+        return 0, 0
+    found = data.rfind(data[pos:pos + MIN_MATCH], start, pos + MIN_MATCH - 1)
+    if found < 0:
+        return 0, 0
+    best_len, best_at = MIN_MATCH, found
+    lo, hi = MIN_MATCH + 1, limit
+    while lo <= hi:
+        mid = (lo + hi) // 2
+        at = data.rfind(data[pos:pos + mid], start, pos + mid - 1)
+        if at >= 0:
+            best_len, best_at = mid, at
+            lo = mid + 1
+        else:
+            hi = mid - 1
+    return best_len, pos - best_at
+
+
+def compress(data, window_bits=WINDOW_BITS, lookahead_bits=LOOKAHEAD_BITS):
+    window, max_len = 1 << window_bits, 1 << lookahead_bits
+    writer = BitWriter()
+    pos = 0
+    while pos < len(data):
+        length, distance = longest_match(data, pos, window, max_len)
+        if length >= MIN_MATCH:
+            writer.write(0, 1)
+            writer.write(distance - 1, window_bits)
+            writer.write(length - 1, lookahead_bits)
+            pos += length
+        else:
+            writer.write(1, 1)
+            writer.write(data[pos], 8)
+            pos += 1
+    return writer.flush()
+
+
+def decompress(payload, size, window_bits=WINDOW_BITS, lookahead_bits=LOOKAHEAD_BITS):
+    out = bytearray()
+    bit_pos, total_bits = 0, len(payload) * 8
+
+    def read(bits):
+        nonlocal bit_pos
+        value = 0
+        for _ in range(bits):
+            value = (value << 1) | ((payload[bit_pos >> 3] >> (7 - (bit_pos & 7))) & 1)
+            bit_pos += 1
+        return value
+
+    while len(out) < size and bit_pos < total_bits:
+        if read(1):
+            out.append(read(8))
+        else:
+            distance = read(window_bits) + 1
+            for _ in range(read(lookahead_bits) + 1):
+                out.append(out[-distance])
+    return bytes(out[:size])
+
+
+def pack(image):
+    payload = compress(image)
+    header = HEADER.pack(MAGIC, VERSION, WINDOW_BITS, LOOKAHEAD_BITS, 0, len(image), len(payload),
+                         hashlib.sha256(image).digest())
+    return header + payload
+
+
+def unpack(package):
+    magic, version, window_bits, lookahead_bits, _, image_size, payload_size, digest = \
+        HEADER.unpack_from(package)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not an OTA package")
+    payload = package[HEADER.size:HEADER.size + payload_size]
+    image = decompress(payload, image_size, window_bits, lookahead_bits)
+    if len(image) != image_size or hashlib.sha256(image).digest() != digest:
+        raise ValueError("image digest mismatch")
+    return image
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="固件镜像 (.bin), 或 --unpack 时的升级包")
+    parser.add_argument("-o", "--output", required=True)
+    parser.add_argument("--unpack", action="store_true", help="解包并校验升级包")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    try:
+        result = unpack(data) if args.unpack else pack(data)
+    except ValueError as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 1
+
+    if not args.unpack:
+        # 打包后立即解包校验, 避免发布损坏的升级包
+        if unpack(result) != data:
+            print("error: round-trip verification failed", file=sys.stderr)
+            return 1
+        print(f"{len(data)} -> {len(result)} bytes ({100 * len(result) / len(data):.1f}%)")
+
+    with open(args.output, "wb") as f:
+        f.write(result)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+把采样剖析器 (main/app_prof.c) 输出的直方图对照ELF符号化, 生成折叠栈.
+
+折叠栈每行为 "<任务>;<函数> <采样数>", 可直接交给 flamegraph.pl 或 speedscope.
+剖析器只记录被中断的指令地址, 不展开调用栈, 每个栈只有任务与叶子函数两层;
+被中断的代码本身在中断中时任务为 ISR.
+
+用法:
+    设备命令行: prof start [<rate_hz>] ... prof dump, 串口输出保存为 prof.log (如 idf.py monitor | tee prof.log)
+    python tools/profile_fold.py prof.log build/TowelRack-Controller-WiFi.elf > prof.folded
+    flamegraph.pl prof.folded > prof.svg
+
+    日志中有多次 dump 时使用最后一次. --top N 在标准错误输出占比最高的 N 个函数.
+    QEMU 与构建方法见 sdkconfig.prof.
+"""
+
+import argparse
+import collections
+import re
+import subprocess
+import sys
+
+LINE = re.compile(r"(PROF_INFO|PROF_TASK|PROF_END|PROF),?([^\s\x1b]*)")
+
+
+def parse_dump(lines):
+    """返回最后一次完整 dump 的 (info, tasks, samples)"""
+    result = None
+    current = None
+    for line in lines:
+        match = LINE.search(line)
+        if not match:
+            continue
+        kind, fields = match.group(1), match.group(2).split(",")
+        if kind == "PROF_INFO":
+            rate, samples, dropped, duration = (int(x) for x in fields[:4])
+            current = ({"rate_hz": rate, "samples": samples, "dropped": dropped, "duration_ms": duration}, {}, [])
+        elif current is None:
+            continue
+        elif kind == "PROF_TASK":
+            current[1][int(fields[0])] = ",".join(fields[1:])
+        elif kind == "PROF":
+            current[2].append((int(fields[0], 16), int(fields[1]), int(fields[2])))
+        elif kind == "PROF_END":
+            result = current
+            current = None
+    return result
+
+
+def symbolize(addr2line, elf, addresses):
+    """返回 {地址: (函数, 文件:行)}, 无法解析的地址不在结果中"""
+    symbols = {}
+    addresses = sorted(addresses)
+    for start in range(0, len(addresses), 500):
+        chunk = addresses[start : start + 500]
+        output = subprocess.run(
+            [addr2line, "-a", "-f", "-C", "-e", elf] + [f"0x{a:08x}" for a in chunk],
+            check=True,
+            capture_output=True,
+            text=True,
+        ).stdout.splitlines()
+        for i in range(0, len(output) - 2, 3):
+            address, function, location = int(output[i], 16), output[i + 1], output[i + 2]
+            if function != "??":
+                symbols[address] = (function, location.split(" ")[0])
+    return symbols
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fold app_prof histograms into flame graph stacks")
+    parser.add_argument("log", help="serial log containing a 'prof dump', - for stdin")
+    parser.add_argument("elf", help="firmware ELF used to symbolize the sampled addresses")
+    parser.add_argument("-o", "--output", help="folded stacks output (default stdout)")
+    parser.add_argument("--addr2line", default="riscv32-esp-elf-addr2line", help="addr2line of the target toolchain")
+    parser.add_argument("--no-task", action="store_true", help="merge all tasks, fold by function only")
+    parser.add_argument("--lines", action="store_true", help="fold by source line instead of function")
+    parser.add_argument("--top", type=int, default=0, help="print the N hottest functions to stderr")
+    args = parser.parse_args()
+
+    with sys.stdin if args.log == "-" else open(args.log, errors="replace") as f:
+        dump = parse_dump(f)
+    if dump is None:
+        sys.exit("no complete PROF_INFO ... PROF_END block found")
+    info, tasks, samples = dump
+
+    symbols = symbolize(args.addr2line, args.elf, {pc for pc, _, _ in samples})
+
+    stacks = collections.Counter()
+    functions = collections.Counter()
+    for pc, task, count in samples:
+        function, location = symbols.get(pc, (f"0x{pc:08x}", ""))
+        leaf = f"{function} ({location})" if args.lines and location else function
+        stacks[leaf if args.no_task else f"{tasks.get(task, task)};{leaf}"] += count
+        functions[function] += count
+
+    with open(args.output, "w") if args.output else sys.stdout as out:
+        for stack, count in sorted(stacks.items()):
+            out.write(f"{stack} {count}\n")
+
+    total = sum(functions.values())
+    print(f"{total} samples at {info['rate_hz']} Hz over {info['duration_ms'] / 1000:.1f} s, "
+          f"{info['dropped']} dropped, {len(samples) - sum(pc in symbols for pc, _, _ in samples)} unresolved",
+          file=sys.stderr)
+    for function, count in functions.most_common(args.top if total else 0):
+        print(f"{count * 100 / total:6.2f}% {count:8d}  {function}", file=sys.stderr)
+    if total != info["samples"]:
+        print(f"warning: PROF lines add up to {total} samples, PROF_INFO reports {info['samples']}, "
+              "lines were lost from the log", file=sys.stderr)
+    if samples and all(tasks.get(task) == "ISR" for _, task, _ in samples):
+        print("warning: every sample is attributed to ISR, the firmware cannot tell tasks apart", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
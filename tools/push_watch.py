@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+连接WebSocket状态推送 (main/app_push.c), 逐行输出收到的状态变化, 只使用标准库.
+
+每行为 "<自连接起的秒数> <JSON>", JSON 只含变化的字段; --state 改为输出合并后的完整状态.
+
+用法:
+    python tools/push_watch.py ws://<设备IP>:8080/
+    仿真板见 sdkconfig.sim.push: python tools/push_watch.py ws://127.0.0.1:8080/
+
+    --pause S 收到第一帧后停止读取 S 秒, 模拟慢速客户端. 暂停期间设备仍按最小间隔发出的帧缓存在两端的
+    内核缓冲区中, 恢复后会一并收到; 只有缓冲区写满、设备发送缓冲区无法排空后, 后续变化才合并为一帧
+    (设备命令行 push 的 merged 计数增加). --count N 收到 N 帧后退出, 用于脚本测试.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import os
+import socket
+import struct
+import sys
+import time
+import urllib.parse
+
+WS_GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+class Reader:
+    """带缓冲的接收, 握手响应之后可能紧跟着第一帧"""
+
+    def __init__(self, sock, data=b""):
+        self.sock = sock
+        self.data = data
+
+    def exact(self, n):
+        while len(self.data) < n:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            self.data += chunk
+        out, self.data = self.data[:n], self.data[n:]
+        return out
+
+
+def send_frame(sock, opcode, payload=b""):
+    """客户端帧必须加掩码"""
+    mask = os.urandom(4)
+    masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+    sock.sendall(struct.pack("!BB", 0x80 | opcode, 0x80 | len(payload)) + mask + masked)
+
+
+def recv_frame(reader):
+    first, second = reader.exact(2)
+    length = second & 0x7F
+    if length == 126:
+        length = struct.unpack("!H", reader.exact(2))[0]
+    elif length == 127:
+        length = struct.unpack("!Q", reader.exact(8))[0]
+    return first & 0x0F, reader.exact(length)
+
+
+def connect(url, timeout):
+    parts = urllib.parse.urlsplit(url)
+    if parts.scheme != "ws":
+        sys.exit("only ws:// URLs are supported")
+    sock = socket.create_connection((parts.hostname, parts.port or 80), timeout=timeout)
+
+    key = base64.b64encode(os.urandom(16))
+    request = (
+        f"GET {parts.path or '/'} HTTP/1.1\r\nHost: {parts.netloc}\r\nUpgrade: websocket\r\n"
+        f"Connection: Upgrade\r\nSec-WebSocket-Key: {key.decode()}\r\nSec-WebSocket-Version: 13\r\n\r\n"
+    )
+    sock.sendall(request.encode())
+
+    response = b""
+    while b"\r\n\r\n" not in response:
+        chunk = sock.recv(1024)
+        if not chunk:
+            sys.exit("connection closed during handshake")
+        response += chunk
+    head, rest = response.split(b"\r\n\r\n", 1)
+    lines = head.decode(errors="replace").split("\r\n")
+    if " 101 " not in lines[0]:
+        sys.exit(f"handshake rejected: {lines[0]}")
+    expected = base64.b64encode(hashlib.sha1(key + WS_GUID).digest()).decode()
+    headers = {k.strip().lower(): v.strip() for k, v in (line.split(":", 1) for line in lines[1:] if ":" in line)}
+    if headers.get("sec-websocket-accept") != expected:
+        sys.exit("handshake failed: bad Sec-WebSocket-Accept")
+    sock.settimeout(None)
+    return sock, Reader(sock, rest)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Watch live state pushed by the controller over WebSocket")
+    parser.add_argument("url", help="ws://<host>:<port>/")
+    parser.add_argument("--state", action="store_true", help="print the merged full state instead of deltas")
+    parser.add_argument("--pause", type=float, default=0.0, help="stop reading for S seconds after the first frame")
+    parser.add_argument("--count", type=int, default=0, help="exit after N frames")
+    parser.add_argument("--timeout", type=float, default=5.0, help="connect and handshake timeout (s)")
+    args = parser.parse_args()
+
+    sock, reader = connect(args.url, args.timeout)
+    start = time.monotonic()
+    state = {}
+    frames = 0
+    received = 0
+
+    try:
+        while True:
+            opcode, payload = recv_frame(reader)
+            if opcode == 0x8:
+                send_frame(sock, 0x8, payload[:2])
+                break
+            if opcode == 0x9:
+                send_frame(sock, 0xA, payload)
+                continue
+            if opcode != 0x1:
+                continue
+
+            frames += 1
+            received += len(payload)
+            delta = json.loads(payload)
+            state.update(delta)
+            print(f"{time.monotonic() - start:8.3f} {json.dumps(state if args.state else delta)}", flush=True)
+
+            if args.count and frames >= args.count:
+                send_frame(sock, 0x8, struct.pack("!H", 1000))
+                break
+            if args.pause and frames == 1:
+                time.sleep(args.pause)
+    except (ConnectionError, KeyboardInterrupt):
+        pass
+    finally:
+        sock.close()
+
+    print(f"{frames} frames, {received} bytes of JSON in {time.monotonic() - start:.1f} s", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+检查模拟器多实例回放中峰值功率协调 (main/app_coord.c) 的结果, 同时加热的总功率超过上限时以非零状态退出.
+
+每个日志对应一个实例, 按SIM报告的虚拟秒数 (第2列) 对齐, 累加各实例各通道的加热器状态 (第5列及每个附加通道的
+第3列) 乘以 --power-w. 各实例启动时刻相差数十毫秒, 虚拟时间相差约 启动差 * SIM_TIME_SCALE, 因此只统计在
+--edge-s 秒内没有任何实例切换加热器的时刻; 切换附近的重叠另行输出, 不计入失败.
+
+用法:
+    按 sdkconfig.sim.coord 中的说明构建并运行
+    python tools/sim_coordcheck.py coord_*.log
+    python tools/sim_coordcheck.py --cap-w 2000 --power-w 1000 coord_1.log coord_2.log coord_3.log
+"""
+
+import argparse
+import re
+import sys
+
+SIM = re.compile(r"^SIM,(\d+),(.*)$")
+
+
+def heater_states(path):
+    """返回 {虚拟秒: 加热中的通道数}"""
+    states = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = SIM.search(line.strip())
+            if not match:
+                continue
+            fields = match.group(2).split(",")
+            channels = [fields[2]] + fields[7 + 2 :: 3]
+            states[int(match.group(1))] = sum(int(c) for c in channels if c.isdigit())
+    return states
+
+
+def near_switch(states, now_s, edge_s):
+    before = states.get(now_s - edge_s)
+    after = states.get(now_s + edge_s)
+    return before is None or after is None or not before == states[now_s] == after
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gate the shared power cap of a multi-instance coordination run")
+    parser.add_argument("logs", nargs="+", help="simulator output of each instance")
+    parser.add_argument("--cap-w", type=int, default=2000, help="APP_COORD_CAP_W of the run")
+    parser.add_argument("--power-w", type=int, default=1000, help="SIM_HEATER_POWER_W of every channel")
+    parser.add_argument("--edge-s", type=int, default=2, help="virtual seconds around a switch not gated")
+    args = parser.parse_args()
+
+    instances = [heater_states(path) for path in args.logs]
+    common = sorted(set.intersection(*(set(states) for states in instances)))
+    if not common:
+        sys.exit("no common SIM report times, was SIM_REPORT_INTERVAL_S set?")
+
+    errors = []
+    peak_w, edge_overlaps, heating_s = 0, 0, 0
+    for now_s in common:
+        load_w = sum(states[now_s] for states in instances) * args.power_w
+        heating_s += load_w > 0
+        if load_w > args.cap_w and any(near_switch(states, now_s, args.edge_s) for states in instances):
+            edge_overlaps += 1
+            continue
+        peak_w = max(peak_w, load_w)
+        if load_w > args.cap_w:
+            errors.append(f"{load_w} W at {now_s} s, above cap {args.cap_w} W")
+
+    demand_w = len(instances) * args.power_w
+    print(f"{len(instances)} instances, {len(common)} samples, {heating_s} with any heater on, "
+          f"{edge_overlaps} over cap within {args.edge_s} s of a switch, peak {peak_w} W away from switches")
+    if demand_w <= args.cap_w:
+        print(f"warning: all heaters together draw {demand_w} W, not above cap {args.cap_w} W, nothing to coordinate")
+    if heating_s == 0:
+        errors.append("no heater ever turned on, did the input script run?")
+
+    for error in errors[:20]:
+        print(error)
+    if len(errors) > 20:
+        print(f"... {len(errors) - 20} more")
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
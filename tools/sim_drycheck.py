@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+检查模拟器湿毛巾回放中毛巾干燥检测 (main/app_drydetect.c) 的判定时机, 判定过早或过晚时以非零状态退出.
+
+每次 "[Towel] ... hung" 开始一个回合, 回合内必须出现一次 "Towels dry after", 判定时刻取之前最近一行SIM报告中的
+剩余水量 (第9列, g):
+    - 剩余水量高于 --wet-g 判定为过早 (毛巾仍湿即停止加热)
+    - 剩余水量首次降到 --wet-g 以下后超过 --late-min 分钟才判定为过晚 (毛巾已干仍在加热)
+    - 回合结束 (下一次挂毛巾或日志结束) 仍未判定视为漏判
+
+用法:
+    按 sdkconfig.sim.dry 中的说明构建
+    ./build_dry/TowelRack-Controller-WiFi.elf | python tools/sim_drycheck.py -
+"""
+
+import argparse
+import re
+import sys
+
+HUNG = re.compile(r"\[Towel\] (\d+) g of water hung")
+DRY = re.compile(r"Towels dry after (\d+) min")
+SIM = re.compile(r"^SIM,(\d+),[^,]*,[^,]*,[^,]*,[^,]*,[^,]*,[^,]*,([\d.]+)")
+
+
+def check_sessions(lines, wet_g, late_min):
+    """返回每个回合的 (开始秒, 水量首次达标秒, 判定秒, 判定时水量, 错误说明或None)"""
+    results = []
+    session = None
+    now_s, water_g = 0, None
+
+    def close(error):
+        results.append((session["start_s"], session["dry_s"], session.get("detect_s"), session.get("detect_g"), error))
+
+    for line in lines:
+        match = SIM.search(line)
+        if match:
+            now_s, water_g = int(match.group(1)), float(match.group(2))
+            if session is not None and session["dry_s"] is None and water_g <= wet_g:
+                session["dry_s"] = now_s
+            continue
+        if HUNG.search(line):
+            if session is not None and "detect_s" not in session:
+                close("no detection")
+            session = {"start_s": now_s, "dry_s": None}
+            continue
+        if DRY.search(line) and session is not None and "detect_s" not in session:
+            session["detect_s"], session["detect_g"] = now_s, water_g
+            if water_g is not None and water_g > wet_g:
+                close(f"too early: {water_g:.1f} g of water left")
+            elif session["dry_s"] is not None and now_s - session["dry_s"] > late_min * 60:
+                close(f"too late: {(now_s - session['dry_s']) / 60:.0f} min after reaching {wet_g} g")
+            else:
+                close(None)
+    if session is not None and "detect_s" not in session:
+        close("no detection")
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gate the towel dry detection timing of a simulator replay")
+    parser.add_argument("log", help="simulator output, - for stdin")
+    parser.add_argument("--wet-g", type=float, default=5.0, help="water left above which a detection is too early")
+    parser.add_argument("--late-min", type=int, default=60, help="minutes after reaching --wet-g that are too late")
+    args = parser.parse_args()
+
+    with sys.stdin if args.log == "-" else open(args.log, errors="replace") as f:
+        results = check_sessions(f, args.wet_g, args.late_min)
+    if not results:
+        sys.exit("no '[Towel] ... hung' found, is SIM_INPUT_SCRIPT set to a wet towel session?")
+
+    failed = 0
+    for start_s, dry_s, detect_s, detect_g, error in results:
+        detected = "-" if detect_s is None else f"{detect_s} s ({detect_g:.1f} g left)"
+        reached = "-" if dry_s is None else f"{dry_s} s"
+        print(f"session at {start_s} s: {args.wet_g} g reached {reached}, dry detected {detected}: {error or 'ok'}")
+        failed += error is not None
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""
+检查模拟器手势场景 (sim/gestures/*.txt) 中手势识别 (main/bsp_input_gesture.c) 的输出, 与场景的 "# expect:" 行不符时
+以非零状态退出.
+
+场景脚本以原始输入事件 (RAW_PRESS_<按键>, RAW_RELEASE_<按键>, RAW_DETENT_CW/ACW) 描述一次操作, "# expect:" 后按顺序
+列出应识别出的输入事件, 为空表示不应识别出任何事件. 日志中的识别结果为 "Gesture: <事件名>".
+
+用法:
+    按 sdkconfig.sim.gesture 中的说明构建
+    TRC_SIM_INPUT=sim/gestures/chord.txt ./build_gesture/TowelRack-Controller-WiFi.elf | \\
+        python tools/sim_gesturecheck.py sim/gestures/chord.txt -
+"""
+
+import argparse
+import re
+import sys
+
+EXPECT = re.compile(r"^#\s*expect:(.*)$")
+GESTURE = re.compile(r"Gesture: (\w+)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the recognized gestures of a simulator scenario")
+    parser.add_argument("scenario", help="scenario script with an '# expect:' line")
+    parser.add_argument("log", help="simulator output, - for stdin")
+    args = parser.parse_args()
+
+    expected = None
+    with open(args.scenario) as f:
+        for line in f:
+            match = EXPECT.match(line.strip())
+            if match:
+                expected = match.group(1).split()
+    if expected is None:
+        sys.exit(f"{args.scenario}: no '# expect:' line")
+
+    with sys.stdin if args.log == "-" else open(args.log, errors="replace") as f:
+        actual = [match.group(1) for match in map(GESTURE.search, f) if match]
+
+    ok = actual == expected
+    print(f"{args.scenario}: {' '.join(actual) or '-'}: {'ok' if ok else 'expected ' + (' '.join(expected) or '-')}")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+检查模拟器分时电价回放中规划 (main/app_tariff_plan.c) 的结果, 不满足时以非零状态退出.
+
+    - 每个 "TARIFF,<开始>,<预期>,<基准>,<实际>" 的实际电费不得高于不规划的基准电费
+    - --max-preheat-min: 每次规划的预热提前量不得超过该值 (平价电价表应恰好及时预热)
+    - --hold-until: 该虚拟秒数之前加热器必须一直关闭 (电价表在舒适时段前结束时不加热), 此时不要求TARIFF行
+    - 规划生效期间舒适时段内的最低架温 (SIM报告第3列) 不得低于规划日志给出的舒适下限
+      (目标温度 - APP_TARIFF_COAST_C), --floor-margin 为允许的测量波动; 电价表结束后 ("Planner inactive")
+      按普通温控运行, 不检查
+
+用法:
+    按 sdkconfig.sim.tariff 中的说明构建
+    ./build_tariff/TowelRack-Controller-WiFi.elf | python tools/sim_tariffcheck.py -
+    TRC_SIM_TARIFF=sim/tariffs/flat_day.json ./build_tariff/... | python tools/sim_tariffcheck.py --max-preheat-min 30 -
+    TRC_SIM_TARIFF=sim/tariffs/short_feed.json ./build_tariff/... | python tools/sim_tariffcheck.py --hold-until 14400 -
+"""
+
+import argparse
+import re
+import sys
+
+TARIFF = re.compile(r"TARIFF,(\d+),(\d+),(\d+),(\d+)")
+PLAN = re.compile(r"Plan: preheat (\d+) min ahead, comfort floor (-?\d+) C")
+INACTIVE = re.compile(r"Planner inactive")
+SIM = re.compile(r"^SIM,(\d+),([\d.]+),[^,]*,(\d+),")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gate the tariff planner results of a simulator replay")
+    parser.add_argument("log", help="simulator output, - for stdin")
+    parser.add_argument("--comfort", default="360-540", help="comfort window in minutes after midnight, start-end")
+    parser.add_argument("--max-preheat-min", type=int, help="largest allowed preheat lead time")
+    parser.add_argument("--hold-until", type=int, help="virtual second before which the heater must stay off")
+    parser.add_argument("--floor-margin", type=float, default=0.2, help="allowed dip below the comfort floor (C)")
+    args = parser.parse_args()
+    comfort_start, comfort_end = (int(m) * 60 for m in args.comfort.split("-"))
+
+    errors = []
+    tariffs, preheats, floors = [], [], []
+    comfort_min_c, first_on_s, floor_c = None, None, None
+    with sys.stdin if args.log == "-" else open(args.log, errors="replace") as f:
+        for line in f:
+            match = SIM.search(line)
+            if match:
+                now_s, temp_c, heater = int(match.group(1)), float(match.group(2)), int(match.group(3))
+                if floor_c is not None and comfort_start <= now_s % 86400 < comfort_end:
+                    comfort_min_c = temp_c if comfort_min_c is None else min(comfort_min_c, temp_c)
+                if args.hold_until is not None and now_s < args.hold_until and heater and first_on_s is None:
+                    first_on_s = now_s
+                continue
+            match = TARIFF.search(line)
+            if match:
+                tariffs.append(tuple(int(g) for g in match.groups()))
+                continue
+            match = PLAN.search(line)
+            if match:
+                preheats.append(int(match.group(1)))
+                floor_c = int(match.group(2))
+                floors.append(floor_c)
+                continue
+            if INACTIVE.search(line):
+                floor_c = None
+
+    if first_on_s is not None:
+        errors.append(f"heater on at {first_on_s} s, before {args.hold_until} s")
+    for start, expected, baseline, actual in tariffs:
+        print(f"comfort window at {start}: expected {expected}, baseline {baseline}, actual {actual}")
+        if actual > baseline:
+            errors.append(f"actual cost {actual} above baseline {baseline}")
+    if not tariffs and args.hold_until is None:
+        errors.append("no TARIFF line, did the comfort window end within SIM_DURATION_S?")
+    if preheats:
+        print(f"largest preheat lead time {max(preheats)} min")
+        if args.max_preheat_min is not None and max(preheats) > args.max_preheat_min:
+            errors.append(f"preheat {max(preheats)} min ahead, more than {args.max_preheat_min}")
+    if comfort_min_c is not None:
+        print(f"lowest planned rack temperature in the comfort window {comfort_min_c:.1f} C, floor {min(floors)} C")
+        if comfort_min_c < min(floors) - args.floor_margin:
+            errors.append(f"rack at {comfort_min_c:.1f} C in the comfort window, below the floor {min(floors)} C")
+
+    for error in errors:
+        print(error)
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
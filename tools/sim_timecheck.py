@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""
+检查模拟器对本地SNTP服务 (tools/ntp_server.py) 同步时频率偏差估计 (main/app_time.c) 的结果, 不满足时以非零状态退出.
+
+    - 至少 --min-syncs 次 "Synced with" 同步成功
+    - 最后一次同步的估计偏差与服务叠加的 --drift-ppm 之差不超过 --tolerance-ppm
+      (服务偏快时设备相对服务偏慢, 估计为负: 估计 ppb = -drift_ppm * 1000)
+    - 出现 "Server time stepped" 视为误判跳变, 除非 --allow-steps
+
+仿真板的单调时钟以系统节拍计 (sdkconfig.sim.time 中为 100 ms 虚拟时间), 同步间隔 240 min 时单次测量的分辨率约
+7 ppm, 估计以 1/2 系数滤波, 默认容差按此选取.
+
+用法:
+    按 sdkconfig.sim.time 中的说明启动服务并构建
+    ./build_time/TowelRack-Controller-WiFi.elf | python tools/sim_timecheck.py --drift-ppm 50 -
+"""
+
+import argparse
+import re
+import sys
+
+SYNCED = re.compile(r"Synced with \S+: offset (-?\d+) us, delay (\d+) us, drift (-?\d+) ppb")
+STEPPED = re.compile(r"Server time stepped by (-?\d+) ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gate the simulator clock drift estimate against the SNTP server")
+    parser.add_argument("log", help="simulator output, - for stdin")
+    parser.add_argument("--drift-ppm", type=float, required=True, help="--drift-ppm given to tools/ntp_server.py")
+    parser.add_argument("--tolerance-ppm", type=float, default=5.0, help="allowed error of the final estimate")
+    parser.add_argument("--min-syncs", type=int, default=3, help="syncs needed for at least two drift updates")
+    parser.add_argument("--allow-steps", action="store_true", help="the server was run with --step")
+    args = parser.parse_args()
+
+    syncs, steps = [], []
+    with sys.stdin if args.log == "-" else open(args.log, errors="replace") as f:
+        for line in f:
+            match = SYNCED.search(line)
+            if match:
+                syncs.append(tuple(int(g) for g in match.groups()))
+                continue
+            match = STEPPED.search(line)
+            if match:
+                steps.append(int(match.group(1)))
+
+    errors = []
+    for i, (offset_us, delay_us, drift_ppb) in enumerate(syncs):
+        print(f"sync {i}: offset {offset_us} us, delay {delay_us} us, drift {drift_ppb / 1000:+.1f} ppm")
+    if len(syncs) < args.min_syncs:
+        errors.append(f"{len(syncs)} syncs, at least {args.min_syncs} needed, is the server running?")
+    elif abs(-syncs[-1][2] / 1000 - args.drift_ppm) > args.tolerance_ppm:
+        errors.append(f"estimated drift {syncs[-1][2] / 1000:+.1f} ppm, expected {-args.drift_ppm:+.1f} "
+                      f"+- {args.tolerance_ppm} ppm")
+    if steps and not args.allow_steps:
+        errors.append(f"{len(steps)} false step detections, first {steps[0]} ms")
+
+    for error in errors:
+        print(error)
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+本地分时电价服务, 代替真实的电价推送源测试 app_tariff.c.
+
+每次请求返回从本地当天 00:00 开始的电价表 (格式见 main/include/app_tariff.h), now 为当前时间:
+    {"now": ..., "utc_offset_s": ..., "start": ..., "slot_s": 1800, "prices": [...]}
+
+电价取自 JSON 文件中的 prices/slot_s (例如 sim/tariffs/tou_day.json), 文件中的时间字段被忽略.
+
+用法:
+    python tools/tariff_server.py sim/tariffs/tou_day.json --port 8080
+    设备配置: CONFIG_APP_TARIFF_URL="http://<主机IP>:8080/tariff.json", 命令行 tariff refresh 立即下载
+"""
+
+import argparse
+import http.server
+import json
+import time
+
+
+def build_feed(template):
+    now = int(time.time())
+    local = time.localtime(now)
+    utc_offset = local.tm_gmtoff
+    midnight = now - (local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec)
+    return {
+        "now": now,
+        "utc_offset_s": utc_offset,
+        "start": midnight,
+        "slot_s": template["slot_s"],
+        "prices": template["prices"],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve a time-of-use tariff feed for testing")
+    parser.add_argument("tariff", help="JSON file providing slot_s and prices")
+    parser.add_argument("--port", type=int, default=8080)
+    args = parser.parse_args()
+
+    with open(args.tariff) as f:
+        template = json.load(f)
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def do_GET(self):
+            body = json.dumps(build_feed(template)).encode()
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+    print(f"Serving {args.tariff} on port {args.port}")
+    http.server.ThreadingHTTPServer(("", args.port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()